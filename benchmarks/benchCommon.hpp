@@ -0,0 +1,73 @@
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+// Shared helpers for the standalone benchmarks in this directory.
+// Benchmarks are run from the repository root so that ./schemas resolves.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "DataModule/ModuleData.hpp"
+#include "../tests/unit/moduleFixtures.hpp"
+
+namespace bench {
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The library logs progress to std::cout; keep it out of the results
+class QuietScope {
+    std::ostringstream sink;
+    std::streambuf* previous;
+public:
+    QuietScope() : previous(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietScope() { std::cout.rdbuf(previous); }
+};
+
+// Value of "--name value" on the command line, or fallback
+inline size_t argValue(int argc, char** argv, const std::string& name, size_t fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == "--" + name) return std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    return fallback;
+}
+
+inline std::string argString(int argc, char** argv, const std::string& name, const std::string& fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == "--" + name) return argv[i + 1];
+    }
+    return fallback;
+}
+
+// 1, 2, 4, ... up to and always including maxThreads
+inline std::vector<size_t> threadCounts(size_t maxThreads) {
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(std::max<size_t>(maxThreads, 1));
+    return counts;
+}
+
+inline std::string tempPath(const std::string& name) {
+    std::filesystem::path p = std::filesystem::path("build/bench_tmp") / name;
+    std::filesystem::create_directories(p.parent_path());
+    std::filesystem::remove(p);
+    std::filesystem::remove(p.string() + ".tmp");
+    return p.string();
+}
+
+// Module generators are shared with the unit tests
+using fixtures::makeImageModule;
+using fixtures::makeTabularModule;
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,57 @@
+// Cost of adding one small module to an existing file, for growing file sizes.
+// Commits append in place, so the time should stay flat as the file grows.
+//
+//   build/bench/bench_appendUpdate [--frames 1600] [--size 512] [--steps 4]
+
+#include "benchCommon.hpp"
+#include "writer.hpp"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+
+    size_t maxFrames = bench::argValue(argc, argv, "frames", 1600);
+    size_t size = bench::argValue(argc, argv, "size", 512);
+    size_t steps = bench::argValue(argc, argv, "steps", 4);
+
+    ModuleData small = bench::makeImageModule(16, 16, 1, "raw");
+
+    std::printf("append update: one 16x16 module added to a file of %zux%zu 16-bit frames\n", size, size);
+    std::printf("%8s %12s %12s\n", "frames", "file MB", "seconds");
+
+    for (size_t step = 1; step <= steps; ++step) {
+        size_t frameCount = maxFrames * step / steps;
+        std::string path = bench::tempPath("append_update.umdf");
+        {
+            bench::QuietScope quiet;
+            ModuleData image = bench::makeImageModule(size, size, frameCount, "raw");
+
+            Writer writer;
+            if (!writer.createNewFile(path, "bench").success) return 1;
+            auto encounter = writer.createNewEncounter();
+            if (!encounter) return 1;
+            if (!writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", image)) return 1;
+            if (!writer.closeFile().success) return 1;
+        }
+        double fileMegabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+
+        double seconds;
+        {
+            bench::QuietScope quiet;
+            auto start = std::chrono::steady_clock::now();
+
+            Writer writer;
+            if (!writer.openFile(path, "bench").success) return 1;
+            auto encounter = writer.createNewEncounter();
+            if (!encounter) return 1;
+            if (!writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", small)) return 1;
+            if (!writer.closeFile().success) return 1;
+
+            seconds = bench::secondsSince(start);
+        }
+
+        std::printf("%8zu %12.1f %12.4f\n", frameCount, fileMegabytes, seconds);
+        std::filesystem::remove(path);
+    }
+    return 0;
+}
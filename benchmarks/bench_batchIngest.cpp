@@ -0,0 +1,74 @@
+// Batch ingestion: modules/s for adding many small tabular modules one call at
+// a time versus a single addModules() batch at 1..N threads.
+//
+//   build/bench/bench_batchIngest [--modules 2000] [--rows 50] [--threads N] [--password secret]
+
+#include "benchCommon.hpp"
+#include "writer.hpp"
+#include "Utility/threadPool.hpp"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+
+    size_t moduleCount = bench::argValue(argc, argv, "modules", 2000);
+    size_t rowCount = bench::argValue(argc, argv, "rows", 50);
+    size_t maxThreads = bench::argValue(argc, argv, "threads", ThreadPool::defaultThreadCount());
+    std::string password = bench::argString(argc, argv, "password", "");
+    std::string schema = "./schemas/patient/v1.0.json";
+
+    std::vector<ModuleData> modules;
+    modules.reserve(moduleCount);
+    for (size_t i = 0; i < moduleCount; ++i) {
+        modules.push_back(bench::makeTabularModule(rowCount, i));
+    }
+
+    std::printf("batch ingest: %zu tabular modules of %zu rows%s\n", moduleCount, rowCount,
+                password.empty() ? "" : ", encrypted");
+    std::printf("%-14s %8s %12s %12s %8s\n", "mode", "threads", "seconds", "modules/s", "speedup");
+
+    // Returns the seconds spent adding modules, or a negative value on failure
+    auto run = [&](bool batched) -> double {
+        std::string path = bench::tempPath("batch_ingest.umdf");
+        bench::QuietScope quiet;
+        Writer writer;
+        if (!writer.createNewFile(path, "bench", password).success) return -1.0;
+        auto encounter = writer.createNewEncounter();
+        if (!encounter) return -1.0;
+
+        auto start = std::chrono::steady_clock::now();
+        if (batched) {
+            std::vector<BatchModule> batch;
+            batch.reserve(modules.size());
+            for (const auto& module : modules) {
+                batch.push_back({ encounter.value(), schema, module });
+            }
+            if (!writer.addModules(batch)) return -1.0;
+        }
+        else {
+            for (const auto& module : modules) {
+                if (!writer.addModuleToEncounter(encounter.value(), schema, module)) return -1.0;
+            }
+        }
+        double seconds = bench::secondsSince(start);
+
+        if (!writer.closeFile().success) return -1.0;
+        std::filesystem::remove(path);
+        return seconds;
+    };
+
+    ThreadPool::setSharedThreadCount(1);
+    double baseline = run(false);
+    if (baseline < 0) return 1;
+    std::printf("%-14s %8d %12.3f %12.1f %7.2fx\n", "one at a time", 1, baseline, moduleCount / baseline, 1.0);
+
+    for (size_t threads : bench::threadCounts(maxThreads)) {
+        ThreadPool::setSharedThreadCount(threads);
+        double seconds = run(true);
+        if (seconds < 0) return 1;
+        std::printf("%-14s %8zu %12.3f %12.1f %7.2fx\n", "addModules", threads, seconds,
+                    moduleCount / seconds, baseline / seconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Frame codec comparison: encode/decode throughput and ratio of every registered
+// frame codec on the same CT-like 16-bit slices, without any file I/O.
+//
+//   build/bench/bench_frameCodecs [--frames 32] [--size 512]
+
+#include "benchCommon.hpp"
+#include "DataModule/Image/Encoding/CompressionFactory.hpp"
+#include "Utility/Compression/CompressionType.hpp"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+
+    size_t frameCount = bench::argValue(argc, argv, "frames", 32);
+    size_t size = bench::argValue(argc, argv, "size", 512);
+
+    ModuleData image = bench::makeImageModule(size, size, frameCount, "raw");
+    std::vector<std::vector<uint8_t>> frames;
+    for (auto& frame : std::get<std::vector<ModuleData>>(image.data)) {
+        frames.push_back(std::move(std::get<std::vector<uint8_t>>(frame.data)));
+    }
+    double megabytes = static_cast<double>(frames.size() * frames[0].size()) / (1024.0 * 1024.0);
+
+    std::printf("frame codecs: %zu frames %zux%zu 16-bit, 1 thread\n", frameCount, size, size);
+    std::printf("%-18s %12s %12s %8s\n", "codec", "encode MB/s", "decode MB/s", "ratio");
+
+    CompressionFactory factory;
+    for (CompressionType type : validCompressions) {
+        std::unique_ptr<CompressionStrategy> codec = factory.createStrategy(type);
+        if (!codec) {
+            continue;
+        }
+
+        std::vector<std::vector<uint8_t>> encoded;
+        encoded.reserve(frames.size());
+        double encodeSeconds, decodeSeconds;
+        try {
+            bench::QuietScope quiet;
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& frame : frames) {
+                encoded.push_back(codec->compress(frame, size, size, 1, 16));
+            }
+            encodeSeconds = bench::secondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < encoded.size(); ++i) {
+                if (codec->decompress(encoded[i]) != frames[i]) {
+                    std::fprintf(stderr, "%s: frame %zu did not round-trip\n",
+                                 compressionToString(type).c_str(), i);
+                    return 1;
+                }
+            }
+            decodeSeconds = bench::secondsSince(start);
+        }
+        catch (const std::exception& e) {
+            std::printf("%-18s %s\n", compressionToString(type).c_str(), e.what());
+            continue;
+        }
+
+        size_t encodedBytes = 0;
+        for (const auto& e : encoded) encodedBytes += e.size();
+        double ratio = static_cast<double>(frames.size() * frames[0].size()) / encodedBytes;
+
+        std::printf("%-18s %12.1f %12.1f %7.2fx\n", compressionToString(type).c_str(),
+                    megabytes / encodeSeconds, megabytes / decodeSeconds, ratio);
+    }
+    return 0;
+}
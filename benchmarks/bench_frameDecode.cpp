@@ -0,0 +1,61 @@
+// Frame decode scaling: frames/s for loading a whole image module at 1..N threads.
+//
+//   build/bench/bench_frameDecode [--frames 600] [--size 512]
+//                                 [--codec jpeg2000-lossless] [--threads N]
+
+#include "benchCommon.hpp"
+#include "reader.hpp"
+#include "writer.hpp"
+#include "Utility/threadPool.hpp"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+
+    size_t frameCount = bench::argValue(argc, argv, "frames", 600);
+    size_t size = bench::argValue(argc, argv, "size", 512);
+    size_t maxThreads = bench::argValue(argc, argv, "threads", ThreadPool::defaultThreadCount());
+    std::string codec = bench::argString(argc, argv, "codec", "jpeg2000-lossless");
+
+    std::string path = bench::tempPath("frame_decode.umdf");
+    std::string moduleId;
+    {
+        bench::QuietScope quiet;
+        ModuleData image = bench::makeImageModule(size, size, frameCount, codec);
+
+        Writer writer;
+        if (!writer.createNewFile(path, "bench").success) return 1;
+        auto encounter = writer.createNewEncounter();
+        if (!encounter) return 1;
+        auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", image);
+        if (!id) return 1;
+        moduleId = id->toString();
+        if (!writer.closeFile().success) return 1;
+    }
+
+    std::printf("frame decode: %zu frames %zux%zu 16-bit, %s\n", frameCount, size, size, codec.c_str());
+    std::printf("%8s %12s %10s %8s\n", "threads", "seconds", "frames/s", "speedup");
+
+    double baseline = 0.0;
+    for (size_t threads : bench::threadCounts(maxThreads)) {
+        ThreadPool::setSharedThreadCount(threads);
+
+        double seconds;
+        {
+            bench::QuietScope quiet;
+            Reader reader;
+            if (!reader.openFile(path).success) return 1;
+
+            auto start = std::chrono::steady_clock::now();
+            auto data = reader.getModuleData(moduleId);
+            seconds = bench::secondsSince(start);
+            if (!data) return 1;
+        }
+
+        if (threads == 1) baseline = seconds;
+        std::printf("%8zu %12.3f %10.1f %7.2fx\n", threads, seconds, frameCount / seconds, baseline / seconds);
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
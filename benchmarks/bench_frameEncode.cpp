@@ -0,0 +1,53 @@
+// Frame encode scaling: frames/s for writing a whole image module at 1..N threads.
+//
+//   build/bench/bench_frameEncode [--frames 256] [--size 512]
+//                                 [--codec jpeg2000-lossless] [--threads N]
+
+#include "benchCommon.hpp"
+#include "writer.hpp"
+#include "Utility/threadPool.hpp"
+
+#include <cstdio>
+
+int main(int argc, char** argv) {
+
+    size_t frameCount = bench::argValue(argc, argv, "frames", 256);
+    size_t size = bench::argValue(argc, argv, "size", 512);
+    size_t maxThreads = bench::argValue(argc, argv, "threads", ThreadPool::defaultThreadCount());
+    std::string codec = bench::argString(argc, argv, "codec", "jpeg2000-lossless");
+
+    ModuleData image = bench::makeImageModule(size, size, frameCount, codec);
+    double rawMegabytes = frameCount * size * size * 2 / (1024.0 * 1024.0);
+
+    std::printf("frame encode: %zu frames %zux%zu 16-bit, %s\n", frameCount, size, size, codec.c_str());
+    std::printf("%8s %12s %10s %10s %8s %12s\n", "threads", "seconds", "frames/s", "MB/s", "speedup", "file bytes");
+
+    double baseline = 0.0;
+    for (size_t threads : bench::threadCounts(maxThreads)) {
+        ThreadPool::setSharedThreadCount(threads);
+        std::string path = bench::tempPath("frame_encode.umdf");
+
+        double seconds;
+        {
+            bench::QuietScope quiet;
+            Writer writer;
+            if (!writer.createNewFile(path, "bench").success) return 1;
+            auto encounter = writer.createNewEncounter();
+            if (!encounter) return 1;
+
+            auto start = std::chrono::steady_clock::now();
+            auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", image);
+            seconds = bench::secondsSince(start);
+            if (!id) return 1;
+            if (!writer.closeFile().success) return 1;
+        }
+
+        if (threads == 1) baseline = seconds;
+        std::printf("%8zu %12.3f %10.1f %10.1f %7.2fx %12ju\n", threads, seconds, frameCount / seconds,
+            rawMegabytes / seconds, baseline / seconds, static_cast<uintmax_t>(std::filesystem::file_size(path)));
+
+        std::filesystem::remove(path);
+    }
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Tabular row throughput: rows/s for encoding JSON rows into a module, decoding
+// them back to JSON, and reading a stored module from file. All three walk the
+// schema's row layout once per row.
+//
+//   build/bench/bench_tableRows [--rows 200000] [--repeats 3]
+
+#include "benchCommon.hpp"
+#include "reader.hpp"
+#include "writer.hpp"
+#include "DataModule/Tabular/tabularData.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+int main(int argc, char** argv) {
+
+    size_t rowCount = bench::argValue(argc, argv, "rows", 200000);
+    size_t repeats = std::max<size_t>(1, bench::argValue(argc, argv, "repeats", 3));
+    std::string schemaPath = "./schemas/patient/v1.0.json";
+
+    ModuleData table = bench::makeTabularModule(rowCount, 0);
+
+    std::printf("table rows: %zu patient rows, best of %zu\n", rowCount, repeats);
+    std::printf("%-8s %12s %12s\n", "stage", "seconds", "rows/s");
+
+    double encodeSeconds = 1e300, decodeSeconds = 1e300, readSeconds = 1e300;
+    for (size_t repeat = 0; repeat < repeats; ++repeat) {
+        bench::QuietScope quiet;
+
+        TabularData module(schemaPath, SchemaRegistry::shared().get(schemaPath), UUID(), EncryptionData());
+
+        auto start = std::chrono::steady_clock::now();
+        module.addData(table.data);
+        encodeSeconds = std::min(encodeSeconds, bench::secondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        ModuleData decoded = module.getModuleData();
+        decodeSeconds = std::min(decodeSeconds, bench::secondsSince(start));
+        if (std::get<nlohmann::json>(decoded.data).size() != rowCount) return 1;
+    }
+
+    std::string path = bench::tempPath("table_rows.umdf");
+    std::string moduleId;
+    {
+        bench::QuietScope quiet;
+        Writer writer;
+        if (!writer.createNewFile(path, "bench").success) return 1;
+        auto encounter = writer.createNewEncounter();
+        if (!encounter) return 1;
+        auto module = writer.addModuleToEncounter(encounter.value(), schemaPath, table);
+        if (!module) return 1;
+        moduleId = module.value().toString();
+        if (!writer.closeFile().success) return 1;
+    }
+    for (size_t repeat = 0; repeat < repeats; ++repeat) {
+        bench::QuietScope quiet;
+        Reader reader;
+        if (!reader.openFile(path).success) return 1;
+
+        auto start = std::chrono::steady_clock::now();
+        auto data = reader.getModuleData(moduleId);
+        readSeconds = std::min(readSeconds, bench::secondsSince(start));
+        if (!data || std::get<nlohmann::json>(data.value().data).size() != rowCount) return 1;
+    }
+    std::filesystem::remove(path);
+
+    std::printf("%-8s %12.3f %12.0f\n", "encode", encodeSeconds, rowCount / encodeSeconds);
+    std::printf("%-8s %12.3f %12.0f\n", "decode", decodeSeconds, rowCount / decodeSeconds);
+    std::printf("%-8s %12.3f %12.0f\n", "read", readSeconds, rowCount / readSeconds);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// ZSTD context reuse: per-call cost of compressing and decompressing small
+// metadata-sized blocks with a fresh context each call (one-shot ZSTD_compress /
+// ZSTD_decompress) against ZstdCompressor's per-thread contexts.
+//
+//   build/bench/bench_zstdContext [--calls 2000] [--level 15]
+
+#include "benchCommon.hpp"
+#include "Utility/Compression/ZstdCompressor.hpp"
+
+#include <zstd.h>
+#include <cstdio>
+
+static std::vector<uint8_t> makeBlock(size_t size) {
+    std::string text;
+    while (text.size() < size) {
+        text += "{\"modality\":\"CT\",\"position\":[0.0,0.0," + std::to_string(text.size()) + ".5]}";
+    }
+    return std::vector<uint8_t>(text.begin(), text.begin() + size);
+}
+
+int main(int argc, char** argv) {
+
+    size_t calls = bench::argValue(argc, argv, "calls", 2000);
+    int level = static_cast<int>(bench::argValue(argc, argv, "level", ZstdCompressor::DEFAULT_LEVEL));
+
+    std::printf("zstd context reuse: %zu calls per size, level %d\n", calls, level);
+    std::printf("%8s %14s %14s %14s %14s\n", "bytes", "oneshot c us", "reused c us", "oneshot d us", "reused d us");
+
+    for (size_t size : { 256, 1024, 4096, 16384 }) {
+        std::vector<uint8_t> block = makeBlock(size);
+        std::vector<uint8_t> out(ZSTD_compressBound(size));
+        std::vector<uint8_t> restored(size);
+
+        auto start = std::chrono::steady_clock::now();
+        size_t compressedSize = 0;
+        for (size_t i = 0; i < calls; ++i) {
+            compressedSize = ZSTD_compress(out.data(), out.size(), block.data(), block.size(), level);
+        }
+        double oneshotCompress = bench::secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; ++i) {
+            ZstdCompressor::compressInto(std::as_bytes(std::span(block)), std::as_writable_bytes(std::span(out)), level);
+        }
+        double reusedCompress = bench::secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; ++i) {
+            ZSTD_decompress(restored.data(), restored.size(), out.data(), compressedSize);
+        }
+        double oneshotDecompress = bench::secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < calls; ++i) {
+            ZstdCompressor::decompressInto(std::as_bytes(std::span(out).first(compressedSize)),
+                std::as_writable_bytes(std::span(restored)));
+        }
+        double reusedDecompress = bench::secondsSince(start);
+
+        if (restored != block) {
+            std::fprintf(stderr, "round trip mismatch at %zu bytes\n", size);
+            return 1;
+        }
+
+        double scale = 1e6 / calls;
+        std::printf("%8zu %14.2f %14.2f %14.2f %14.2f\n", size, oneshotCompress * scale, reusedCompress * scale,
+            oneshotDecompress * scale, reusedDecompress * scale);
+    }
+
+    return 0;
+}
@@ -100,6 +100,32 @@ void register_common_bindings(py::module_& m) {
             }
         });
     
+    // Register std::expected<std::vector<UUID>, std::string> wrapper
+    py::class_<std::expected<std::vector<UUID>, std::string>>(m, "ExpectedUUIDList")
+        .def("has_value", [](const std::expected<std::vector<UUID>, std::string>& self) { return self.has_value(); })
+        .def("value", [](const std::expected<std::vector<UUID>, std::string>& self) -> py::object {
+            if (self.has_value()) {
+                return py::cast(self.value());
+            } else {
+                throw std::runtime_error("Expected has no value: " + self.error());
+            }
+        })
+        .def("error", [](const std::expected<std::vector<UUID>, std::string>& self) -> py::object {
+            if (self.has_value()) {
+                throw std::runtime_error("Expected has value, no error");
+            } else {
+                return py::cast(self.error());
+            }
+        });
+
+    // Register BatchModule struct
+    py::class_<BatchModule>(m, "BatchModule")
+        .def(py::init<>())
+        .def(py::init<UUID, std::string, ModuleData>())
+        .def_readwrite("encounterId", &BatchModule::encounterId)
+        .def_readwrite("schemaPath", &BatchModule::schemaPath)
+        .def_readwrite("module", &BatchModule::module);
+
     // Register Result struct
     py::class_<Result>(m, "Result")
         .def_readwrite("success", &Result::success)
@@ -136,6 +162,24 @@ void register_common_bindings(py::module_& m) {
             }
         });
     
+    // Register std::expected<std::vector<ModuleData>, std::string> wrapper
+    py::class_<std::expected<std::vector<ModuleData>, std::string>>(m, "ExpectedModuleDataList")
+        .def("has_value", [](const std::expected<std::vector<ModuleData>, std::string>& self) { return self.has_value(); })
+        .def("value", [](const std::expected<std::vector<ModuleData>, std::string>& self) -> py::object {
+            if (self.has_value()) {
+                return py::cast(self.value());
+            } else {
+                throw std::runtime_error("Expected has no value: " + self.error());
+            }
+        })
+        .def("error", [](const std::expected<std::vector<ModuleData>, std::string>& self) -> py::object {
+            if (self.has_value()) {
+                throw std::runtime_error("Expected has value, no error");
+            } else {
+                return py::cast(self.error());
+            }
+        });
+    
     // Register std::expected<std::vector<ModuleTrail>, std::string> wrapper
     py::class_<std::expected<std::vector<ModuleTrail>, std::string>>(m, "ExpectedModuleTrail")
         .def("has_value", [](const std::expected<std::vector<ModuleTrail>, std::string>& self) { return self.has_value(); })
@@ -3,12 +3,32 @@
 #include "../src/reader.hpp"
 
 void register_reader_bindings(py::module_& m) {
+    py::enum_<ReadMode>(m, "ReadMode")
+        .value("Stream", ReadMode::Stream)
+        .value("MemoryMapped", ReadMode::MemoryMapped);
+
+    py::class_<ModuleCacheStats>(m, "ModuleCacheStats")
+        .def_readonly("hits", &ModuleCacheStats::hits)
+        .def_readonly("misses", &ModuleCacheStats::misses)
+        .def_readonly("evictions", &ModuleCacheStats::evictions)
+        .def_readonly("moduleCount", &ModuleCacheStats::moduleCount)
+        .def_readonly("frameIndexCount", &ModuleCacheStats::frameIndexCount)
+        .def_readonly("encodedBytes", &ModuleCacheStats::encodedBytes)
+        .def_readonly("decodedBytes", &ModuleCacheStats::decodedBytes)
+        .def_readonly("budgetBytes", &ModuleCacheStats::budgetBytes);
+
     // Expose the Reader class with basic methods
     py::class_<Reader>(m, "Reader")
         .def(py::init<>())
+        .def("setReadMode", &Reader::setReadMode, "Select stream or memory-mapped reads")
+        .def("setCacheBudget", &Reader::setCacheBudget, "Set the loaded module cache budget in bytes")
+        .def("getCacheStatistics", &Reader::getCacheStatistics, "Get loaded module cache counters")
         .def("openFile", &Reader::openFile, "Open a UMDF file")
         .def("getFileInfo", &Reader::getFileInfo, "Get file information")
-        .def("getModuleData", &Reader::getModuleData, "Get data for a specific module")
+        .def("getModuleData", py::overload_cast<const std::string&>(&Reader::getModuleData), "Get data for a specific module")
+        .def("getModuleData", py::overload_cast<const UUID&>(&Reader::getModuleData), "Get data for a specific module")
+        .def("getFrame", &Reader::getFrame, "Get a single decoded frame of an image module")
+        .def("getFrames", &Reader::getFrames, "Get a range of decoded frames of an image module")
         .def("getAuditTrail", &Reader::getAuditTrail, "Get audit trail for a module")
         .def("getAuditData", &Reader::getAuditData, "Get audit data for a module")
         .def("closeFile", &Reader::closeFile, "Close the currently open file");
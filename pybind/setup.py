@@ -63,6 +63,7 @@ ext_modules = [
             "openjp2",  # OpenJPEG library name
             "png16",    # libpng library name
             "zstd",     # zstd library name
+            "charls",   # CharLS (JPEG-LS) library name
             "sodium"    # libsodium library name
         ],
         language='c++',
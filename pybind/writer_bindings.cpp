@@ -10,11 +10,16 @@ void register_writer_bindings(py::module_& m) {
         .def(py::init<>())
         .def("createNewFile", &Writer::createNewFile, "Create a new UMDF file")
         .def("openFile", &Writer::openFile, "Open an existing UMDF file")
-        .def("updateModule", &Writer::updateModule, "Update an existing module")
+        .def("updateModule", py::overload_cast<const std::string&, const ModuleData&>(&Writer::updateModule), "Update an existing module")
+        .def("updateModule", py::overload_cast<const UUID&, const ModuleData&>(&Writer::updateModule), "Update an existing module")
         .def("createNewEncounter", &Writer::createNewEncounter, "Create a new encounter")
         .def("addModuleToEncounter", &Writer::addModuleToEncounter, "Add a module to an encounter")
         .def("addVariantModule", &Writer::addVariantModule, "Add a variant module")
         .def("addAnnotation", &Writer::addAnnotation, "Add an annotation module")
+        .def("addModules", &Writer::addModules, "Add a batch of modules, encoded concurrently")
+        .def("beginImageModule", &Writer::beginImageModule, "Start an image module written a frame at a time")
+        .def("appendFrame", &Writer::appendFrame, "Encode and write the next frame of the streamed image module")
+        .def("finishImageModule", &Writer::finishImageModule, "Write the frame index and complete the streamed image module")
         .def("cancelThenClose", &Writer::cancelThenClose, "Cancel the current operation and close the file")
         .def("closeFile", &Writer::closeFile, "Close the file");
 }
@@ -0,0 +1,120 @@
+#include "moduleCache.hpp"
+
+using namespace std;
+
+DataModule* ModuleCache::find(const UUID& id) {
+
+    auto it = index.find(id);
+    if (it == index.end()) {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->module.get();
+}
+
+DataModule* ModuleCache::insert(unique_ptr<DataModule> module) {
+    return insertInto(index, std::move(module), false);
+}
+
+DataModule* ModuleCache::findFrameIndex(const UUID& id) {
+
+    auto it = frameIndexes.find(id);
+    if (it == frameIndexes.end()) {
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->module.get();
+}
+
+DataModule* ModuleCache::insertFrameIndex(unique_ptr<DataModule> module) {
+    return insertInto(frameIndexes, std::move(module), true);
+}
+
+DataModule* ModuleCache::insertInto(unordered_map<UUID, list<Entry>::iterator>& map,
+                                    unique_ptr<DataModule> module, bool isFrameIndex) {
+
+    UUID id = module->getModuleID();
+
+    auto existing = map.find(id);
+    if (existing != map.end()) {
+        release(existing->second->footprint);
+        entries.erase(existing->second);
+        map.erase(existing);
+    }
+
+    ModuleFootprint footprint = module->getFootprint();
+    entries.push_front(Entry{ id, std::move(module), footprint, isFrameIndex });
+    map.emplace(id, entries.begin());
+    charge(footprint);
+
+    evictToBudget();
+    return entries.front().module.get();
+}
+
+void ModuleCache::refresh(const UUID& id) {
+
+    auto it = index.find(id);
+    if (it == index.end()) {
+        return;
+    }
+
+    Entry& entry = *it->second;
+    release(entry.footprint);
+    entry.footprint = entry.module->getFootprint();
+    charge(entry.footprint);
+
+    // The refreshed module is the one in use, keep it
+    entries.splice(entries.begin(), entries, it->second);
+    evictToBudget();
+}
+
+void ModuleCache::setBudget(size_t bytes) {
+    budgetBytes = bytes;
+    evictToBudget();
+}
+
+void ModuleCache::clear() {
+    index.clear();
+    frameIndexes.clear();
+    entries.clear();
+    usage = ModuleFootprint();
+}
+
+ModuleCacheStats ModuleCache::getStatistics() const {
+
+    ModuleCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.moduleCount = index.size();
+    stats.frameIndexCount = frameIndexes.size();
+    stats.encodedBytes = usage.encodedBytes;
+    stats.decodedBytes = usage.decodedBytes;
+    stats.budgetBytes = budgetBytes;
+    return stats;
+}
+
+void ModuleCache::charge(const ModuleFootprint& footprint) {
+    usage.encodedBytes += footprint.encodedBytes;
+    usage.decodedBytes += footprint.decodedBytes;
+}
+
+void ModuleCache::release(const ModuleFootprint& footprint) {
+    usage.encodedBytes -= footprint.encodedBytes;
+    usage.decodedBytes -= footprint.decodedBytes;
+}
+
+void ModuleCache::evictToBudget() {
+
+    while (usage.total() > budgetBytes && entries.size() > 1) {
+        Entry& victim = entries.back();
+        release(victim.footprint);
+        (victim.isFrameIndex ? frameIndexes : index).erase(victim.id);
+        entries.pop_back();
+        ++evictions;
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef MODULE_CACHE_HPP
+#define MODULE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "../DataModule/dataModule.hpp"
+#include "../Utility/uuid.hpp"
+
+struct ModuleCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    size_t moduleCount = 0;
+    size_t frameIndexCount = 0;
+    size_t encodedBytes = 0;
+    size_t decodedBytes = 0;
+    size_t budgetBytes = 0;
+};
+
+/**
+ * @brief Byte-budgeted LRU cache of loaded modules keyed by UUID.
+ *
+ * Each module is charged its ModuleFootprint, encoded and decoded bytes are
+ * tracked separately but both count towards the budget. When an insert or a
+ * refresh pushes the total over budget, least recently used modules are
+ * evicted until it fits again. The module that caused the overrun is never
+ * evicted by it, so a single module larger than the budget is still usable.
+ *
+ * Frame indexes of image modules read frame by frame (the module header,
+ * metadata and frame offsets without any frames) share the same LRU list and
+ * budget, but are kept apart from loaded modules: find() and contains() only
+ * see loaded modules, findFrameIndex() only sees frame indexes.
+ *
+ * Pointers returned by find() and insert() are invalidated when the module is
+ * evicted, i.e. by any later insert(), refresh(), setBudget() or clear().
+ */
+class ModuleCache {
+private:
+    struct Entry {
+        UUID id;
+        std::unique_ptr<DataModule> module;
+        ModuleFootprint footprint;
+        bool isFrameIndex;
+    };
+
+    // Most recently used at the front
+    std::list<Entry> entries;
+    std::unordered_map<UUID, std::list<Entry>::iterator> index;
+    std::unordered_map<UUID, std::list<Entry>::iterator> frameIndexes;
+
+    size_t budgetBytes;
+    ModuleFootprint usage;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    void charge(const ModuleFootprint& footprint);
+    void release(const ModuleFootprint& footprint);
+
+    DataModule* insertInto(std::unordered_map<UUID, std::list<Entry>::iterator>& map,
+                           std::unique_ptr<DataModule> module, bool isFrameIndex);
+
+    // Evict from the back until within budget, keeping the front entry
+    void evictToBudget();
+
+public:
+    static constexpr size_t DEFAULT_BUDGET = 1024ull * 1024 * 1024; // 1 GB
+
+    explicit ModuleCache(size_t budgetBytes = DEFAULT_BUDGET) : budgetBytes(budgetBytes) {}
+
+    ModuleCache(const ModuleCache&) = delete;
+    ModuleCache& operator=(const ModuleCache&) = delete;
+
+    /**
+     * @brief Look up a module and mark it most recently used.
+     * @return The module, or nullptr on a miss
+     */
+    DataModule* find(const UUID& id);
+
+    // Membership test that leaves counters and recency untouched
+    bool contains(const UUID& id) const { return index.contains(id); }
+
+    /**
+     * @brief Take ownership of a freshly loaded module.
+     *
+     * Replaces any module already cached under the same id.
+     * @return The cached module
+     */
+    DataModule* insert(std::unique_ptr<DataModule> module);
+
+    /**
+     * @brief Look up the frame index of an image module and mark it most recently used.
+     * @return The indexed module, or nullptr on a miss
+     */
+    DataModule* findFrameIndex(const UUID& id);
+
+    /**
+     * @brief Take ownership of an image module holding only its frame index.
+     *
+     * Replaces any frame index already cached under the same id.
+     * @return The cached frame index
+     */
+    DataModule* insertFrameIndex(std::unique_ptr<DataModule> module);
+
+    /**
+     * @brief Re-measure a module whose footprint changed, e.g. after decoding.
+     */
+    void refresh(const UUID& id);
+
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return budgetBytes; }
+
+    // Drops every module and frame index, counters are kept
+    void clear();
+    void resetStatistics() { hits = misses = evictions = 0; }
+
+    ModuleCacheStats getStatistics() const;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "CompiledRowLayout.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+CompiledRowLayout::CompiledRowLayout(const vector<unique_ptr<DataField>>& fields) {
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const string& name = fields[i]->getName();
+        if (auto* objectField = dynamic_cast<ObjectField*>(fields[i].get())) {
+            objectFields.push_back(i);
+            const auto& nestedFields = objectField->getNestedFields();
+            for (size_t j = 0; j < nestedFields.size(); ++j) {
+                const string& child = nestedFields[j]->getName();
+                slots.push_back({ name + "." + child, name, child, i, j, nestedFields[j]->getLength(), 0 });
+            }
+        } else {
+            slots.push_back({ name, name, "", i, npos, fields[i]->getLength(), 0 });
+        }
+    }
+
+    bitmapSize = (slots.size() + 7) / 8;
+    fullBitmap.assign(bitmapSize, 0);
+
+    size_t offset = bitmapSize;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        slots[i].fixedOffset = offset;
+        offset += slots[i].length;
+        fullBitmap[i / 8] |= uint8_t(1) << (i % 8);
+        slotIndex.emplace(slots[i].path, i);
+    }
+    fullRowSize = offset;
+}
+
+shared_ptr<const CompiledRowLayout> CompiledRowLayout::empty() {
+    static const auto layout = make_shared<const CompiledRowLayout>(vector<unique_ptr<DataField>>());
+    return layout;
+}
+
+bool CompiledRowLayout::isFull(const uint8_t* bitmap) const {
+    return bitmapSize == 0 || memcmp(bitmap, fullBitmap.data(), bitmapSize) == 0;
+}
+
+size_t CompiledRowLayout::rowSize(const uint8_t* bitmap) const {
+    if (isFull(bitmap)) {
+        return fullRowSize;
+    }
+    size_t size = bitmapSize;
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (isPresent(bitmap, i)) {
+            size += slots[i].length;
+        }
+    }
+    return size;
+}
+
+size_t CompiledRowLayout::find(string_view path) const {
+    auto it = slotIndex.find(path);
+    return it == slotIndex.end() ? npos : it->second;
+}
+
+RowBinding::RowBinding(shared_ptr<const CompiledRowLayout> rowLayout, const vector<unique_ptr<DataField>>& rowFields)
+    : layout(std::move(rowLayout)) {
+
+    for (size_t index : layout->getObjectFields()) {
+        auto* objectField = index < rowFields.size() ? dynamic_cast<ObjectField*>(rowFields[index].get()) : nullptr;
+        if (!objectField) {
+            throw runtime_error("Fields do not match the row layout of their schema");
+        }
+        objects.push_back(objectField);
+    }
+
+    fields.reserve(layout->getSlots().size());
+    size_t object = 0;
+    for (const auto& slot : layout->getSlots()) {
+        if (slot.field >= rowFields.size()) {
+            throw runtime_error("Fields do not match the row layout of their schema");
+        }
+        if (slot.nested == CompiledRowLayout::npos) {
+            fields.push_back(rowFields[slot.field].get());
+            continue;
+        }
+        while (layout->getObjectFields()[object] != slot.field) {
+            ++object;
+        }
+        const auto& nestedFields = objects[object]->getNestedFields();
+        if (slot.nested >= nestedFields.size()) {
+            throw runtime_error("Fields do not match the row layout of their schema");
+        }
+        fields.push_back(nestedFields[slot.nested].get());
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef COMPILED_ROW_LAYOUT_HPP
+#define COMPILED_ROW_LAYOUT_HPP
+
+#include "dataField.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Where each field of a table row lives, compiled once per schema section.
+ *
+ * A row is a presence bitmap followed by the present fields in slot order.
+ * Properties of object fields get a slot each, named "object.property", so a
+ * section's slots are its fields flattened one level deep. Slot paths are
+ * kept here once and shared by every module of the schema.
+ */
+class CompiledRowLayout {
+public:
+    struct Slot {
+        std::string path;           // "name", or "object.property" for nested fields
+        std::string key;            // top-level property the value is stored under
+        std::string child;          // property within key, empty for top-level fields
+        size_t field = 0;           // index of the top-level field
+        size_t nested = npos;       // index within the object field, npos for top-level fields
+        size_t length = 0;          // encoded size
+        size_t fixedOffset = 0;     // offset in a row holding every field
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit CompiledRowLayout(const std::vector<std::unique_ptr<DataField>>& fields);
+
+    // Layout of a section without fields
+    static std::shared_ptr<const CompiledRowLayout> empty();
+
+    // Slots are looked up by views of their paths
+    CompiledRowLayout(const CompiledRowLayout&) = delete;
+    CompiledRowLayout& operator=(const CompiledRowLayout&) = delete;
+
+    const std::vector<Slot>& getSlots() const { return slots; }
+    size_t getBitmapSize() const { return bitmapSize; }
+    // Size of a row holding every field
+    size_t getFullRowSize() const { return fullRowSize; }
+
+    bool isPresent(const uint8_t* bitmap, size_t slot) const {
+        return bitmap[slot / 8] & (uint8_t(1) << (slot % 8));
+    }
+    // True when the bitmap marks every slot present, the fields then sit at their fixed offsets
+    bool isFull(const uint8_t* bitmap) const;
+    // Size of a row with the given bitmap
+    size_t rowSize(const uint8_t* bitmap) const;
+
+    // Index of the slot at path, npos if there is none
+    size_t find(std::string_view path) const;
+
+    // Top-level indices of the object fields
+    const std::vector<size_t>& getObjectFields() const { return objectFields; }
+
+private:
+    std::vector<Slot> slots;
+    std::vector<size_t> objectFields;
+    std::vector<uint8_t> fullBitmap;
+    std::unordered_map<std::string_view, size_t> slotIndex;
+    size_t bitmapSize = 0;
+    size_t fullRowSize = 0;
+};
+
+/**
+ * @brief A module's fields placed in the slots of a CompiledRowLayout.
+ */
+struct RowBinding {
+    std::shared_ptr<const CompiledRowLayout> layout = CompiledRowLayout::empty();
+    std::vector<DataField*> fields;       // field of each slot
+    std::vector<ObjectField*> objects;    // object properties, in schema order
+
+    RowBinding() = default;
+
+    /**
+     * @brief Binds fields compiled from the layout's schema section.
+     * @throws std::runtime_error if the fields do not match the layout
+     */
+    RowBinding(std::shared_ptr<const CompiledRowLayout> layout,
+               const std::vector<std::unique_ptr<DataField>>& fields);
+};
+
+#endif // COMPILED_ROW_LAYOUT_HPP
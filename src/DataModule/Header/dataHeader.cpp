@@ -8,6 +8,35 @@
 #include <iostream>
 #include <vector>
 #include <expected>
+#include <cstring>
+
+namespace {
+    // Level as int32 followed by the long-distance matching flag. The worker
+    // count only affects how the section was produced and is not stored.
+    constexpr uint32_t ZSTD_SETTINGS_SIZE = sizeof(int32_t) + 1;
+
+    void writeZstdSettings(std::ostream& out, HeaderFieldType type, const ZstdSettings& settings) {
+        char value[ZSTD_SETTINGS_SIZE];
+        int32_t level = settings.level;
+        std::memcpy(value, &level, sizeof(level));
+        value[sizeof(level)] = settings.longDistanceMatching ? 1 : 0;
+        writeTLVFixed(out, type, value, ZSTD_SETTINGS_SIZE);
+    }
+
+    // Readers assume the default for absent settings, so only other settings
+    // cost header bytes. Frames are encoded with their module's settings.
+    bool recordsZstdSettings(ModuleType type, const ZstdSettings& settings) {
+        return type != ModuleType::Frame &&
+            (settings.level != ZstdCompressor::DEFAULT_LEVEL || settings.longDistanceMatching);
+    }
+
+    ZstdSettings readZstdSettings(const char* value, uint32_t length) {
+        if (length != ZSTD_SETTINGS_SIZE) throw std::runtime_error("Invalid ZstdSettings length.");
+        int32_t level;
+        std::memcpy(&level, value, sizeof(level));
+        return ZstdSettings{ .level = level, .longDistanceMatching = value[sizeof(level)] != 0 };
+    }
+}
 
 /* ================ WRTIE FUNCTIONS ================ */
 
@@ -33,14 +62,33 @@ void DataHeader::writeToFile(std::ostream& out) {
     writeTLVFixed(out, HeaderFieldType::MetadataCompression, &metadataCompressionValue, sizeof(metadataCompressionValue));
     writeTLVFixed(out, HeaderFieldType::DataCompression, &dataCompressionValue, sizeof(dataCompressionValue));
 
+    if (metadataCompression == CompressionType::ZSTD && recordsZstdSettings(moduleType, metadataZstd)) {
+        writeZstdSettings(out, HeaderFieldType::MetadataZstdSettings, metadataZstd);
+    }
+    if (dataCompression == CompressionType::ZSTD && recordsZstdSettings(moduleType, dataZstd)) {
+        writeZstdSettings(out, HeaderFieldType::DataZstdSettings, dataZstd);
+    }
+    if (metadataCompression == CompressionType::ZSTD && metadataDictionaryID != 0) {
+        writeTLVFixed(out, HeaderFieldType::MetadataDictionaryID, &metadataDictionaryID, sizeof(metadataDictionaryID));
+    }
+
+    if (hasFrameIndex) {
+        frameIndexOffsetPos = writeTLVFixed(out, HeaderFieldType::FrameIndexOffset, &frameIndexOffset, sizeof(frameIndexOffset));
+    }
+
     if (encryptionData.encryptionType != EncryptionType::NONE) {
 
         encryptionData.moduleSalt = EncryptionManager::generateSalt(16);  // 16 bytes
-        encryptionData.iv = EncryptionManager::generateIV(12);   
+        encryptionData.iv = EncryptionManager::generateIV(EncryptionManager::nonceSize(encryptionData.encryptionType));
+        encryptionData.segmentSize = EncryptionManager::DEFAULT_SEGMENT_SIZE;
 
         writeTLVFixed(out, HeaderFieldType::ModuleSalt, encryptionData.moduleSalt.data(), encryptionData.moduleSalt.size());
         writeTLVFixed(out, HeaderFieldType::IV, encryptionData.iv.data(), encryptionData.iv.size());
         authTagPos = writeTLVFixed(out, HeaderFieldType::AuthTag, encryptionData.authTag.data(), crypto_aead_aes256gcm_ABYTES);
+        writeTLVFixed(out, HeaderFieldType::EncryptionSegmentSize, &encryptionData.segmentSize, sizeof(encryptionData.segmentSize));
+        if (encryptionData.framesSealed) {
+            writeTLVBool(out, HeaderFieldType::FramesSealed, true);
+        }
     }
 
     writeTLVBool(out, HeaderFieldType::Endianness, littleEndian);
@@ -106,6 +154,12 @@ void DataHeader::updateHeader(std::ostream& out) {
     out.seekp(dataSizePos);
     out.write(reinterpret_cast<const char*>(&dataSize), sizeof(dataSize));
 
+    if (hasFrameIndex) {
+        // Update frame index offset
+        out.seekp(frameIndexOffsetPos);
+        out.write(reinterpret_cast<const char*>(&frameIndexOffset), sizeof(frameIndexOffset));
+    }
+
     if (encryptionData.encryptionType != EncryptionType::NONE) {
 
         // Update auth tag
@@ -142,117 +196,212 @@ void DataHeader::readDataHeader(std::istream& in) {
     readHeaderSize(in);
 
     size_t bytesRead = sizeof(typeId) + sizeof(length) + sizeof(headerSize);    
+    std::vector<char> buffer;
     while (bytesRead < headerSize) {
         in.read(reinterpret_cast<char*>(&typeId), sizeof(typeId));
         in.read(reinterpret_cast<char*>(&length), sizeof(length));
         bytesRead += sizeof(typeId) + sizeof(length);
 
-        std::vector<char> buffer(length);
+        buffer.resize(length);
         in.read(buffer.data(), length);
         bytesRead += length;
 
-        auto type = static_cast<HeaderFieldType>(typeId);
-        switch (type) {
-            case HeaderFieldType::MetadataSize:
-                if (length != sizeof(metaDataSize)) throw std::runtime_error("Invalid DataSize length.");
-                std::memcpy(&metaDataSize, buffer.data(), sizeof(metaDataSize));
-                break;
-
-            case HeaderFieldType::DataSize:
-                if (length != sizeof(dataSize)) throw std::runtime_error("Invalid DataSize length.");
-                std::memcpy(&dataSize, buffer.data(), sizeof(dataSize));
-                break;
-
-            case HeaderFieldType::StringSize:
-                if (length != sizeof(stringBufferSize)) throw std::runtime_error("Invalid StringSize length.");
-                std::memcpy(&stringBufferSize, buffer.data(), sizeof(stringBufferSize));
-                break;
-
-            case HeaderFieldType::IsCurrent:
-                if (length != sizeof(isCurrent)) throw std::runtime_error("Invalid IsCurrent length.");
-                std::memcpy(&isCurrent, buffer.data(), sizeof(isCurrent));
-                break;
-
-            case HeaderFieldType::PreviousVersion:
-                if (length != sizeof(previousVersion)) throw std::runtime_error("Invalid PreviousVersion length.");
-                std::memcpy(&previousVersion, buffer.data(), sizeof(previousVersion));
-                break;
-
-            case HeaderFieldType::ModuleType:
-                moduleType = module_type_from_string(std::string(buffer.data(), length));
-                break;
-
-            case HeaderFieldType::SchemaPath:
-                schemaPath = std::string(buffer.data(), length);
-                break;
-
-            case HeaderFieldType::MetadataCompression:
-                if (length != 1) throw std::runtime_error("Invalid MetadataCompression length.");
-                metadataCompression = decodeCompressionType(buffer[0]);
-                break;
-
-            case HeaderFieldType::DataCompression:
-                if (length != 1) throw std::runtime_error("Invalid DataCompression length.");
-                dataCompression = decodeCompressionType(buffer[0]);
-                break;
-
-            case HeaderFieldType::ModuleSalt:
-                encryptionData.moduleSalt = std::vector<uint8_t>(buffer.data(), buffer.data() + length);
-                break;
-
-            case HeaderFieldType::IV:
-                encryptionData.iv = std::vector<uint8_t>(buffer.data(), buffer.data() + length);
-                break;
-
-            case HeaderFieldType::AuthTag:
-                encryptionData.authTag = std::vector<uint8_t>(buffer.data(), buffer.data() + length);
-                break;
-                
-            case HeaderFieldType::Endianness:
-                if (length != 1) throw std::runtime_error("Invalid Endianness length.");
-                littleEndian = buffer[0] != 0;
-                break;
-
-            case HeaderFieldType::ModuleID:
-                if (length != 16) throw std::runtime_error("Invalid UUID length.");
-                std::array<uint8_t, 16> id;
-                std::memcpy(id.data(), buffer.data(), 16);
-                moduleID.setData(id);
-                break;
-
-            case HeaderFieldType::CreatedAt:
-                if (length != sizeof(createdAt.getTimestamp())) {
-                    throw std::runtime_error("Invalid CreatedAt length.");
-                }
-                uint64_t timestamp;
-                std::memcpy(&timestamp, buffer.data(), sizeof(timestamp));
-                createdAt = DateTime(timestamp);
-                break;
-
-            case HeaderFieldType::CreatedBy:
-                createdBy = std::string(buffer.data(), length);
-                break;
-
-            case HeaderFieldType::ModifiedAt:
-                if (length != sizeof(modifiedAt.getTimestamp())) {
-                    throw std::runtime_error("Invalid ModifiedAt length.");
-                }
-                std::memcpy(&timestamp, buffer.data(), sizeof(timestamp));
-                modifiedAt = DateTime(timestamp);
-                break;
-
-            case HeaderFieldType::ModifiedBy:
-                modifiedBy = std::string(buffer.data(), length);
-                break;
-            default:
-                throw std::runtime_error("Unknown HeaderFieldType: " + std::to_string(typeId));
+        readField(static_cast<HeaderFieldType>(typeId), buffer.data(), length);
+    }
+
+    if (bytesRead != headerSize) {
+        throw std::runtime_error("Header read mismatch.");
+    }
+
+}
+
+void DataHeader::readDataHeader(std::span<const std::byte> bytes) {
+
+    uint8_t typeId;
+    uint32_t length;
+
+    auto readFixed = [&bytes](size_t pos, void* dest, size_t size) {
+        if (pos > bytes.size() || size > bytes.size() - pos) {
+            throw std::runtime_error("Truncated header.");
         }
+        std::memcpy(dest, bytes.data() + pos, size);
+    };
+
+    readFixed(0, &typeId, sizeof(typeId));
+    readFixed(sizeof(typeId), &length, sizeof(length));
+    if (typeId != static_cast<uint8_t>(HeaderFieldType::HeaderSize)) {
+        throw std::runtime_error("Invalid header: expected HeaderSize first.");
+    }
+    readFixed(sizeof(typeId) + sizeof(length), &headerSize, sizeof(headerSize));
+
+    if (headerSize > bytes.size()) {
+        throw std::runtime_error("Truncated header.");
+    }
+
+    size_t bytesRead = sizeof(typeId) + sizeof(length) + sizeof(headerSize);
+    while (bytesRead < headerSize) {
+        readFixed(bytesRead, &typeId, sizeof(typeId));
+        readFixed(bytesRead + sizeof(typeId), &length, sizeof(length));
+        bytesRead += sizeof(typeId) + sizeof(length);
+
+        if (bytesRead > headerSize || length > headerSize - bytesRead) {
+            throw std::runtime_error("Header read mismatch.");
+        }
+
+        // Values are decoded straight out of the caller's buffer
+        readField(static_cast<HeaderFieldType>(typeId),
+            reinterpret_cast<const char*>(bytes.data() + bytesRead), length);
+        bytesRead += length;
     }
 
     if (bytesRead != headerSize) {
         throw std::runtime_error("Header read mismatch.");
     }
+}
 
+void DataHeader::readField(HeaderFieldType type, const char* value, uint32_t length) {
+    uint8_t typeId = static_cast<uint8_t>(type);
+    switch (type) {
+        case HeaderFieldType::MetadataSize:
+            if (length != sizeof(metaDataSize)) throw std::runtime_error("Invalid DataSize length.");
+            std::memcpy(&metaDataSize, value, sizeof(metaDataSize));
+            break;
+
+        case HeaderFieldType::DataSize:
+            if (length != sizeof(dataSize)) throw std::runtime_error("Invalid DataSize length.");
+            std::memcpy(&dataSize, value, sizeof(dataSize));
+            break;
+
+        case HeaderFieldType::StringSize:
+            if (length != sizeof(stringBufferSize)) throw std::runtime_error("Invalid StringSize length.");
+            std::memcpy(&stringBufferSize, value, sizeof(stringBufferSize));
+            break;
+
+        case HeaderFieldType::IsCurrent:
+            if (length != sizeof(isCurrent)) throw std::runtime_error("Invalid IsCurrent length.");
+            std::memcpy(&isCurrent, value, sizeof(isCurrent));
+            break;
+
+        case HeaderFieldType::PreviousVersion:
+            if (length != sizeof(previousVersion)) throw std::runtime_error("Invalid PreviousVersion length.");
+            std::memcpy(&previousVersion, value, sizeof(previousVersion));
+            break;
+
+        case HeaderFieldType::ModuleType:
+            moduleType = module_type_from_string(std::string(value, length));
+            break;
+
+        case HeaderFieldType::SchemaPath:
+            schemaPath = std::string(value, length);
+            break;
+
+        case HeaderFieldType::MetadataCompression:
+            if (length != 1) throw std::runtime_error("Invalid MetadataCompression length.");
+            metadataCompression = decodeCompressionType(value[0]);
+            break;
+
+        case HeaderFieldType::DataCompression:
+            if (length != 1) throw std::runtime_error("Invalid DataCompression length.");
+            dataCompression = decodeCompressionType(value[0]);
+            break;
+
+        case HeaderFieldType::MetadataZstdSettings:
+            metadataZstd = readZstdSettings(value, length);
+            break;
+
+        case HeaderFieldType::DataZstdSettings:
+            dataZstd = readZstdSettings(value, length);
+            break;
+
+        case HeaderFieldType::MetadataDictionaryID:
+            if (length != sizeof(metadataDictionaryID)) throw std::runtime_error("Invalid MetadataDictionaryID length.");
+            std::memcpy(&metadataDictionaryID, value, sizeof(metadataDictionaryID));
+            break;
+
+        case HeaderFieldType::ModuleSalt:
+            encryptionData.moduleSalt = std::vector<uint8_t>(value, value + length);
+            break;
+
+        case HeaderFieldType::IV:
+            encryptionData.iv = std::vector<uint8_t>(value, value + length);
+            break;
+
+        case HeaderFieldType::AuthTag:
+            encryptionData.authTag = std::vector<uint8_t>(value, value + length);
+            break;
+
+        case HeaderFieldType::EncryptionSegmentSize:
+            if (length != sizeof(uint32_t)) throw std::runtime_error("Invalid EncryptionSegmentSize length.");
+            std::memcpy(&encryptionData.segmentSize, value, sizeof(uint32_t));
+            break;
+
+        case HeaderFieldType::FramesSealed:
+            if (length != 1) throw std::runtime_error("Invalid FramesSealed length.");
+            encryptionData.framesSealed = value[0] != 0;
+            break;
+            
+        case HeaderFieldType::Endianness:
+            if (length != 1) throw std::runtime_error("Invalid Endianness length.");
+            littleEndian = value[0] != 0;
+            break;
+
+        case HeaderFieldType::ModuleID:
+            if (length != 16) throw std::runtime_error("Invalid UUID length.");
+            std::array<uint8_t, 16> id;
+            std::memcpy(id.data(), value, 16);
+            moduleID.setData(id);
+            break;
+
+        case HeaderFieldType::CreatedAt:
+            if (length != sizeof(createdAt.getTimestamp())) {
+                throw std::runtime_error("Invalid CreatedAt length.");
+            }
+            uint64_t timestamp;
+            std::memcpy(&timestamp, value, sizeof(timestamp));
+            createdAt = DateTime(timestamp);
+            break;
+
+        case HeaderFieldType::CreatedBy:
+            createdBy = std::string(value, length);
+            break;
+
+        case HeaderFieldType::ModifiedAt:
+            if (length != sizeof(modifiedAt.getTimestamp())) {
+                throw std::runtime_error("Invalid ModifiedAt length.");
+            }
+            std::memcpy(&timestamp, value, sizeof(timestamp));
+            modifiedAt = DateTime(timestamp);
+            break;
+
+        case HeaderFieldType::ModifiedBy:
+            modifiedBy = std::string(value, length);
+            break;
+
+        case HeaderFieldType::FrameIndexOffset:
+            if (length != sizeof(frameIndexOffset)) throw std::runtime_error("Invalid FrameIndexOffset length.");
+            std::memcpy(&frameIndexOffset, value, sizeof(frameIndexOffset));
+            hasFrameIndex = true;
+            break;
+        default:
+            throw std::runtime_error("Unknown HeaderFieldType: " + std::to_string(typeId));
+    }
+}
+
+void DataHeader::setMetadataDictionary(std::shared_ptr<const ZstdDictionary> dictionary) {
+    metadataDictionaryID = dictionary ? dictionary->getID() : 0;
+    metadataDictionary = std::move(dictionary);
+}
+
+void DataHeader::attachMetadataDictionary(const DictionaryTable* dictionaries) {
+
+    if (metadataDictionaryID == 0) {
+        return;
+    }
+
+    metadataDictionary = dictionaries ? dictionaries->find(metadataDictionaryID) : nullptr;
+    if (!metadataDictionary) {
+        throw std::runtime_error("Metadata dictionary " + std::to_string(metadataDictionaryID) + " not found in file.");
+    }
 }
 
 uint64_t DataHeader::getModuleSize() const {
@@ -274,7 +423,19 @@ std::ostream& operator<<(std::ostream& os, const DataHeader& header) {
        << "  moduleType          : " << header.moduleType << "\n"
        << "  schemaPath          : " << header.schemaPath << "\n"
        << "  metadataCompression : " << compressionToString(header.metadataCompression) << "\n"
-       << "  dataCompression     : " << compressionToString(header.dataCompression) << "\n"
+       << "  dataCompression     : " << compressionToString(header.dataCompression) << "\n";
+       if (header.metadataCompression == CompressionType::ZSTD) {
+           os << "  metadataZstdLevel   : " << header.metadataZstd.level
+              << (header.metadataZstd.longDistanceMatching ? " (long)" : "") << "\n";
+           if (header.metadataDictionaryID != 0) {
+               os << "  metadataDictionary  : " << header.metadataDictionaryID << "\n";
+           }
+       }
+       if (header.dataCompression == CompressionType::ZSTD) {
+           os << "  dataZstdLevel       : " << header.dataZstd.level
+              << (header.dataZstd.longDistanceMatching ? " (long)" : "") << "\n";
+       }
+       os
        << "  encryptionType      : "
        << EncryptionManager::encryptionToString(header.encryptionData.encryptionType) << "\n";
        if (header.encryptionData.encryptionType != EncryptionType::NONE) {
@@ -284,7 +445,9 @@ std::ostream& operator<<(std::ostream& os, const DataHeader& header) {
               << "  timeCost            : " << header.encryptionData.timeCost << "\n"
               << "  parallelism         : " << header.encryptionData.parallelism << "\n"
               << "  iv                  : " << header.encryptionData.iv.size() << "\n"
-              << "  authTag             : " << header.encryptionData.authTag.size() << "\n";
+              << "  authTag             : " << header.encryptionData.authTag.size() << "\n"
+              << "  segmentSize         : " << header.encryptionData.segmentSize << "\n"
+              << "  framesSealed        : " << std::boolalpha << header.encryptionData.framesSealed << "\n";
        }
        os 
        << "  littleEndian        : " << std::boolalpha << header.littleEndian << "\n"
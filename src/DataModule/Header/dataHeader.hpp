@@ -4,12 +4,17 @@
 #include <string>
 #include <fstream>
 #include <expected>
+#include <span>
+#include <cstddef>
 
 #include "../../Utility/uuid.hpp"
 #include "../../Utility/moduleType.hpp"
 #include "../../Utility/Compression/CompressionType.hpp"
+#include "../../Utility/Compression/ZstdCompressor.hpp"
+#include "../../Utility/Compression/ZstdDictionary.hpp"
 #include "../../Utility/Encryption/encryptionManager.hpp"
 #include "../../Utility/dateTime.hpp"
+#include "../../Utility/tlvHeader.hpp"
 
 struct DataHeader {
 protected:
@@ -32,6 +37,11 @@ protected:
 
     std::streampos authTagPos = 0;
 
+    // Image modules only: offset of the frame index from the start of the data section
+    bool hasFrameIndex = false;
+    uint64_t frameIndexOffset = 0;
+    std::streampos frameIndexOffsetPos = 0;
+
     std::streampos dataOffsetPos = 0;
     std::streampos stringOffsetPos = 0;
 
@@ -39,6 +49,13 @@ protected:
     std::string schemaPath;
     CompressionType metadataCompression;
     CompressionType dataCompression;
+    // Encoder settings for ZSTD sections, recorded for reference only
+    ZstdSettings metadataZstd;
+    ZstdSettings dataZstd;
+    // Dictionary the metadata is compressed with, 0 for none. The dictionary
+    // itself lives in the file's dictionary table and is attached on read.
+    uint32_t metadataDictionaryID = 0;
+    std::shared_ptr<const ZstdDictionary> metadataDictionary;
     EncryptionData encryptionData;
     bool littleEndian;
     UUID moduleID;
@@ -50,6 +67,8 @@ protected:
 
     // virtual bool handleExtraField(HeaderFieldType, const std::vector<char>&) = 0;
 
+    void readField(HeaderFieldType type, const char* value, uint32_t length);
+
 public:
 
     // GETTTERS AND SETTERS
@@ -86,6 +105,21 @@ public:
     CompressionType getDataCompression() const { return dataCompression; }
     void setDataCompression(CompressionType compression) { dataCompression = compression; }
 
+    ZstdSettings getMetadataZstd() const { return metadataZstd; }
+    void setMetadataZstd(ZstdSettings settings) { metadataZstd = settings; }
+
+    ZstdSettings getDataZstd() const { return dataZstd; }
+    void setDataZstd(ZstdSettings settings) { dataZstd = settings; }
+
+    uint32_t getMetadataDictionaryID() const { return metadataDictionaryID; }
+    std::shared_ptr<const ZstdDictionary> getMetadataDictionary() const { return metadataDictionary; }
+
+    // Also records the dictionary's ID, nullptr compresses without one
+    void setMetadataDictionary(std::shared_ptr<const ZstdDictionary> dictionary);
+
+    // Look up the dictionary named in the header, throws if the table lacks it
+    void attachMetadataDictionary(const DictionaryTable* dictionaries);
+
     bool getLittleEndian() const { return littleEndian; }
     void setLittleEndian(bool lE) { littleEndian = lE; }
 
@@ -115,6 +149,13 @@ public:
     bool getIsCurrent() const { return isCurrent; }
     void setIsCurrent(bool current) { isCurrent = current; }
 
+    // Must be set before writeToFile() so the field is reserved in the header
+    bool getHasFrameIndex() const { return hasFrameIndex; }
+    void setHasFrameIndex(bool has) { hasFrameIndex = has; }
+
+    uint64_t getFrameIndexOffset() const { return frameIndexOffset; }
+    void setFrameIndexOffset(uint64_t offset) { frameIndexOffset = offset; }
+
 // METHODS
     virtual ~DataHeader() = default;
 
@@ -124,6 +165,7 @@ public:
 
     void readHeaderSize(std::istream& in);
     void readDataHeader(std::istream& in);
+    void readDataHeader(std::span<const std::byte> bytes);
 
     bool updateIsCurrent(bool newIsCurrent, std::fstream& fileStream);
 
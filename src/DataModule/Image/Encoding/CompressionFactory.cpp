@@ -34,6 +34,14 @@ CompressionFactory::CompressionFactory() {
         return std::make_unique<PNGCompression>();
     });
     
+    registerStrategy(CompressionType::ZSTD, []() -> std::unique_ptr<CompressionStrategy> {
+        return std::make_unique<ZstdFrameCompression>();
+    });
+    
+    registerStrategy(CompressionType::JPEGLS_LOSSLESS, []() -> std::unique_ptr<CompressionStrategy> {
+        return std::make_unique<JPEGLSCompression>();
+    });
+    
     // Add RAW strategy (no compression)
     registerStrategy(CompressionType::RAW, []() -> std::unique_ptr<CompressionStrategy> {
         return std::make_unique<RawCompression>();
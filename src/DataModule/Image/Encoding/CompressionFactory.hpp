@@ -2,7 +2,9 @@
 
 #include "CompressionStrategy.hpp"
 #include "JPEG2000Compression.hpp"
+#include "JPEGLSCompression.hpp"
 #include "PNGCompression.hpp"
+#include "ZstdFrameCompression.hpp"
 #include "Utility/Compression/CompressionType.hpp"
 #include <map>
 #include <memory>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 #include <memory>
 #include <string>
@@ -35,6 +37,60 @@ public:
      */
     virtual std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressedData) const = 0;
     
+    /**
+     * @brief Decompress at reduced resolution
+     * 
+     * Codecs with resolution levels decode only the levels needed. The default
+     * decodes at full resolution and leaves width and height untouched.
+     * @param compressedData Compressed data
+     * @param reduceLevel Number of times width and height are halved
+     * @param width Full width on input, decoded width on output
+     * @param height Full height on input, decoded height on output
+     * @return Decompressed raw data of width x height pixels
+     */
+    virtual std::vector<uint8_t> decompressReduced(const std::vector<uint8_t>& compressedData,
+                                                   [[maybe_unused]] int reduceLevel,
+                                                   [[maybe_unused]] int& width,
+                                                   [[maybe_unused]] int& height) const {
+        return decompress(compressedData);
+    }
+    
+    /**
+     * @brief Decompress a rectangular region of an image
+     * 
+     * Codecs that can decode parts of an image only decode the region. The
+     * default decodes the whole image and copies the region's rows out.
+     * @param compressedData Compressed data
+     * @param width Full image width
+     * @param height Full image height
+     * @param channels Number of color channels
+     * @param bitDepth Bits per channel
+     * @param x Left edge of the region
+     * @param y Top edge of the region
+     * @param regionWidth Region width, x + regionWidth must not exceed width
+     * @param regionHeight Region height, y + regionHeight must not exceed height
+     * @return Decompressed raw data of regionWidth x regionHeight pixels
+     */
+    virtual std::vector<uint8_t> decompressRegion(const std::vector<uint8_t>& compressedData,
+                                                  int width, [[maybe_unused]] int height,
+                                                  uint8_t channels, uint8_t bitDepth,
+                                                  int x, int y, int regionWidth, int regionHeight) const {
+        std::vector<uint8_t> image = decompress(compressedData);
+        size_t pixelBytes = static_cast<size_t>(channels) * ((bitDepth + 7) / 8);
+        size_t rowBytes = static_cast<size_t>(width) * pixelBytes;
+        size_t regionRowBytes = static_cast<size_t>(regionWidth) * pixelBytes;
+        if (image.size() < rowBytes * (y + regionHeight)) {
+            throw std::runtime_error("Decoded image is smaller than its dimensions");
+        }
+
+        std::vector<uint8_t> region(regionRowBytes * regionHeight);
+        for (int row = 0; row < regionHeight; ++row) {
+            std::copy_n(image.begin() + rowBytes * (y + row) + pixelBytes * x, regionRowBytes,
+                        region.begin() + regionRowBytes * row);
+        }
+        return region;
+    }
+    
     /**
      * @brief Get the compression type identifier
      * @return String identifier for this compression type
@@ -7,6 +7,7 @@
 #include <stdexcept>
 #include <iomanip>
 #include <chrono>
+#include <unordered_map>
 
 ImageEncoder::ImageEncoder() {
     // Constructor - initialize with default factory
@@ -29,10 +30,9 @@ std::vector<uint8_t> ImageEncoder::compress(const std::vector<uint8_t>& rawData,
                                             uint8_t channels, uint8_t bitDepth) const {
     // Note: Individual frame timing removed - use total timing from ImageData instead
     
-    // Create a temporary strategy for this specific compression type
-    auto tempStrategy = factory->createStrategy(encoding);
+    auto strategy = getStrategy(encoding);
     
-    if (!tempStrategy) {
+    if (!strategy) {
         std::cerr << "ERROR: Failed to create strategy for " << compressionTypeToString(encoding) << ", returning raw data!" << std::endl;
         std::cerr << "Available strategies: ";
         auto availableTypes = factory->getSupportedTypes();
@@ -44,34 +44,86 @@ std::vector<uint8_t> ImageEncoder::compress(const std::vector<uint8_t>& rawData,
     }
     
     // Check if the strategy supports the given parameters
-    if (!tempStrategy->supports(channels, bitDepth)) {
+    if (!strategy->supports(channels, bitDepth)) {
         std::cerr << "Warning: Compression type " << compressionTypeToString(encoding) 
                   << " may not support " << static_cast<int>(channels) << " channels and " 
                   << static_cast<int>(bitDepth) << " bit depth" << std::endl;
     }
     
-    return tempStrategy->compress(rawData, width, height, channels, bitDepth);
+    return strategy->compress(rawData, width, height, channels, bitDepth);
 }
 
 std::vector<uint8_t> ImageEncoder::decompress(const std::vector<uint8_t>& compressedData,
                                               CompressionType encoding) const {
     // Note: Individual frame timing removed - use total timing from ImageData instead
     
-    // Create a temporary strategy for this specific compression type
-    auto tempStrategy = factory->createStrategy(encoding);
+    auto strategy = getStrategy(encoding);
     
-    if (!tempStrategy) {
+    if (!strategy) {
         std::cerr << "Warning: Unsupported compression type " << compressionTypeToString(encoding) << ", returning as-is" << std::endl;
         return compressedData;
     }
     
-    return tempStrategy->decompress(compressedData);
+    return strategy->decompress(compressedData);
+}
+
+std::vector<uint8_t> ImageEncoder::decompressReduced(const std::vector<uint8_t>& compressedData,
+                                                     CompressionType encoding, int reduceLevel,
+                                                     int& width, int& height) const {
+    auto strategy = getStrategy(encoding);
+    
+    if (!strategy) {
+        std::cerr << "Warning: Unsupported compression type " << compressionTypeToString(encoding) << ", returning as-is" << std::endl;
+        return compressedData;
+    }
+    
+    return strategy->decompressReduced(compressedData, reduceLevel, width, height);
+}
+
+std::vector<uint8_t> ImageEncoder::decompressRegion(const std::vector<uint8_t>& compressedData,
+                                                    CompressionType encoding,
+                                                    int width, int height, uint8_t channels, uint8_t bitDepth,
+                                                    int x, int y, int regionWidth, int regionHeight) const {
+    auto strategy = getStrategy(encoding);
+    
+    if (!strategy) {
+        throw std::runtime_error("Unsupported compression type " + compressionTypeToString(encoding));
+    }
+    
+    return strategy->decompressRegion(compressedData, width, height, channels, bitDepth,
+                                          x, y, regionWidth, regionHeight);
 }
 
 
 
 
 
+const CompressionStrategy* ImageEncoder::getStrategy(CompressionType encoding) const {
+    // Each thread keeps the strategies of the encoders it has used, keyed by
+    // their factory. An entry whose factory is gone belongs to a destroyed
+    // encoder, possibly at the same address as a new one, and is dropped.
+    struct ThreadStrategies {
+        std::weak_ptr<CompressionStrategyFactory> owner;
+        StrategyCache strategies;
+    };
+    thread_local std::unordered_map<const CompressionStrategyFactory*, ThreadStrategies> caches;
+    
+    auto found = caches.find(factory.get());
+    if (found == caches.end() || found->second.owner.expired()) {
+        std::erase_if(caches, [](const auto& entry) { return entry.second.owner.expired(); });
+        found = caches.try_emplace(factory.get()).first;
+        found->second.owner = factory;
+    }
+    StrategyCache& cache = found->second.strategies;
+    
+    // Unregistered types are cached as nullptr too, so the factory is asked once
+    auto it = cache.find(encoding);
+    if (it == cache.end()) {
+        it = cache.emplace(encoding, factory->createStrategy(encoding)).first;
+    }
+    return it->second.get();
+}
+
 // Helper method to convert CompressionType enum to string
 std::string ImageEncoder::compressionTypeToString(CompressionType type) const {
     switch (type) {
@@ -80,7 +132,9 @@ std::string ImageEncoder::compressionTypeToString(CompressionType type) const {
         case CompressionType::PNG:
             return "PNG";
         case CompressionType::ZSTD:
-            return "ZSTD";  // Note: ZSTD not implemented yet
+            return "ZSTD";
+        case CompressionType::JPEGLS_LOSSLESS:
+            return "JPEGLS_LOSSLESS";
         case CompressionType::RAW:
         default:
             return "RAW";
@@ -5,11 +5,19 @@
 #include <cstdint>
 #include <string>
 #include <memory>
+#include <map>
 
 #include "../../../Utility/Compression/CompressionType.hpp"
 #include "CompressionStrategy.hpp"
 #include "CompressionFactory.hpp"
 
+/**
+ * Encodes and decodes frames with the strategy for each frame's encoding.
+ *
+ * Strategies are created once per encoder and calling thread and then reused,
+ * so codecs can keep scratch state between frames. One encoder can be shared
+ * by all the worker threads of a parallel encode or decode.
+ */
 class ImageEncoder {
 public:
     // Constructor
@@ -30,6 +38,21 @@ public:
     std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressedData,
                                     CompressionType encoding) const;
     
+    // Decode with reduceLevel halvings where the codec supports it. width and
+    // height hold the full size on input and the decoded size on output.
+    std::vector<uint8_t> decompressReduced(const std::vector<uint8_t>& compressedData,
+                                           CompressionType encoding, int reduceLevel,
+                                           int& width, int& height) const;
+    
+    // Decode only the given region where the codec supports it, otherwise decode and slice
+    std::vector<uint8_t> decompressRegion(const std::vector<uint8_t>& compressedData,
+                                          CompressionType encoding,
+                                          int width, int height, uint8_t channels, uint8_t bitDepth,
+                                          int x, int y, int regionWidth, int regionHeight) const;
+    
+    
+    // The calling thread's cached strategy for encoding, nullptr if none is registered
+    const CompressionStrategy* getStrategy(CompressionType encoding) const;
     
     // Strategy management methods
     void setCompressionStrategy(std::unique_ptr<CompressionStrategy> strategy);
@@ -45,6 +68,10 @@ private:
     std::unique_ptr<CompressionStrategy> compressionStrategy;
     std::shared_ptr<CompressionStrategyFactory> factory;
     
+    // Strategies of one encoder on one thread. They live in thread_local
+    // storage (see getStrategy), so they go away with the thread that made them.
+    using StrategyCache = std::map<CompressionType, std::unique_ptr<CompressionStrategy>>;
+    
     // Helper method to convert CompressionType enum to string
     std::string compressionTypeToString(CompressionType type) const;
     
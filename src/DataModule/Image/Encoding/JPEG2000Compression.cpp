@@ -1,9 +1,105 @@
 #include "JPEG2000Compression.hpp"
+#include "SampleFilters.hpp"
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 #include <iomanip>
 
+std::atomic<int> JPEG2000Compression::threadCount{1};
+
+namespace {
+
+    struct CodecDeleter { void operator()(opj_codec_t* codec) const { opj_destroy_codec(codec); } };
+    struct StreamDeleter { void operator()(opj_stream_t* stream) const { opj_stream_destroy(stream); } };
+    struct ImageDeleter { void operator()(opj_image_t* image) const { opj_image_destroy(image); } };
+
+    using CodecPtr = std::unique_ptr<opj_codec_t, CodecDeleter>;
+    using StreamPtr = std::unique_ptr<opj_stream_t, StreamDeleter>;
+    using ImagePtr = std::unique_ptr<opj_image_t, ImageDeleter>;
+
+    // Encoder state kept between frames on the same thread
+    struct EncodeScratch {
+        ImagePtr image;
+        int width = 0;
+        int height = 0;
+        uint8_t channels = 0;
+        uint8_t bitDepth = 0;
+        std::vector<uint8_t> output;
+
+        // One image header serves a whole module. opj_start_compress takes
+        // the component planes and leaves NULL in their place, so every frame
+        // after the first gets fresh planes before it is written into.
+        opj_image_t* imageFor(int w, int h, uint8_t c, uint8_t depth) {
+            if (image && width == w && height == h && channels == c && bitDepth == depth) {
+                size_t planeBytes = static_cast<size_t>(w) * h * sizeof(OPJ_INT32);
+                for (OPJ_UINT32 i = 0; i < image->numcomps; ++i) {
+                    if (!image->comps[i].data) {
+                        image->comps[i].data = static_cast<OPJ_INT32*>(opj_image_data_alloc(planeBytes));
+                        if (!image->comps[i].data) {
+                            return nullptr;
+                        }
+                    }
+                }
+                return image.get();
+            }
+
+            std::vector<opj_image_cmptparm_t> cmptparm(c);
+            for (auto& component : cmptparm) {
+                std::memset(&component, 0, sizeof(component));
+                component.dx = 1;
+                component.dy = 1;
+                component.w = w;
+                component.h = h;
+                component.prec = depth;
+                component.bpp = depth;
+                component.sgnd = 0;  // unsigned
+            }
+
+            // Pick colorspace based on channels
+            OPJ_COLOR_SPACE colorSpace = (c == 1) ? OPJ_CLRSPC_GRAY : OPJ_CLRSPC_SRGB;
+            image.reset(opj_image_create(c, cmptparm.data(), colorSpace));
+            if (!image) {
+                width = height = 0;
+                return nullptr;
+            }
+
+            // Set image bounds (required for opj_start_compress)
+            image->x0 = 0;
+            image->y0 = 0;
+            image->x1 = w;
+            image->y1 = h;
+
+            width = w;
+            height = h;
+            channels = c;
+            bitDepth = depth;
+            return image.get();
+        }
+    };
+
+    thread_local EncodeScratch encodeScratch;
+}
+
+void JPEG2000Compression::setThreadCount(int threads) {
+    threadCount = std::max(threads, 0);
+}
+
+int JPEG2000Compression::getThreadCount() {
+    return threadCount;
+}
+
+void JPEG2000Compression::configureThreads(opj_codec_t* codec) {
+    int threads = threadCount;
+    if (threads == 0) {
+        threads = opj_get_num_cpus();
+    }
+    if (threads > 1 && opj_has_thread_support()) {
+        opj_codec_set_threads(codec, threads);
+    }
+}
+
 std::vector<uint8_t> JPEG2000Compression::compress(const std::vector<uint8_t>& rawData, 
                                                    int width, int height,
                                                    uint8_t channels, uint8_t bitDepth) const {
@@ -16,6 +112,10 @@ std::vector<uint8_t> JPEG2000Compression::compress(const std::vector<uint8_t>& r
                   << ", bytesPerPixel: " << bytesPerPixel << ")" << std::endl;
         return rawData;
     }
+    if (bytesPerPixel > 2) {
+        std::cerr << "JPEG2000: Unsupported bit depth: " << static_cast<int>(bitDepth) << std::endl;
+        return rawData;
+    }
     
     std::cerr << "JPEG2000: Starting compression. Size: " << rawData.size() 
               << ", Dimensions: " << width << "x" << height 
@@ -44,162 +144,80 @@ std::vector<uint8_t> JPEG2000Compression::compress(const std::vector<uint8_t>& r
         int num_resolutions = std::min(max_possible, 6);
         parameters.numresolution = num_resolutions;
         
-        // Create image component parameters for all channels
-        std::vector<opj_image_cmptparm_t> cmptparm(channels);
-        for (int c = 0; c < channels; ++c) {
-            cmptparm[c].dx = 1;
-            cmptparm[c].dy = 1;
-            cmptparm[c].w = width;
-            cmptparm[c].h = height;
-            cmptparm[c].prec = bitDepth;
-            cmptparm[c].bpp = bitDepth;
-            cmptparm[c].sgnd = 0;  // unsigned
-        }
-        
-        // Pick colorspace based on channels
-        OPJ_COLOR_SPACE color_space = (channels == 1) ? OPJ_CLRSPC_GRAY : OPJ_CLRSPC_SRGB;
-        
-        // Create image
-        opj_image_t* image = opj_image_create(channels, cmptparm.data(), color_space);
+        opj_image_t* image = encodeScratch.imageFor(width, height, channels, bitDepth);
         if (!image) {
             std::cerr << "JPEG2000: Failed to create image" << std::endl;
             return rawData;
         }
-
-        // Set image bounds (required for opj_start_compress)
-        image->x0 = 0;
-        image->y0 = 0;
-        image->x1 = width;
-        image->y1 = height;
         
-        // Check if image data is allocated for all components
+        // Split the interleaved samples into one plane per component
+        size_t pixels = static_cast<size_t>(width) * height;
         for (int c = 0; c < channels; ++c) {
             if (!image->comps[c].data) {
                 std::cerr << "JPEG2000: Image component " << c << " data not allocated" << std::endl;
-                opj_image_destroy(image);
                 return rawData;
             }
+            SampleFilters::widenToInt32(rawData.data() + c * bytesPerPixel, image->comps[c].data,
+                                        pixels, channels, static_cast<int>(bytesPerPixel));
         }
         
-        // Copy pixel data to image based on bit depth (interleaved for multi-channel)
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                size_t pixel_index = static_cast<size_t>(y * width + x);
-                
-                if (pixel_index >= static_cast<size_t>(width * height)) {
-                    continue;
-                }
-                
-                if (channels == 1) {
-                    // Single channel (grayscale)
-                    size_t data_index = pixel_index * bytesPerPixel;
-                    if (data_index + bytesPerPixel <= rawData.size()) {
-                        if (bitDepth == 8) {
-                            image->comps[0].data[pixel_index] = rawData[data_index];
-                        } else if (bitDepth == 16) {
-                            // Combine two bytes into 16-bit value (little-endian)
-                            uint16_t value = rawData[data_index] | (rawData[data_index + 1] << 8);
-                            image->comps[0].data[pixel_index] = value;
-                        } else {
-                            std::cerr << "JPEG2000: Unsupported bit depth: " << static_cast<int>(bitDepth) << std::endl;
-                            return rawData;
-                        }
-                    }
-                } else {
-                    // Multi-channel (interleaved) - RGBRGB... format
-                    for (int c = 0; c < channels; c++) {
-                        size_t data_index = (pixel_index * channels + c) * bytesPerPixel;
-                        if (data_index + bytesPerPixel <= rawData.size()) {
-                            if (bitDepth == 8) {
-                                image->comps[c].data[pixel_index] = rawData[data_index];
-                            } else if (bitDepth == 16) {
-                                // Combine two bytes into 16-bit value (little-endian)
-                                uint16_t value = rawData[data_index] | (rawData[data_index + 1] << 8);
-                                image->comps[c].data[pixel_index] = value;
-                            } else {
-                                std::cerr << "JPEG2000: Unsupported bit depth: " << static_cast<int>(bitDepth) << std::endl;
-                                return rawData;
-                            }
-                        }
-                    }
-                }
-            }
+        // Create output memory stream, the buffer is reused and grows on demand
+        std::vector<uint8_t>& output_buffer = encodeScratch.output;
+        if (output_buffer.size() < rawData.size() / 2) {
+            output_buffer.resize(rawData.size() / 2);
         }
-        
-        // Create output memory stream
-        std::vector<uint8_t> output_buffer(rawData.size() * 2);  // Start with 2x size
         MemoryStreamData ms_data = {
             nullptr,                    // No input data for compression
-            output_buffer.data(),       // Output buffer
+            &output_buffer,             // Output buffer
             0,                          // No input size
             0,                          // Output size starts at 0
-            0,                          // Current position starts at 0
-            output_buffer.size()        // Max output size
+            0                           // Current position starts at 0
         };
         
         // Create OpenJPEG stream
-        opj_stream_t* stream = opj_stream_create(OPJ_J2K_STREAM_CHUNK_SIZE, OPJ_FALSE);
+        StreamPtr stream(opj_stream_create(OPJ_J2K_STREAM_CHUNK_SIZE, OPJ_FALSE));
         if (!stream) {
-            opj_image_destroy(image);
             return rawData;
         }
 
         // Set up stream functions
-        opj_stream_set_write_function(stream, memory_write);
-        opj_stream_set_skip_function(stream, memory_skip);
-        opj_stream_set_seek_function(stream, memory_seek);
-        opj_stream_set_user_data(stream, &ms_data, nullptr);
+        opj_stream_set_write_function(stream.get(), memory_write);
+        opj_stream_set_skip_function(stream.get(), memory_skip);
+        opj_stream_set_seek_function(stream.get(), memory_seek);
+        opj_stream_set_user_data(stream.get(), &ms_data, nullptr);
         
         // Create codec
-        opj_codec_t* codec = opj_create_compress(OPJ_CODEC_J2K);
+        CodecPtr codec(opj_create_compress(OPJ_CODEC_J2K));
         if (!codec) {
-            opj_stream_destroy(stream);
-            opj_image_destroy(image);
             return rawData;
         }
 
         // Set up codec
-        if (!opj_setup_encoder(codec, &parameters, image)) {
+        if (!opj_setup_encoder(codec.get(), &parameters, image)) {
             std::cerr << "JPEG2000: Failed to setup encoder" << std::endl;
-            opj_stream_destroy(stream);
-            opj_image_destroy(image);
-            opj_destroy_codec(codec);
             return rawData;
         }
+        configureThreads(codec.get());
         
         // Start compression
-        if (!opj_start_compress(codec, image, stream)) {
+        if (!opj_start_compress(codec.get(), image, stream.get())) {
             std::cerr << "JPEG2000: Failed to start compression" << std::endl;
-            opj_stream_destroy(stream);
-            opj_image_destroy(image);
-            opj_destroy_codec(codec);
             return rawData;
         }
         
-        if (!opj_encode(codec, stream)) {
+        if (!opj_encode(codec.get(), stream.get())) {
             std::cerr << "JPEG2000: Failed to encode" << std::endl;
-            opj_stream_destroy(stream);
-            opj_image_destroy(image);
-            opj_destroy_codec(codec);
             return rawData;
         }
         
-        if (!opj_end_compress(codec, stream)) {
+        if (!opj_end_compress(codec.get(), stream.get())) {
             std::cerr << "JPEG2000: Failed to end compression" << std::endl;
-            opj_stream_destroy(stream);
-            opj_image_destroy(image);
-            opj_destroy_codec(codec);
             return rawData;
         }
         
-        // Clean up
-        opj_stream_destroy(stream);
-        opj_image_destroy(image);
-        opj_destroy_codec(codec);
-        
         // Return compressed data
-        std::vector<uint8_t> compressed_data(ms_data.output_buffer, 
-                                           ms_data.output_buffer + ms_data.output_size);
+        std::vector<uint8_t> compressed_data(output_buffer.begin(), 
+                                           output_buffer.begin() + ms_data.output_size);
         
         std::cerr << "JPEG2000: Compression successful. Original: " << rawData.size() 
                   << " bytes, Compressed: " << compressed_data.size() 
@@ -215,6 +233,31 @@ std::vector<uint8_t> JPEG2000Compression::compress(const std::vector<uint8_t>& r
 }
 
 std::vector<uint8_t> JPEG2000Compression::decompress(const std::vector<uint8_t>& compressedData) const {
+    return decode(compressedData, 0, nullptr, nullptr, nullptr);
+}
+
+std::vector<uint8_t> JPEG2000Compression::decompressReduced(const std::vector<uint8_t>& compressedData,
+                                                            int reduceLevel, int& width, int& height) const {
+    return decode(compressedData, reduceLevel, nullptr, &width, &height);
+}
+
+std::vector<uint8_t> JPEG2000Compression::decompressRegion(const std::vector<uint8_t>& compressedData,
+                                                           [[maybe_unused]] int width, [[maybe_unused]] int height,
+                                                           [[maybe_unused]] uint8_t channels,
+                                                           [[maybe_unused]] uint8_t bitDepth,
+                                                           int x, int y, int regionWidth, int regionHeight) const {
+    DecodeArea area{ x, y, x + regionWidth, y + regionHeight };
+    int decodedWidth = 0;
+    int decodedHeight = 0;
+    std::vector<uint8_t> region = decode(compressedData, 0, &area, &decodedWidth, &decodedHeight);
+    if (decodedWidth != regionWidth || decodedHeight != regionHeight) {
+        throw std::runtime_error("JPEG2000: Failed to decode region");
+    }
+    return region;
+}
+
+std::vector<uint8_t> JPEG2000Compression::decode(const std::vector<uint8_t>& compressedData, int reduceLevel,
+                                                 const DecodeArea* area, int* decodedWidth, int* decodedHeight) const {
     // Sanity check: ensure we have enough data for a valid JPEG 2000 codestream
     if (compressedData.size() < 16) {
         return compressedData;
@@ -227,103 +270,89 @@ std::vector<uint8_t> JPEG2000Compression::decompress(const std::vector<uint8_t>&
             nullptr,                      // No output buffer for reading
             compressedData.size(),        // Input data size
             0,                           // No output size for reading
-            0,                           // Current position starts at 0
-            0                            // No max output size for reading
+            0                            // Current position starts at 0
         };
         
         // Create OpenJPEG stream for reading
-        opj_stream_t* stream = opj_stream_create(OPJ_J2K_STREAM_CHUNK_SIZE, OPJ_TRUE);
+        StreamPtr stream(opj_stream_create(OPJ_J2K_STREAM_CHUNK_SIZE, OPJ_TRUE));
         if (!stream) {
             return compressedData;
         }
         
         // Set up stream functions for reading
-        opj_stream_set_read_function(stream, memory_read);
-        opj_stream_set_skip_function(stream, memory_skip);
-        opj_stream_set_seek_function(stream, memory_seek);
-        opj_stream_set_user_data(stream, &ms_data, nullptr);
-        opj_stream_set_user_data_length(stream, ms_data.input_size);
+        opj_stream_set_read_function(stream.get(), memory_read);
+        opj_stream_set_skip_function(stream.get(), memory_skip);
+        opj_stream_set_seek_function(stream.get(), memory_seek);
+        opj_stream_set_user_data(stream.get(), &ms_data, nullptr);
+        opj_stream_set_user_data_length(stream.get(), ms_data.input_size);
         
         // Create decoder
-        opj_codec_t* codec = opj_create_decompress(OPJ_CODEC_J2K);
+        CodecPtr codec(opj_create_decompress(OPJ_CODEC_J2K));
         if (!codec) {
-            opj_stream_destroy(stream);
             return compressedData;
         }
 
         // Set decoder parameters
         opj_dparameters_t parameters;
         opj_set_default_decoder_parameters(&parameters);
-        if (!opj_setup_decoder(codec, &parameters)) {
-            opj_stream_destroy(stream);
-            opj_destroy_codec(codec);
+        if (!opj_setup_decoder(codec.get(), &parameters)) {
             return compressedData;
         }
+        configureThreads(codec.get());
 
         // Read header
-        opj_image_t* image = nullptr;
-        if (!opj_read_header(stream, codec, &image)) {
-            opj_stream_destroy(stream);
-            opj_destroy_codec(codec);
+        opj_image_t* rawImage = nullptr;
+        if (!opj_read_header(stream.get(), codec.get(), &rawImage)) {
+            return compressedData;
+        }
+        ImagePtr image(rawImage);
+
+        // Codestreams with fewer resolution levels reject larger factors, use the smallest level available
+        while (reduceLevel > 0 && !opj_set_decoded_resolution_factor(codec.get(), reduceLevel)) {
+            --reduceLevel;
+        }
+
+        if (area && !opj_set_decode_area(codec.get(), image.get(), area->x0, area->y0, area->x1, area->y1)) {
             return compressedData;
         }
 
         // Decode the image
-        if (!opj_decode(codec, stream, image)) {
-            opj_stream_destroy(stream);
-            opj_destroy_codec(codec);
-            opj_image_destroy(image);
+        if (!opj_decode(codec.get(), stream.get(), image.get())) {
             return compressedData;
         }
 
-        if (!opj_end_decompress(codec, stream)) {
+        if (!opj_end_decompress(codec.get(), stream.get())) {
             // Silent failure for end decompression
         }
         
-        // Extract pixel data from the decoded image
-        std::vector<uint8_t> decompressedData;
-        
         // Calculate expected size
         int width = image->comps[0].w;
         int height = image->comps[0].h;
         int numComponents = image->numcomps;
-        
-        // Allocate output buffer
-        size_t totalPixels = width * height;
-        size_t totalBytes = totalPixels * numComponents;
-        decompressedData.resize(totalBytes);
-        
-        // Copy pixel data from image components
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                size_t pixel_index = static_cast<size_t>(y * width + x);
-                
-                if (pixel_index >= static_cast<size_t>(width * height)) {
-                    continue;
-                }
-                
-                if (numComponents == 1) {
-                    // Single channel (grayscale)
-                    if (pixel_index < static_cast<size_t>(image->comps[0].w * image->comps[0].h)) {
-                        decompressedData[pixel_index] = static_cast<uint8_t>(image->comps[0].data[pixel_index]);
-                    }
-                } else {
-                    // Multi-channel (interleaved) - RGBRGB... format
-                    for (int c = 0; c < numComponents; c++) {
-                        size_t data_index = pixel_index * numComponents + c;
-                        if (data_index < decompressedData.size() && pixel_index < static_cast<size_t>(image->comps[c].w * image->comps[c].h)) {
-                            decompressedData[data_index] = static_cast<uint8_t>(image->comps[c].data[pixel_index]);
-                        }
-                    }
-                }
+
+        // Subsampled components are never written by compress()
+        for (int c = 0; c < numComponents; ++c) {
+            if (static_cast<int>(image->comps[c].w) != width || static_cast<int>(image->comps[c].h) != height ||
+                !image->comps[c].data) {
+                return compressedData;
             }
         }
         
-        // Clean up
-        opj_stream_destroy(stream);
-        opj_destroy_codec(codec);
-        opj_image_destroy(image);
+        // Samples above 8 bits were stored as 16-bit little-endian
+        int bytesPerSample = image->comps[0].prec > 8 ? 2 : 1;
+        size_t totalPixels = static_cast<size_t>(width) * height;
+        std::vector<uint8_t> decompressedData(totalPixels * numComponents * bytesPerSample);
         
+        // Interleave the component planes - RGBRGB... format
+        for (int c = 0; c < numComponents; c++) {
+            SampleFilters::narrowFromInt32(image->comps[c].data, decompressedData.data() + c * bytesPerSample,
+                                           totalPixels, numComponents, bytesPerSample);
+        }
+        
+        if (decodedWidth && decodedHeight) {
+            *decodedWidth = width;
+            *decodedHeight = height;
+        }
         return decompressedData;
         
     } catch (const std::exception& e) {
@@ -347,22 +376,27 @@ OPJ_SIZE_T JPEG2000Compression::memory_read(void* buffer, OPJ_SIZE_T size, void*
 
 OPJ_SIZE_T JPEG2000Compression::memory_write(void* buffer, OPJ_SIZE_T size, void* user_data) {
     MemoryStreamData* ms = (MemoryStreamData*)user_data;
-    if (ms->current_pos + size <= ms->max_output_size) {
-        memcpy(ms->output_buffer + ms->current_pos, buffer, size);
-        ms->current_pos += size;
-        ms->output_size = std::max(ms->output_size, ms->current_pos);
-        return size;
+    if (!ms || !ms->output_buffer) return (OPJ_SIZE_T)-1;
+    size_t end = ms->current_pos + size;
+    if (end > ms->output_buffer->size()) {
+        ms->output_buffer->resize(std::max(end, ms->output_buffer->size() * 2));
     }
-    return 0;
+    memcpy(ms->output_buffer->data() + ms->current_pos, buffer, size);
+    ms->current_pos = end;
+    ms->output_size = std::max(ms->output_size, ms->current_pos);
+    return size;
 }
 
 OPJ_OFF_T JPEG2000Compression::memory_skip(OPJ_OFF_T offset, void* user_data) {
     MemoryStreamData* ms = (MemoryStreamData*)user_data;
     if (!ms) return -1;
 
+    // Writers may move anywhere up to what was written so far
+    size_t limit = ms->output_buffer ? ms->output_size : ms->input_size;
+
     // Use signed arithmetic to check bounds
     long long new_pos = (long long)ms->current_pos + (long long)offset;
-    if (new_pos >= 0 && (size_t)new_pos <= ms->input_size) {
+    if (new_pos >= 0 && (size_t)new_pos <= limit) {
         ms->current_pos = (size_t)new_pos;
         return offset;
     }
@@ -372,7 +406,8 @@ OPJ_OFF_T JPEG2000Compression::memory_skip(OPJ_OFF_T offset, void* user_data) {
 OPJ_BOOL JPEG2000Compression::memory_seek(OPJ_OFF_T offset, void* user_data) {
     MemoryStreamData* ms = (MemoryStreamData*)user_data;
     if (!ms) return OPJ_FALSE;
-    if (offset >= 0 && (size_t)offset <= ms->input_size) {
+    size_t limit = ms->output_buffer ? ms->output_size : ms->input_size;
+    if (offset >= 0 && (size_t)offset <= limit) {
         ms->current_pos = (size_t)offset;
         return OPJ_TRUE;
     }
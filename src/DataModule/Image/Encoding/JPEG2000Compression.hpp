@@ -1,23 +1,42 @@
 #pragma once
 
 #include "CompressionStrategy.hpp"
+#include <atomic>
 #include <openjpeg.h>
 
 /**
  * @brief JPEG2000 compression strategy implementation
+ *
+ * Each thread keeps the OpenJPEG image and output buffer of its last encode
+ * and reuses them for the next frame of the same geometry. The encoder takes
+ * ownership of the component planes, so those are reallocated per frame, and
+ * codecs and streams are single-use in OpenJPEG and are created per frame.
  */
 class JPEG2000Compression : public CompressionStrategy {
 private:
     // OpenJPEG memory stream data structure
     struct MemoryStreamData {
         const uint8_t* input_buffer;
-        uint8_t* output_buffer;
+        std::vector<uint8_t>* output_buffer; // Grows as the encoder writes
         size_t input_size;
         size_t output_size;
         size_t current_pos;
-        size_t max_output_size;
     };
 
+    static std::atomic<int> threadCount;
+
+    // Hands the codec its share of threads
+    static void configureThreads(opj_codec_t* codec);
+
+    // Part of the image to decode, in full resolution pixels
+    struct DecodeArea {
+        int x0, y0, x1, y1;
+    };
+
+    // Decode at up to reduceLevel halvings, optionally only an area, reporting the decoded size if asked
+    std::vector<uint8_t> decode(const std::vector<uint8_t>& compressedData, int reduceLevel,
+                                const DecodeArea* area, int* width, int* height) const;
+
     // OpenJPEG stream functions
     static OPJ_SIZE_T memory_read(void* buffer, OPJ_SIZE_T size, void* user_data);
     static OPJ_SIZE_T memory_write(void* buffer, OPJ_SIZE_T size, void* user_data);
@@ -25,12 +44,32 @@ private:
     static OPJ_BOOL memory_seek(OPJ_OFF_T offset, void* user_data);
 
 public:
+    /**
+     * @brief Threads OpenJPEG may use inside a single frame.
+     *
+     * Frames are already coded concurrently on the shared thread pool, so the
+     * default of 1 avoids oversubscribing the cores. Raise it when only a few
+     * large frames are coded at a time, 0 uses every core. Has no effect if
+     * OpenJPEG was built without thread support.
+     */
+    static void setThreadCount(int threads);
+    static int getThreadCount();
+
     std::vector<uint8_t> compress(const std::vector<uint8_t>& rawData,
                                  int width, int height,
                                  uint8_t channels, uint8_t bitDepth) const override;
     
     std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressedData) const override;
     
+    // Frames are written with up to 6 resolution levels, so at most 5 halvings are available
+    std::vector<uint8_t> decompressReduced(const std::vector<uint8_t>& compressedData,
+                                           int reduceLevel, int& width, int& height) const override;
+    
+    // Only the code-blocks overlapping the region are decoded
+    std::vector<uint8_t> decompressRegion(const std::vector<uint8_t>& compressedData,
+                                          int width, int height, uint8_t channels, uint8_t bitDepth,
+                                          int x, int y, int regionWidth, int regionHeight) const override;
+    
     std::string getCompressionType() const override { return "JPEG2000_LOSSLESS"; }
     
     bool supports(int channels, uint8_t bitDepth) const override {
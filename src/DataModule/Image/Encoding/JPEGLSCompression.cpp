@@ -0,0 +1,46 @@
+#include "JPEGLSCompression.hpp"
+#include <charls/charls.h>
+#include <stdexcept>
+
+std::vector<uint8_t> JPEGLSCompression::compress(const std::vector<uint8_t>& rawData,
+                                                 int width, int height,
+                                                 uint8_t channels, uint8_t bitDepth) const {
+    if (!supports(channels, bitDepth)) {
+        throw std::runtime_error("JPEG-LS does not support " + std::to_string(channels) +
+                                 " channels at " + std::to_string(bitDepth) + " bits");
+    }
+
+    size_t bytesPerSample = bitDepth > 8 ? 2 : 1;
+    size_t expectedSize = static_cast<size_t>(width) * height * channels * bytesPerSample;
+    if (rawData.size() != expectedSize) {
+        throw std::runtime_error("JPEG-LS: Input size mismatch. Expected: " + std::to_string(expectedSize) +
+                                 ", Got: " + std::to_string(rawData.size()));
+    }
+
+    try {
+        charls::jpegls_encoder encoder;
+        encoder.frame_info({ static_cast<uint32_t>(width), static_cast<uint32_t>(height), bitDepth, channels })
+               .interleave_mode(channels == 1 ? charls::interleave_mode::none : charls::interleave_mode::sample);
+
+        std::vector<uint8_t> compressed(encoder.estimated_destination_size());
+        encoder.destination(compressed);
+        compressed.resize(encoder.encode(rawData));
+        return compressed;
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error("JPEG-LS compression failed: " + std::string(e.what()));
+    }
+}
+
+std::vector<uint8_t> JPEGLSCompression::decompress(const std::vector<uint8_t>& compressedData) const {
+    try {
+        charls::jpegls_decoder decoder(compressedData, true);
+
+        std::vector<uint8_t> decompressed(decoder.destination_size());
+        decoder.decode(decompressed);
+        return decompressed;
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error("JPEG-LS decompression failed: " + std::string(e.what()));
+    }
+}
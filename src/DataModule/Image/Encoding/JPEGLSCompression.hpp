@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CompressionStrategy.hpp"
+
+/**
+ * @brief JPEG-LS lossless compression strategy implementation (CharLS)
+ *
+ * JPEG-LS is a DICOM transfer syntax that typically compresses about as well
+ * as lossless JPEG 2000 while encoding and decoding several times faster.
+ * Multi-channel frames are coded sample-interleaved, so the codestream
+ * decodes straight back into the interleaved layout frames are stored in.
+ */
+class JPEGLSCompression : public CompressionStrategy {
+public:
+    std::vector<uint8_t> compress(const std::vector<uint8_t>& rawData,
+                                 int width, int height,
+                                 uint8_t channels, uint8_t bitDepth) const override;
+    
+    std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressedData) const override;
+    
+    std::string getCompressionType() const override { return "JPEGLS_LOSSLESS"; }
+    
+    bool supports(int channels, uint8_t bitDepth) const override {
+        // Sample interleaving needs 3 or 4 components, JPEG-LS stops at 16 bits
+        return (channels == 1 || channels == 3 || channels == 4) &&
+               bitDepth >= 8 && bitDepth <= 16;
+    }
+};
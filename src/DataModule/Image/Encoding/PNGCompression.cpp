@@ -153,13 +153,15 @@ std::vector<uint8_t> PNGCompression::decompress(const std::vector<uint8_t>& comp
                 throw std::runtime_error("Unsupported PNG color type: " + std::to_string(color_type));
         }
         
-        // Create output buffer
-        std::vector<uint8_t> output(width * height * channels);
+        // Create output buffer (account for bit depth, 16-bit samples take two bytes)
+        size_t bytesPerPixel = (bit_depth + 7) / 8;
+        size_t rowStride = static_cast<size_t>(width) * channels * bytesPerPixel;
+        std::vector<uint8_t> output(rowStride * height);
         
         // Read image data row by row
         std::vector<png_bytep> row_pointers(height);
         for (png_uint_32 y = 0; y < height; y++) {
-            row_pointers[y] = &output[y * width * channels];
+            row_pointers[y] = &output[y * rowStride];
         }
         
         png_read_image(png_ptr, row_pointers.data());
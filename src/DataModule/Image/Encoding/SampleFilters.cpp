@@ -0,0 +1,221 @@
+#include "SampleFilters.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+    inline uint16_t load16(const uint8_t* p) {
+        uint16_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline void store16(uint8_t* p, uint16_t value) {
+        memcpy(p, &value, sizeof(value));
+    }
+
+#if defined(__SSE2__)
+    // Inclusive prefix sum over the eight 16-bit lanes
+    inline __m128i prefixSum16(__m128i v) {
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+        return v;
+    }
+
+    // Lane 7 copied into every lane
+    inline __m128i broadcastLast16(__m128i v) {
+        return _mm_shuffle_epi32(_mm_shufflehi_epi16(v, 0xFF), 0xFF);
+    }
+#endif
+}
+
+namespace SampleFilters {
+
+    void shuffle16(const uint8_t* src, uint8_t* dst, size_t samples, bool delta) {
+
+        size_t i = 0;
+        uint16_t prev = 0;
+
+#if defined(__SSE2__)
+        const __m128i lowMask = _mm_set1_epi16(0x00FF);
+        __m128i carry = _mm_setzero_si128(); // previous sample sits in lane 7
+
+        for (; i + 16 <= samples; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16));
+
+            if (delta) {
+                __m128i prevA = _mm_or_si128(_mm_slli_si128(a, 2), _mm_srli_si128(carry, 14));
+                __m128i prevB = _mm_or_si128(_mm_slli_si128(b, 2), _mm_srli_si128(a, 14));
+                carry = b;
+                a = _mm_sub_epi16(a, prevA);
+                b = _mm_sub_epi16(b, prevB);
+            }
+
+            __m128i low = _mm_packus_epi16(_mm_and_si128(a, lowMask), _mm_and_si128(b, lowMask));
+            __m128i high = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + samples + i), high);
+        }
+
+        if (i > 0) {
+            prev = load16(src + 2 * (i - 1));
+        }
+#endif
+
+        for (; i < samples; ++i) {
+            uint16_t value = load16(src + 2 * i);
+            uint16_t coded = delta ? static_cast<uint16_t>(value - prev) : value;
+            prev = value;
+            dst[i] = static_cast<uint8_t>(coded & 0xFF);
+            dst[samples + i] = static_cast<uint8_t>(coded >> 8);
+        }
+    }
+
+    void unshuffle16(const uint8_t* src, uint8_t* dst, size_t samples, bool delta) {
+
+        size_t i = 0;
+        uint16_t prev = 0;
+
+#if defined(__SSE2__)
+        __m128i carry = _mm_setzero_si128(); // running value in every lane
+
+        for (; i + 16 <= samples; i += 16) {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + samples + i));
+            __m128i a = _mm_unpacklo_epi8(low, high);
+            __m128i b = _mm_unpackhi_epi8(low, high);
+
+            if (delta) {
+                a = _mm_add_epi16(prefixSum16(a), carry);
+                carry = broadcastLast16(a);
+                b = _mm_add_epi16(prefixSum16(b), carry);
+                carry = broadcastLast16(b);
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), a);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16), b);
+        }
+
+        if (i > 0) {
+            prev = load16(dst + 2 * (i - 1));
+        }
+#endif
+
+        for (; i < samples; ++i) {
+            uint16_t coded = static_cast<uint16_t>(src[i] | (src[samples + i] << 8));
+            uint16_t value = delta ? static_cast<uint16_t>(prev + coded) : coded;
+            prev = value;
+            store16(dst + 2 * i, value);
+        }
+    }
+
+    void delta8(const uint8_t* src, uint8_t* dst, size_t samples) {
+        if (samples == 0) {
+            return;
+        }
+        // Independent iterations, compilers vectorise this on their own
+        dst[0] = src[0];
+        for (size_t i = 1; i < samples; ++i) {
+            dst[i] = static_cast<uint8_t>(src[i] - src[i - 1]);
+        }
+    }
+
+    void undelta8(const uint8_t* src, uint8_t* dst, size_t samples) {
+        uint8_t prev = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            prev = static_cast<uint8_t>(prev + src[i]);
+            dst[i] = prev;
+        }
+    }
+
+    void widenToInt32(const uint8_t* src, int32_t* dst, size_t count, size_t stride, int bytesPerSample) {
+
+        size_t i = 0;
+
+        if (bytesPerSample == 1) {
+#if defined(__SSE2__)
+            if (stride == 1) {
+                const __m128i zero = _mm_setzero_si128();
+                for (; i + 16 <= count; i += 16) {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                    __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                    __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(high, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(high, zero));
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                dst[i] = src[i * stride];
+            }
+            return;
+        }
+
+#if defined(__SSE2__)
+        if (stride == 1) {
+            const __m128i zero = _mm_setzero_si128();
+            for (; i + 8 <= count; i += 8) {
+                __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(samples, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(samples, zero));
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            dst[i] = load16(src + 2 * i * stride);
+        }
+    }
+
+    void narrowFromInt32(const int32_t* src, uint8_t* dst, size_t count, size_t stride, int bytesPerSample) {
+
+        size_t i = 0;
+
+        if (bytesPerSample == 1) {
+#if defined(__SSE2__)
+            if (stride == 1) {
+                const __m128i lowMask = _mm_set1_epi32(0xFF);
+                for (; i + 16 <= count; i += 16) {
+                    __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), lowMask);
+                    __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), lowMask);
+                    __m128i c = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8)), lowMask);
+                    __m128i d = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)), lowMask);
+                    __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bytes);
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                dst[i * stride] = static_cast<uint8_t>(src[i]);
+            }
+            return;
+        }
+
+#if defined(__SSE2__)
+        if (stride == 1) {
+            // SSE2 only packs with signed saturation, so bias into the int16 range and back
+            const __m128i lowMask = _mm_set1_epi32(0xFFFF);
+            const __m128i bias32 = _mm_set1_epi32(0x8000);
+            const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+            for (; i + 8 <= count; i += 8) {
+                __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), lowMask);
+                __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4)), lowMask);
+                __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_xor_si128(packed, bias16));
+            }
+        }
+#endif
+        for (; i < count; ++i) {
+            store16(dst + 2 * i * stride, static_cast<uint16_t>(src[i]));
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Sample kernels shared by the frame codecs.
+ *
+ * The reversible filters make pixel data easier to entropy code.
+ * Byte-shuffling 16-bit samples groups all low bytes before all high bytes,
+ * so the slowly varying high bytes form long runs. Delta prediction replaces
+ * every sample by its difference to the previous one, modulo the sample
+ * width, which turns smooth gradients into small values. Both are exact,
+ * the inverse functions restore the input bit for bit. The widening and
+ * narrowing kernels convert between interleaved samples and codec planes.
+ *
+ * The kernels use SSE2 on x86-64 for contiguous samples and plain loops
+ * elsewhere. Source and destination must not overlap.
+ */
+namespace SampleFilters {
+
+    /**
+     * @brief Optionally delta-predict, then byte-shuffle 16-bit samples.
+     * @param src samples * 2 bytes of native-endian samples
+     * @param dst samples * 2 bytes, low bytes first, then high bytes
+     */
+    void shuffle16(const uint8_t* src, uint8_t* dst, size_t samples, bool delta);
+
+    // Inverse of shuffle16 with the same delta flag
+    void unshuffle16(const uint8_t* src, uint8_t* dst, size_t samples, bool delta);
+
+    // Delta prediction on 8-bit samples
+    void delta8(const uint8_t* src, uint8_t* dst, size_t samples);
+    void undelta8(const uint8_t* src, uint8_t* dst, size_t samples);
+
+    /**
+     * @brief Widen one channel of interleaved 8 or 16-bit samples to int32.
+     *
+     * Used to fill codec planes, e.g. OpenJPEG components.
+     * @param src First sample of the channel
+     * @param dst count int32 values
+     * @param stride Distance between samples in samples, i.e. the channel count
+     */
+    void widenToInt32(const uint8_t* src, int32_t* dst, size_t count, size_t stride, int bytesPerSample);
+
+    /**
+     * @brief Narrow an int32 plane back into one channel of interleaved samples.
+     *
+     * Values are expected to be in range for the sample width, anything else
+     * is truncated.
+     */
+    void narrowFromInt32(const int32_t* src, uint8_t* dst, size_t count, size_t stride, int bytesPerSample);
+}
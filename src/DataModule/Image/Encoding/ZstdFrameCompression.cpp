@@ -0,0 +1,114 @@
+#include "ZstdFrameCompression.hpp"
+#include "SampleFilters.hpp"
+
+#include <zstd.h>
+
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+using namespace std;
+
+vector<uint8_t> ZstdFrameCompression::compress(const vector<uint8_t>& rawData,
+                                               int width, int height,
+                                               uint8_t channels, uint8_t bitDepth) const {
+
+    if (!supports(channels, bitDepth)) {
+        throw runtime_error("ZSTD frame compression does not support " + to_string(channels) +
+                            " channels at " + to_string(bitDepth) + " bits");
+    }
+
+    uint8_t bytesPerSample = bitDepth / 8;
+    size_t expectedSize = static_cast<size_t>(width) * height * channels * bytesPerSample;
+    if (rawData.size() != expectedSize) {
+        throw runtime_error("Frame size " + to_string(rawData.size()) + " does not match " +
+                            to_string(width) + "x" + to_string(height) + "x" + to_string(channels) +
+                            " at " + to_string(bitDepth) + " bits");
+    }
+
+    // Interleaved channels are not neighbours, predicting across them only adds noise
+    bool delta = deltaPrediction && channels == 1;
+    size_t samples = rawData.size() / bytesPerSample;
+
+    uint8_t filters = 0;
+    vector<uint8_t> filtered(rawData.size());
+    if (bytesPerSample == 2) {
+        filters |= FILTER_SHUFFLE;
+        SampleFilters::shuffle16(rawData.data(), filtered.data(), samples, delta);
+    }
+    else if (delta) {
+        SampleFilters::delta8(rawData.data(), filtered.data(), samples);
+    }
+    else {
+        filtered = rawData;
+    }
+    if (delta) {
+        filters |= FILTER_DELTA;
+    }
+
+    vector<uint8_t> result(HEADER_SIZE + ZstdCompressor::compressBound(filtered.size()));
+    uint64_t rawSize = rawData.size();
+    result[0] = FORMAT_VERSION;
+    result[1] = filters;
+    result[2] = bytesPerSample;
+    result[3] = 0;
+    memcpy(result.data() + 4, &rawSize, sizeof(rawSize));
+
+    size_t written = ZstdCompressor::compressInto(as_bytes(span(filtered)),
+                                                  as_writable_bytes(span(result).subspan(HEADER_SIZE)),
+                                                  settings);
+    result.resize(HEADER_SIZE + written);
+    return result;
+}
+
+vector<uint8_t> ZstdFrameCompression::decompress(const vector<uint8_t>& compressedData) const {
+
+    if (compressedData.size() < HEADER_SIZE) {
+        throw runtime_error("ZSTD frame data too small");
+    }
+    if (compressedData[0] != FORMAT_VERSION) {
+        throw runtime_error("Unsupported ZSTD frame version " + to_string(compressedData[0]));
+    }
+
+    uint8_t filters = compressedData[1];
+    uint8_t bytesPerSample = compressedData[2];
+    uint64_t rawSize;
+    memcpy(&rawSize, compressedData.data() + 4, sizeof(rawSize));
+
+    if ((bytesPerSample != 1 && bytesPerSample != 2) || rawSize % bytesPerSample != 0 ||
+        ((filters & FILTER_SHUFFLE) && bytesPerSample != 2)) {
+        throw runtime_error("Corrupt ZSTD frame header");
+    }
+
+    // The raw size comes from the file, so check it against the size the ZSTD
+    // frame declares, and against the most its blocks can expand to (at least
+    // 4 bytes per block of up to 128 KiB), before allocating for it
+    auto payload = span(compressedData).subspan(HEADER_SIZE);
+    unsigned long long contentSize = ZSTD_getFrameContentSize(payload.data(), payload.size());
+    uint64_t expansionLimit = (payload.size() / 4 + 1) * uint64_t(ZSTD_BLOCKSIZE_MAX);
+    if (contentSize != rawSize || rawSize > expansionLimit) {
+        throw runtime_error("Corrupt ZSTD frame header");
+    }
+
+    vector<uint8_t> filtered(rawSize);
+    size_t decoded = ZstdCompressor::decompressInto(as_bytes(payload), as_writable_bytes(span(filtered)));
+    if (decoded != rawSize) {
+        throw runtime_error("ZSTD frame decoded to " + to_string(decoded) +
+                            " bytes, expected " + to_string(rawSize));
+    }
+
+    bool delta = (filters & FILTER_DELTA) != 0;
+    size_t samples = rawSize / bytesPerSample;
+
+    if (filters & FILTER_SHUFFLE) {
+        vector<uint8_t> result(rawSize);
+        SampleFilters::unshuffle16(filtered.data(), result.data(), samples, delta);
+        return result;
+    }
+    if (delta) {
+        vector<uint8_t> result(rawSize);
+        SampleFilters::undelta8(filtered.data(), result.data(), samples);
+        return result;
+    }
+    return filtered;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CompressionStrategy.hpp"
+#include "Utility/Compression/ZstdCompressor.hpp"
+
+/**
+ * @brief Lossless ZSTD frame codec with byte-shuffle and delta preconditioning
+ *
+ * Much faster than JPEG 2000 in both directions, decoding runs close to memory
+ * bandwidth, at the cost of a somewhat larger file. 16-bit samples are
+ * byte-shuffled before compression, single-channel images are additionally
+ * delta-predicted along the rows when enabled.
+ *
+ * Every frame starts with a small header recording the filters and the raw
+ * size, so decompress() needs no image parameters:
+ *   u8 version, u8 filter flags, u8 bytes per sample, u8 reserved, u64 raw size
+ */
+class ZstdFrameCompression : public CompressionStrategy {
+public:
+    // Frames are decoded far more often than written, low levels decode just as fast
+    static constexpr int DEFAULT_LEVEL = 3;
+
+    explicit ZstdFrameCompression(ZstdSettings settings = ZstdSettings{ .level = DEFAULT_LEVEL },
+                                  bool deltaPrediction = true)
+        : settings(settings), deltaPrediction(deltaPrediction) {}
+
+    std::vector<uint8_t> compress(const std::vector<uint8_t>& rawData,
+                                 int width, int height,
+                                 uint8_t channels, uint8_t bitDepth) const override;
+
+    std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressedData) const override;
+
+    std::string getCompressionType() const override { return "ZSTD"; }
+
+    bool supports(int channels, uint8_t bitDepth) const override {
+        return channels >= 1 && channels <= 4 && (bitDepth == 8 || bitDepth == 16);
+    }
+
+    const ZstdSettings& getSettings() const { return settings; }
+    bool usesDeltaPrediction() const { return deltaPrediction; }
+
+private:
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint8_t FILTER_SHUFFLE = 0x01;
+    static constexpr uint8_t FILTER_DELTA = 0x02;
+    static constexpr size_t HEADER_SIZE = 12;
+
+    ZstdSettings settings;
+    bool deltaPrediction;
+};
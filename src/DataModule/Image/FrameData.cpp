@@ -6,6 +6,9 @@ FrameData::FrameData(const std::string& schemaPath, DataHeader& dataheader) : Da
     EncryptionData encryptionData = header->getEncryptionData();    
     encryptionData.encryptionType = EncryptionType::NONE;
     header->setEncryptionData(encryptionData);
+
+    // Pixel encoding is owned by the parent image, the frame payload itself is stored as-is
+    header->setDataCompression(CompressionType::RAW);
     
     initialise();
 }
@@ -13,11 +16,12 @@ FrameData::FrameData(const std::string& schemaPath, DataHeader& dataheader) : Da
 
 void FrameData::writeData(std::ostream& out) const {
     // Write pixelData to stream
-    if (!pixelData.empty()) {
-        out.write(reinterpret_cast<const char*>(pixelData.data()), pixelData.size());
+    std::span<const std::byte> pixels = getPixelView();
+    if (!pixels.empty()) {
+        out.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
     }
 
-    header->setDataSize(pixelData.size());
+    header->setDataSize(pixels.size());
 
 }
 
@@ -26,19 +30,39 @@ void FrameData::readData(std::istream& in) {
     size_t size = header->getDataSize();
     pixelData.resize(size);
     in.read(reinterpret_cast<char*>(pixelData.data()), size);
+    mappedPixels = {};
     // Note: needsDecompression flag will be set by ImageData based on encoding
 }
 
+void FrameData::readData(std::span<const std::byte> bytes) {
+    // Borrow the stored bytes rather than copying them
+    pixelData.clear();
+    mappedPixels = bytes.first(header->getDataSize());
+}
+
+std::span<const std::byte> FrameData::getPixelView() const {
+    if (pixelData.empty()) {
+        return mappedPixels;
+    }
+    return std::as_bytes(std::span(pixelData));
+}
+
 void FrameData::addData(
     const std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>>& data) {
 
     if (std::holds_alternative<std::vector<uint8_t>>(data)) {
         pixelData = std::get<std::vector<uint8_t>>(data);
+        mappedPixels = {};
     }
 }
 
 // Override the virtual method for frame-specific data
 std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>> 
 FrameData::getModuleSpecificData() const {
+    if (pixelData.empty() && !mappedPixels.empty()) {
+        // The only copy of a mapped frame is the one handed to the caller
+        const auto* begin = reinterpret_cast<const uint8_t*>(mappedPixels.data());
+        return std::vector<uint8_t>(begin, begin + mappedPixels.size());
+    }
     return pixelData; // Return the pixel data as std::vector<uint8_t>
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <memory>
 #include <ostream>
 #include <istream>
+#include <span>
+#include <cstddef>
 
 class FrameData : public DataModule {
     friend class ImageData; // Allow ImageData to access protected members
@@ -17,6 +19,10 @@ public:
     mutable std::vector<uint8_t> pixelData; // Allow modification in const methods
     mutable bool needsDecompression = false; // Track if data needs decompression
 
+    // When read from a memory mapping the stored bytes are kept as a view and
+    // pixelData stays empty until a copy is actually required
+    std::span<const std::byte> mappedPixels;
+
     explicit FrameData(const std::string& schemaPath, DataHeader& dataheader);
 
     
@@ -26,6 +32,10 @@ public:
         const std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>>&) override;
     virtual void writeData(std::ostream& out) const override;
     virtual void readData(std::istream& in) override;
+    virtual void readData(std::span<const std::byte> bytes) override;
+
+    // Stored pixel bytes, either owned or borrowed from the mapping
+    std::span<const std::byte> getPixelView() const;
     
     // Override the virtual method for frame-specific data
     std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>> 
@@ -8,11 +8,14 @@
 #include "../../Xref/xref.hpp"
 #include "../ModuleData.hpp"
 #include "../../Utility/Encryption/encryptionManager.hpp"
+#include "../../Utility/threadPool.hpp"
 
 #include "string"
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <spanstream>
+#include <cstring>
 #include <algorithm>
 #include <iomanip>
 #include <filesystem> // Required for filesystem::exists
@@ -21,6 +24,7 @@ using namespace std;
 
 ImageData::ImageData(const string& schemaPath, DataHeader& dataheader) : DataModule(schemaPath, dataheader) {
     header->setDataCompression(CompressionType::RAW);
+    header->setHasFrameIndex(true);
     // Initialize the image encoder
     encoder = std::make_unique<ImageEncoder>();
     initialise();
@@ -28,10 +32,22 @@ ImageData::ImageData(const string& schemaPath, DataHeader& dataheader) : DataMod
 
 ImageData::ImageData(
     const string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, EncryptionData encryptionData) 
-    : DataModule(schemaPath, schemaJson, uuid, ModuleType::Image, encryptionData) {
+    : ImageData(schemaPath, make_shared<const CompiledSchema>(schemaJson), uuid, encryptionData) {}
+
+ImageData::ImageData(
+    const string& schemaPath, shared_ptr<const CompiledSchema> schema, UUID uuid, EncryptionData encryptionData) 
+    : DataModule(schemaPath, std::move(schema), uuid, ModuleType::Image, encryptionData) {
 
     // Initialize encoding to RAW by default (always safe for medical data)
     header->setDataCompression(CompressionType::RAW);
+    header->setDataZstd(getDefaultDataZstd());
+    header->setHasFrameIndex(true);
+
+    // Seal frames one by one so encrypted images keep random frame access
+    if (encryptionData.encryptionType != EncryptionType::NONE) {
+        encryptionData.framesSealed = true;
+        header->setEncryptionData(encryptionData);
+    }
     
     // Initialize the image encoder
     encoder = std::make_unique<ImageEncoder>();
@@ -92,50 +108,7 @@ void ImageData::addData(
     auto compressionStart = std::chrono::high_resolution_clock::now();
 
     for (size_t i = 0; i < data.size(); ++i) {
-        const auto& frame = data[i];
-        auto frameModule = std::make_unique<FrameData>(frameSchemaPath, *header);
-
-        // Extract frame-specific data (assuming it's binary pixel data)
-        if (!std::holds_alternative<std::vector<uint8_t>>(frame.data)) {
-            throw std::runtime_error("Frame " + std::to_string(i) + " data is not binary pixel data");
-        }
-        
-        const auto& pixelData = std::get<std::vector<uint8_t>>(frame.data);
-
-        // Calculate expected size for this frame (2D slice)
-        // Each frame is a 2D slice, so we only use the first 2 dimensions
-        size_t bytesPerPixel = (bitDepth + 7) / 8; // Round up for non-byte-aligned bit depths
-        size_t expectedSize = dimensions[0] * dimensions[1] * channels * bytesPerPixel;
-
-        if (pixelData.size() != expectedSize) {
-            throw std::runtime_error("Frame " + std::to_string(i) + 
-                " pixel data size mismatch. Expected: " + std::to_string(expectedSize) + 
-                ", Got: " + std::to_string(pixelData.size()) + 
-                " (dimensions: " + std::to_string(dimensions[0]) + "x" + std::to_string(dimensions[1]) + 
-                ", channels: " + std::to_string(channels) + ", bitDepth: " + std::to_string(bitDepth) + ")");
-        }
-
-        // Validate bit depth is reasonable
-        if (bitDepth < 1 || bitDepth > 64) {
-            throw std::runtime_error("Frame " + std::to_string(i) + " invalid bit depth: " + std::to_string(bitDepth));
-        }
-
-        // Validate channel count is reasonable
-        if (channels < 1 || channels > 16) {
-            throw std::runtime_error("Frame " + std::to_string(i) + " invalid channel count: " + std::to_string(channels));
-        }
-
-        // Set the frame metadata
-        frameModule->addMetaData(frame.metadata);
-
-        // Set the pixel data
-        frameModule->addData(frame.data);
-        
-        // Set decompression flag based on current encoding
-        frameModule->needsDecompression = (header->getDataCompression() != CompressionType::RAW);
-        
-        // Add to frames collection
-        frames.push_back(std::move(frameModule));
+        frames.push_back(makeFrame(data[i], i));
     }
 
     // Post-processing validation: ensure frame consistency
@@ -155,11 +128,56 @@ void ImageData::addData(
     auto compressionDuration = std::chrono::duration_cast<std::chrono::microseconds>(compressionEnd - compressionStart);
     
     std::cout << "Total compression time for " << data.size() << " frames (" 
-              << (header->getDataCompression() == CompressionType::JPEG2000_LOSSLESS ? "JPEG2000" : 
-                  header->getDataCompression() == CompressionType::PNG ? "PNG" : "RAW") << "): " 
+              << compressionToString(header->getDataCompression()) << "): " 
               << compressionDuration.count() << " microseconds" << std::endl;
 }
 
+std::unique_ptr<FrameData> ImageData::makeFrame(const ModuleData& frame, size_t i) const {
+
+    auto frameModule = std::make_unique<FrameData>(frameSchemaPath, *header);
+
+    // Extract frame-specific data (assuming it's binary pixel data)
+    if (!std::holds_alternative<std::vector<uint8_t>>(frame.data)) {
+        throw std::runtime_error("Frame " + std::to_string(i) + " data is not binary pixel data");
+    }
+    
+    const auto& pixelData = std::get<std::vector<uint8_t>>(frame.data);
+
+    // Calculate expected size for this frame (2D slice)
+    // Each frame is a 2D slice, so we only use the first 2 dimensions
+    size_t bytesPerPixel = (bitDepth + 7) / 8; // Round up for non-byte-aligned bit depths
+    size_t expectedSize = dimensions[0] * dimensions[1] * channels * bytesPerPixel;
+
+    if (pixelData.size() != expectedSize) {
+        throw std::runtime_error("Frame " + std::to_string(i) + 
+            " pixel data size mismatch. Expected: " + std::to_string(expectedSize) + 
+            ", Got: " + std::to_string(pixelData.size()) + 
+            " (dimensions: " + std::to_string(dimensions[0]) + "x" + std::to_string(dimensions[1]) + 
+            ", channels: " + std::to_string(channels) + ", bitDepth: " + std::to_string(bitDepth) + ")");
+    }
+
+    // Validate bit depth is reasonable
+    if (bitDepth < 1 || bitDepth > 64) {
+        throw std::runtime_error("Frame " + std::to_string(i) + " invalid bit depth: " + std::to_string(bitDepth));
+    }
+
+    // Validate channel count is reasonable
+    if (channels < 1 || channels > 16) {
+        throw std::runtime_error("Frame " + std::to_string(i) + " invalid channel count: " + std::to_string(channels));
+    }
+
+    // Set the frame metadata
+    frameModule->addMetaData(frame.metadata);
+
+    // Set the pixel data
+    frameModule->addData(frame.data);
+    
+    // Set decompression flag based on current encoding
+    frameModule->needsDecompression = (header->getDataCompression() != CompressionType::RAW);
+
+    return frameModule;
+}
+
 void ImageData::addMetaData(const nlohmann::json& data) {
     
     if (data.is_array()) {
@@ -315,56 +333,35 @@ std::vector<std::string> ImageData::getNonZeroDimensionNames() const {
 
 FieldMap buildFieldMap(
     const std::vector<uint8_t>& rowBuffer,
-    const std::vector<std::unique_ptr<DataField>>& fields
+    const RowBinding& layout
 ) {
     FieldMap map;
-    
-    // Build flattened field list including nested fields (same logic as readTableRows)
-    std::vector<std::pair<std::string, DataField*>> flattenedFields;
-    
-    for (const auto& field : fields) {
-        if (auto* objectField = dynamic_cast<ObjectField*>(field.get())) {
-            // Add nested fields with dot notation
-            const auto& nestedFields = objectField->getNestedFields();
-            for (const auto& nestedField : nestedFields) {
-                std::string fieldPath = field->getName() + "." + nestedField->getName();
-                flattenedFields.push_back({fieldPath, nestedField.get()});
-            }
-        } else {
-            // Regular field
-            flattenedFields.push_back({field->getName(), field.get()});
-        }
-    }
-    
-    size_t numFlattenedFields = flattenedFields.size();
-    size_t bitmapSize = (numFlattenedFields + 7) / 8;
+
+    const CompiledRowLayout& rowLayout = *layout.layout;
+    const auto& slots = rowLayout.getSlots();
+    size_t bitmapSize = rowLayout.getBitmapSize();
     
     if (rowBuffer.size() < bitmapSize) {
         throw std::runtime_error("Row buffer too small to contain bitmap");
     }
     
     const uint8_t* bitmap = rowBuffer.data();
+    bool full = rowLayout.isFull(bitmap);
     size_t offset = bitmapSize;
     
-    for (size_t i = 0; i < numFlattenedFields; ++i) {
-        bool present = bitmap[i / 8] & (1 << (i % 8));
-        
-        const auto& [fieldPath, fieldPtr] = flattenedFields[i];
+    map.reserve(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        bool present = full || rowLayout.isPresent(bitmap, i);
         
         FieldInfo info;
         info.present = present;
-        info.offset = offset;
-        info.field = fieldPtr;
-        info.length = present ? fieldPtr->getLength() : 0;
+        info.offset = full ? slots[i].fixedOffset : offset;
+        info.field = layout.fields[i];
+        info.length = present ? slots[i].length : 0;
         
-        if (present) {
-            // Add flattened field to map
-            map[fieldPath] = info;
-            offset += info.length;
-        } else {
-            // Field not present, but still add to map for consistency
-            map[fieldPath] = info;
-        }
+        // Absent fields are still added to the map for consistency
+        map[slots[i].path] = info;
+        offset += info.length;
     }
     
     return map;
@@ -378,7 +375,7 @@ void ImageData::readMetadataRows(std::istream& in) {
     dimensions.clear();
     dimensionNames.clear();
 
-    auto fieldMap = buildFieldMap(metaDataRows[0], metaDataFields);     
+    auto fieldMap = buildFieldMap(metaDataRows[0], metaDataLayout);     
     // Get dimensions
     if (fieldMap["image_structure.dimensions"].present) {
         auto& f = fieldMap["image_structure.dimensions"];
@@ -507,26 +504,161 @@ void ImageData::readMetadataRows(std::istream& in) {
     }
 }
 
+ZstdSettings ImageData::getDefaultDataZstd() const {
+    return ZstdSettings{ .level = ZstdFrameCompression::DEFAULT_LEVEL };
+}
+
+std::vector<uint8_t> ImageData::encodeFrame(const std::vector<uint8_t>& pixels, int width, int height) const {
+    if (header->getDataCompression() == CompressionType::ZSTD) {
+        // Unlike the image codecs ZSTD is tuned by the module's compression policy
+        ZstdFrameCompression codec(header->getDataZstd());
+        return codec.compress(pixels, width, height, channels, bitDepth);
+    }
+    if (header->getDataCompression() != CompressionType::RAW) {
+        return encoder->compress(pixels, header->getDataCompression(), width, height, channels, bitDepth);
+    }
+    return pixels;
+}
+
+void ImageData::writeFrameIndex(std::ostream& out, const std::vector<FrameIndexEntry>& index) const {
+    vector<uint8_t> indexBytes(index.size() * 2 * sizeof(uint64_t));
+    for (size_t i = 0; i < index.size(); ++i) {
+        std::memcpy(indexBytes.data() + i * 16, &index[i].offset, sizeof(uint64_t));
+        std::memcpy(indexBytes.data() + i * 16 + 8, &index[i].size, sizeof(uint64_t));
+    }
+    if (hasSealedFrames()) {
+        EncryptionData encryptionData = header->getEncryptionData();
+        indexBytes = EncryptionManager::sealSegment(encryptionData.encryptionType, indexBytes,
+            EncryptionManager::deriveModuleKey(encryptionData), encryptionData.iv, 0, true, SegmentDomain::FrameIndex);
+    }
+    out.write(reinterpret_cast<const char*>(indexBytes.data()), indexBytes.size());
+}
+
+void ImageData::beginFrameStream(std::streampos absoluteModuleStart, std::ostream& out,
+                                 const XRefTable& xref, const std::string& author) {
+
+    // Sealed metadata carries the data section size, which is not known until the end
+    if (header->getEncryptionData().encryptionType != EncryptionType::NONE) {
+        throw runtime_error("Frames of encrypted image modules cannot be streamed");
+    }
+    if (!frames.empty()) {
+        throw runtime_error("Image module already holds frames");
+    }
+
+    streamModuleStart = beginBinary(absoluteModuleStart, out, xref, author);
+    writeMetadataSection(out);
+    streamDataStart = out.tellp();
+    streamIndex.clear();
+}
+
+void ImageData::appendStreamFrame(std::ostream& out, const ModuleData& frame) {
+
+    if (streamIndex.size() >= static_cast<size_t>(getFrameCount())) {
+        throw runtime_error("Image module already has all " + to_string(getFrameCount()) + " frames");
+    }
+
+    int frameWidth = dimensions.size() > 0 ? dimensions[0] : 16;
+    int frameHeight = dimensions.size() > 1 ? dimensions[1] : 16;
+
+    unique_ptr<FrameData> frameModule = makeFrame(frame, streamIndex.size());
+    frameModule->pixelData = encodeFrame(frameModule->pixelData, frameWidth, frameHeight);
+    frameModule->header->setDataSize(frameModule->pixelData.size());
+
+    // Serialise in memory first, so a rejected frame leaves nothing behind
+    std::stringstream frameBuffer;
+    XRefTable tempXref;
+    frameModule->writeBinary(absoluteModuleStart, frameBuffer, tempXref, header->getModifiedBy());
+
+    string_view frameBytes = frameBuffer.view();
+    streampos frameStart = out.tellp();
+    out.write(frameBytes.data(), frameBytes.size());
+    if (!out) {
+        throw runtime_error("Failed to write frame " + to_string(streamIndex.size()));
+    }
+
+    streamIndex.push_back({ static_cast<uint64_t>(frameStart - streamDataStart), frameBytes.size() });
+}
+
+void ImageData::finishFrameStream(std::ostream& out, XRefTable& xref) {
+
+    if (streamIndex.size() != static_cast<size_t>(getFrameCount())) {
+        throw runtime_error("Image module expects " + to_string(getFrameCount()) + " frames, " +
+                            to_string(streamIndex.size()) + " were appended");
+    }
+
+    header->setFrameIndexOffset(static_cast<uint64_t>(out.tellp() - streamDataStart));
+    writeFrameIndex(out, streamIndex);
+    header->setDataSize(static_cast<uint64_t>(out.tellp() - streamDataStart));
+
+    finishBinary(streamModuleStart, out, xref);
+    streamIndex.clear();
+}
+
 void ImageData::writeData(std::ostream& out) const {
     streampos startPos = out.tellp();
+
+    std::vector<FrameIndexEntry> index;
+    index.reserve(frames.size());
     
-    // Write each frame as embedded data (not as separate modules)
-    for (size_t i = 0; i < frames.size(); i++) {
-        // Always use the encoder to handle compression (including RAW)
-        // Get width and height from dimensions array
-        int frameWidth = dimensions.size() > 0 ? dimensions[0] : 16;
-        int frameHeight = dimensions.size() > 1 ? dimensions[1] : 16;
-        
-        // Use the encoder to compress the frame (RAW will just return data unchanged)
-        frames[i]->pixelData = encoder->compress(frames[i]->pixelData, header->getDataCompression(), 
-                                               frameWidth, frameHeight, channels, bitDepth);
-        
-        // Update the frame's data size after compression
-        frames[i]->header->setDataSize(frames[i]->pixelData.size());
-        
-        XRefTable tempXref;
-        frames[i]->writeBinary(absoluteModuleStart, out, tempXref, header->getModifiedBy());
+    // Always use the encoder to handle compression (including RAW)
+    // Get width and height from dimensions array
+    int frameWidth = dimensions.size() > 0 ? dimensions[0] : 16;
+    int frameHeight = dimensions.size() > 1 ? dimensions[1] : 16;
+
+    // Compress every frame concurrently (RAW will just return data unchanged).
+    // The codecs are deterministic, so the output matches a serial run.
+    if (header->getDataCompression() != CompressionType::RAW) {
+        ThreadPool::shared().parallelFor(frames.size(), [&](size_t i) {
+            frames[i]->pixelData = encodeFrame(frames[i]->pixelData, frameWidth, frameHeight);
+        });
+    }
+
+    if (hasSealedFrames()) {
+        EncryptionData encryptionData = header->getEncryptionData();
+        vector<uint8_t> key = EncryptionManager::deriveModuleKey(encryptionData);
+
+        // Serialise and seal every frame on its own, concurrently
+        vector<vector<uint8_t>> sealedFrames(frames.size());
+        ThreadPool::shared().parallelFor(frames.size(), [&](size_t i) {
+            frames[i]->header->setDataSize(frames[i]->pixelData.size());
+
+            std::stringstream frameBuffer;
+            XRefTable tempXref;
+            frames[i]->writeBinary(absoluteModuleStart, frameBuffer, tempXref, header->getModifiedBy());
+
+            string_view frameBytes = frameBuffer.view();
+            sealedFrames[i] = EncryptionManager::sealSegment(encryptionData.encryptionType,
+                span(reinterpret_cast<const uint8_t*>(frameBytes.data()), frameBytes.size()),
+                key, encryptionData.iv, i, true, SegmentDomain::Frame);
+        });
+
+        for (const auto& sealed : sealedFrames) {
+            index.push_back({ static_cast<uint64_t>(out.tellp() - startPos), sealed.size() });
+            out.write(reinterpret_cast<const char*>(sealed.data()), sealed.size());
+        }
     }
+    else {
+        // Write each frame as embedded data (not as separate modules), in order
+        for (size_t i = 0; i < frames.size(); i++) {
+            // Update the frame's data size after compression
+            frames[i]->header->setDataSize(frames[i]->pixelData.size());
+            
+            streampos frameStart = out.tellp();
+
+            XRefTable tempXref;
+            frames[i]->writeBinary(absoluteModuleStart, out, tempXref, header->getModifiedBy());
+
+            index.push_back({
+                static_cast<uint64_t>(frameStart - startPos),
+                static_cast<uint64_t>(out.tellp() - frameStart)
+            });
+        }
+    }
+
+    // Frame index after the last frame, so single frames can be found without
+    // walking every frame header before them
+    header->setFrameIndexOffset(static_cast<uint64_t>(out.tellp() - startPos));
+    writeFrameIndex(out, index);
     
     streampos endPos = out.tellp();
 
@@ -569,6 +701,11 @@ void ImageData::readData(std::istream& in) {
 
     // Clear any existing frames
     frames.clear();
+
+    if (hasSealedFrames()) {
+        readSealedFrames(in);
+        return;
+    }
     
     // Get frame count from C++ dimensions array
     int frameCount = getFrameCount();
@@ -599,7 +736,7 @@ void ImageData::readData(std::istream& in) {
         
         // Use DataModule::fromStream to read the frame
         auto frame = std::unique_ptr<FrameData>(static_cast<FrameData*>(
-            DataModule::fromStream(frameStream, 0, ModuleType::Frame, header->getEncryptionData()).release()
+            DataModule::fromStream(frameStream, 0, ModuleType::Frame, header->getEncryptionData(), dictionaries).release()
         ));
 
         frame->needsDecompression = needsDecompression;
@@ -609,6 +746,80 @@ void ImageData::readData(std::istream& in) {
     }
 }
 
+void ImageData::readSealedFrames(std::istream& in) {
+
+    readFrameIndex(in);
+
+    // Frames open independently, so decrypt and parse them across the pool.
+    // Sealed frames are read a window at a time, enough to keep every thread busy.
+    EncryptionData encryptionData = header->getEncryptionData();
+    vector<uint8_t> key = EncryptionManager::deriveModuleKey(encryptionData);
+
+    ThreadPool& pool = ThreadPool::shared();
+    size_t window = std::max<size_t>(pool.getThreadCount() * 2, 1);
+    vector<vector<uint8_t>> sealedFrames(std::min(window, frameIndex.size()));
+
+    frames.resize(frameIndex.size());
+    for (size_t first = 0; first < frameIndex.size(); first += window) {
+        size_t count = std::min(window, frameIndex.size() - first);
+
+        for (size_t i = 0; i < count; ++i) {
+            const FrameIndexEntry& entry = frameIndex[first + i];
+            sealedFrames[i].resize(entry.size);
+            in.seekg(frameDataStart + entry.offset);
+            in.read(reinterpret_cast<char*>(sealedFrames[i].data()), sealedFrames[i].size());
+            if (in.gcount() != static_cast<std::streamsize>(sealedFrames[i].size())) {
+                throw runtime_error("Failed to read frame " + to_string(first + i));
+            }
+        }
+
+        pool.parallelFor(count, [&](size_t i) {
+            size_t frame = first + i;
+            vector<uint8_t> plaintext = EncryptionManager::openSegment(encryptionData.encryptionType,
+                sealedFrames[i], key, encryptionData.iv, frame, true, SegmentDomain::Frame);
+
+            ispanstream frameStream(span<const char>(reinterpret_cast<const char*>(plaintext.data()), plaintext.size()));
+            frames[frame].reset(static_cast<FrameData*>(
+                DataModule::fromStream(frameStream, 0, ModuleType::Frame, encryptionData, dictionaries).release()));
+            if (!frames[frame]) {
+                throw runtime_error("Failed to read frame " + to_string(frame));
+            }
+            frames[frame]->needsDecompression = needsDecompression;
+        });
+    }
+
+    in.seekg(frameDataStart + header->getDataSize());
+}
+
+void ImageData::readData(std::span<const std::byte> bytes) {
+
+    frames.clear();
+
+    int frameCount = getFrameCount();
+
+    // Frames are parsed in place, so RAW pixel data stays a view into bytes
+    size_t frameStart = 0;
+    for (int i = 0; i < frameCount; i++) {
+
+        DataHeader frameHeader;
+        frameHeader.readDataHeader(bytes.subspan(frameStart));
+
+        uint64_t frameSize = frameHeader.getModuleSize();
+        if (frameSize > bytes.size() - frameStart) {
+            throw runtime_error("Frame " + to_string(i) + " extends past the end of the image data");
+        }
+
+        auto frame = std::unique_ptr<FrameData>(static_cast<FrameData*>(
+            DataModule::fromStream(bytes.subspan(frameStart, frameSize), 0, ModuleType::Frame, header->getEncryptionData(), dictionaries).release()
+        ));
+
+        frame->needsDecompression = needsDecompression;
+        frames.push_back(std::move(frame));
+
+        frameStart += frameSize;
+    }
+}
+
 // Override the virtual method for image-specific data
 std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>> 
 ImageData::getModuleSpecificData() const {
@@ -619,21 +830,24 @@ ImageData::getModuleSpecificData() const {
     // Start timing for total decompression
     auto decompressionStart = std::chrono::high_resolution_clock::now();
     
+    // Frames are independent codestreams, decode them across the shared pool.
+    // Each call only touches its own frame, so results stay in frame order.
+    if (needsDecompression) {
+        ThreadPool::shared().parallelFor(frames.size(), [this](size_t i) {
+            decodeFrame(*frames[i]);
+        });
+    }
+
     // Process all frames
+    frameDataArray.reserve(frames.size());
     for (size_t i = 0; i < frames.size(); i++) {
         const auto& frame = frames[i];
         
         // Check if frame needs decompression and hasn't been decompressed yet
-        if (frame->needsDecompression) {
-            // Decompress the frame's pixel data in-place
-            std::vector<uint8_t> decompressedData = decompressFrameData(frame->pixelData);
-            frame->pixelData = decompressedData; // Overwrite with decompressed data
-            frame->needsDecompression = false; // Mark as decompressed
-        }
+        decodeFrame(*frame);
         
         // Get the frame's data with schema (now decompressed)
-        ModuleData frameData = frame->getModuleData();
-        frameDataArray.push_back(frameData);
+        frameDataArray.push_back(frame->getModuleData());
     }
     
     // End timing and output total decompression time
@@ -661,6 +875,7 @@ CompressionType ImageData::getEncoding() const {
 
 bool ImageData::validateEncodingInSchema() const {
     // Check if the schema defines an encoding field with valid enum values
+    const nlohmann::json& schemaJson = getSchema();
     if (schemaJson.contains("properties") && 
         schemaJson["properties"].contains("metadata") &&
         schemaJson["properties"]["metadata"].contains("properties") &&
@@ -694,4 +909,358 @@ std::vector<uint8_t> ImageData::decompressFrameData(const std::vector<uint8_t>&
 
 
 
-        
\ No newline at end of file
+        
+
+std::span<const std::byte> ImageData::getFramePixelView(size_t frameIndex) const {
+    if (frameIndex >= frames.size()) {
+        throw std::out_of_range("Frame index " + std::to_string(frameIndex) + " out of range");
+    }
+
+    decodeFrame(*frames[frameIndex]);
+    return frames[frameIndex]->getPixelView();
+}
+
+std::unique_ptr<FrameData> ImageData::readEncodedFrame(std::istream& in) const {
+
+    auto frame = std::unique_ptr<FrameData>(static_cast<FrameData*>(
+        DataModule::fromStream(in, 0, ModuleType::Frame, header->getEncryptionData(), dictionaries).release()
+    ));
+    if (!frame) {
+        throw std::runtime_error("Failed to read frame");
+    }
+
+    frame->needsDecompression = needsDecompression;
+    return frame;
+}
+
+ModuleData ImageData::readFrame(std::istream& in) const {
+
+    auto frame = readEncodedFrame(in);
+    decodeFrame(*frame);
+
+    return { frame->getMetadataAsJson(), std::move(frame->pixelData) };
+}
+
+void ImageData::readFrameIndex(std::istream& in) {
+
+    int frameCount = getFrameCount();
+    frameDataStart = static_cast<uint64_t>(in.tellg());
+    frameIndex.clear();
+    frameIndex.reserve(frameCount);
+
+    if (header->getHasFrameIndex()) {
+        uint64_t indexOffset = header->getFrameIndexOffset();
+        uint64_t indexSize = static_cast<uint64_t>(frameCount) * 2 * sizeof(uint64_t);
+        if (hasSealedFrames()) {
+            indexSize += EncryptionManager::tagSize(header->getEncryptionData().encryptionType);
+        }
+        if (indexOffset > header->getDataSize() || indexSize > header->getDataSize() - indexOffset) {
+            throw runtime_error("Frame index extends past the end of the image data");
+        }
+
+        vector<uint8_t> indexBytes(indexSize);
+        in.seekg(frameDataStart + indexOffset);
+        in.read(reinterpret_cast<char*>(indexBytes.data()), indexBytes.size());
+        if (in.gcount() != static_cast<std::streamsize>(indexBytes.size())) {
+            throw runtime_error("Failed to read frame index");
+        }
+        if (hasSealedFrames()) {
+            EncryptionData encryptionData = header->getEncryptionData();
+            indexBytes = EncryptionManager::openSegment(encryptionData.encryptionType, indexBytes,
+                EncryptionManager::deriveModuleKey(encryptionData), encryptionData.iv, 0, true, SegmentDomain::FrameIndex);
+        }
+
+        for (int i = 0; i < frameCount; i++) {
+            FrameIndexEntry entry;
+            std::memcpy(&entry.offset, indexBytes.data() + i * 16, sizeof(entry.offset));
+            std::memcpy(&entry.size, indexBytes.data() + i * 16 + 8, sizeof(entry.size));
+            if (entry.offset > indexOffset || entry.size > indexOffset - entry.offset) {
+                throw runtime_error("Frame index entry " + to_string(i) + " is out of range");
+            }
+            frameIndex.push_back(entry);
+        }
+        return;
+    }
+
+    // Written before frame indexes existed, find the frames from their headers
+    uint64_t frameStart = 0;
+    for (int i = 0; i < frameCount; i++) {
+        in.seekg(frameDataStart + frameStart);
+
+        DataHeader frameHeader;
+        frameHeader.readDataHeader(in);
+
+        uint64_t frameSize = frameHeader.getModuleSize();
+        if (frameSize > header->getDataSize() - frameStart) {
+            throw runtime_error("Frame " + to_string(i) + " extends past the end of the image data");
+        }
+        frameIndex.push_back({ frameStart, frameSize });
+        frameStart += frameSize;
+    }
+}
+
+ModuleData ImageData::readFrame(std::istream& in, size_t index) const {
+
+    auto frame = readEncodedFrame(in, index);
+    decodeFrame(*frame);
+
+    return { frame->getMetadataAsJson(), std::move(frame->pixelData) };
+}
+
+std::unique_ptr<FrameData> ImageData::readEncodedFrame(std::istream& in, size_t index) const {
+
+    if (index >= frameIndex.size()) {
+        throw std::out_of_range("Frame index " + std::to_string(index) + " out of range");
+    }
+
+    in.seekg(frameDataStart + frameIndex[index].offset);
+    if (!hasSealedFrames()) {
+        return readEncodedFrame(in);
+    }
+
+    vector<uint8_t> sealed(frameIndex[index].size);
+    in.read(reinterpret_cast<char*>(sealed.data()), sealed.size());
+    if (in.gcount() != static_cast<std::streamsize>(sealed.size())) {
+        throw runtime_error("Failed to read frame " + to_string(index));
+    }
+
+    EncryptionData encryptionData = header->getEncryptionData();
+    vector<uint8_t> plaintext = EncryptionManager::openSegment(encryptionData.encryptionType, sealed,
+        EncryptionManager::deriveModuleKey(encryptionData), encryptionData.iv, index, true, SegmentDomain::Frame);
+
+    ispanstream frameStream(span<const char>(reinterpret_cast<const char*>(plaintext.data()), plaintext.size()));
+    return readEncodedFrame(frameStream);
+}
+
+FramePreview ImageData::readFramePreview(std::istream& in, size_t index, uint32_t maxSide) const {
+    return previewFrame(*readEncodedFrame(in, index), maxSide);
+}
+
+FramePreview ImageData::getFramePreview(size_t index, uint32_t maxSide) const {
+
+    if (index >= frames.size()) {
+        throw std::out_of_range("Frame index " + std::to_string(index) + " out of range");
+    }
+    return previewFrame(*frames[index], maxSide);
+}
+
+FrameRegion ImageData::readFrameRegion(std::istream& in, size_t index,
+                                       uint32_t x, uint32_t y, uint32_t width, uint32_t height) const {
+    return regionOfFrame(*readEncodedFrame(in, index), x, y, width, height);
+}
+
+FrameRegion ImageData::readFrameRegion(std::span<const std::byte> moduleBytes, size_t index,
+                                       uint32_t x, uint32_t y, uint32_t width, uint32_t height) const {
+
+    if (hasSealedFrames()) {
+        ispanstream stream(span<const char>(reinterpret_cast<const char*>(moduleBytes.data()), moduleBytes.size()));
+        return readFrameRegion(stream, index, x, y, width, height);
+    }
+    if (index >= frameIndex.size()) {
+        throw std::out_of_range("Frame index " + std::to_string(index) + " out of range");
+    }
+
+    uint64_t start = frameDataStart + frameIndex[index].offset;
+    if (start > moduleBytes.size() || frameIndex[index].size > moduleBytes.size() - start) {
+        throw runtime_error("Frame " + to_string(index) + " extends past the end of the module");
+    }
+
+    // Parsing from memory leaves RAW pixels as a view, so only the region's rows are copied
+    auto frame = std::unique_ptr<FrameData>(static_cast<FrameData*>(DataModule::fromStream(
+        moduleBytes.subspan(start, frameIndex[index].size), 0, ModuleType::Frame,
+        header->getEncryptionData(), dictionaries).release()));
+    if (!frame) {
+        throw std::runtime_error("Failed to read frame");
+    }
+    frame->needsDecompression = needsDecompression;
+    return regionOfFrame(*frame, x, y, width, height);
+}
+
+FrameRegion ImageData::getFrameRegion(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height) const {
+
+    if (index >= frames.size()) {
+        throw std::out_of_range("Frame index " + std::to_string(index) + " out of range");
+    }
+    return regionOfFrame(*frames[index], x, y, width, height);
+}
+
+FrameRegion ImageData::regionOfFrame(const FrameData& frame,
+                                     uint32_t x, uint32_t y, uint32_t width, uint32_t height) const {
+
+    uint32_t frameWidth = dimensions.size() > 0 ? dimensions[0] : 0;
+    uint32_t frameHeight = dimensions.size() > 1 ? dimensions[1] : 0;
+    if (width == 0 || height == 0 || x > frameWidth || width > frameWidth - x ||
+        y > frameHeight || height > frameHeight - y) {
+        throw std::out_of_range("Region " + to_string(width) + "x" + to_string(height) + "+" + to_string(x) +
+                                "+" + to_string(y) + " is outside the " + to_string(frameWidth) + "x" +
+                                to_string(frameHeight) + " frame");
+    }
+
+    FrameRegion region;
+    region.x = x;
+    region.y = y;
+    region.width = width;
+    region.height = height;
+    region.channels = channels;
+    region.bitDepth = bitDepth;
+
+    if (frame.needsDecompression) {
+        span<const byte> stored = frame.getPixelView();
+        vector<uint8_t> encoded(reinterpret_cast<const uint8_t*>(stored.data()),
+                                reinterpret_cast<const uint8_t*>(stored.data()) + stored.size());
+        region.pixels = encoder->decompressRegion(encoded, header->getDataCompression(),
+                                                  frameWidth, frameHeight, channels, bitDepth, x, y, width, height);
+        return region;
+    }
+
+    size_t pixelBytes = static_cast<size_t>(channels) * ((bitDepth + 7) / 8);
+    size_t rowBytes = frameWidth * pixelBytes;
+    size_t regionRowBytes = width * pixelBytes;
+    span<const byte> pixels = frame.getPixelView();
+    if (pixels.size() < rowBytes * frameHeight) {
+        throw std::runtime_error("Frame is smaller than its dimensions");
+    }
+
+    region.pixels.resize(regionRowBytes * height);
+    for (uint32_t row = 0; row < height; ++row) {
+        memcpy(region.pixels.data() + regionRowBytes * row,
+               pixels.data() + rowBytes * (y + row) + pixelBytes * x, regionRowBytes);
+    }
+    return region;
+}
+
+FramePreview ImageData::previewFrame(const FrameData& frame, uint32_t maxSide) const {
+
+    if (maxSide == 0) {
+        throw std::invalid_argument("Preview size must be at least one pixel");
+    }
+
+    FramePreview preview;
+    preview.channels = channels;
+    preview.bitDepth = bitDepth;
+    int width = dimensions.size() > 0 ? dimensions[0] : 0;
+    int height = dimensions.size() > 1 ? dimensions[1] : 0;
+
+    size_t bytesPerSample = (bitDepth + 7) / 8;
+    if (bytesPerSample > 2) {
+        throw std::runtime_error("Previews need 8 or 16-bit samples");
+    }
+
+    // Fewest halvings that fit, every halving rounds up
+    uint64_t longest = static_cast<uint64_t>(max(width, height));
+    int reduceLevel = 0;
+    while (((longest + (uint64_t(1) << reduceLevel) - 1) >> reduceLevel) > maxSide) {
+        ++reduceLevel;
+    }
+
+    // The stored frame is left untouched, a cached module keeps its state
+    vector<uint8_t> decoded;
+    if (frame.needsDecompression) {
+        span<const byte> stored = frame.getPixelView();
+        vector<uint8_t> encoded(reinterpret_cast<const uint8_t*>(stored.data()),
+                                reinterpret_cast<const uint8_t*>(stored.data()) + stored.size());
+        decoded = encoder->decompressReduced(encoded, header->getDataCompression(), reduceLevel, width, height);
+    }
+    else {
+        span<const byte> pixels = frame.getPixelView();
+        decoded.assign(reinterpret_cast<const uint8_t*>(pixels.data()),
+                       reinterpret_cast<const uint8_t*>(pixels.data()) + pixels.size());
+    }
+
+    if (decoded.size() != static_cast<size_t>(width) * height * channels * bytesPerSample) {
+        throw std::runtime_error("Decoded frame does not match its dimensions");
+    }
+
+    // Box filter over factor x factor blocks for the reduction the codec did not do
+    uint32_t factor = (max(width, height) + maxSide - 1) / maxSide;
+    if (factor <= 1) {
+        preview.width = width;
+        preview.height = height;
+        preview.pixels = std::move(decoded);
+        return preview;
+    }
+
+    preview.width = (width + factor - 1) / factor;
+    preview.height = (height + factor - 1) / factor;
+    preview.pixels.resize(static_cast<size_t>(preview.width) * preview.height * channels * bytesPerSample);
+
+    auto sampleAt = [&](size_t x, size_t y, size_t c) -> uint32_t {
+        const uint8_t* p = decoded.data() + ((y * width + x) * channels + c) * bytesPerSample;
+        return bytesPerSample == 1 ? p[0] : static_cast<uint32_t>(p[0] | (p[1] << 8));
+    };
+
+    for (uint32_t py = 0; py < preview.height; ++py) {
+        size_t y0 = static_cast<size_t>(py) * factor;
+        size_t y1 = min(y0 + factor, static_cast<size_t>(height));
+        for (uint32_t px = 0; px < preview.width; ++px) {
+            size_t x0 = static_cast<size_t>(px) * factor;
+            size_t x1 = min(x0 + factor, static_cast<size_t>(width));
+            size_t count = (y1 - y0) * (x1 - x0);
+            for (size_t c = 0; c < channels; ++c) {
+                uint64_t sum = 0;
+                for (size_t y = y0; y < y1; ++y) {
+                    for (size_t x = x0; x < x1; ++x) {
+                        sum += sampleAt(x, y, c);
+                    }
+                }
+                uint32_t value = static_cast<uint32_t>((sum + count / 2) / count);
+                uint8_t* out = preview.pixels.data() +
+                    ((static_cast<size_t>(py) * preview.width + px) * channels + c) * bytesPerSample;
+                out[0] = static_cast<uint8_t>(value & 0xFF);
+                if (bytesPerSample == 2) {
+                    out[1] = static_cast<uint8_t>(value >> 8);
+                }
+            }
+        }
+    }
+    return preview;
+}
+
+ModuleData ImageData::getFrame(size_t index) const {
+
+    if (index >= frames.size()) {
+        throw std::out_of_range("Frame index " + std::to_string(index) + " out of range");
+    }
+
+    decodeFrame(*frames[index]);
+    return frames[index]->getModuleData();
+}
+
+ModuleFootprint ImageData::getFootprint() const {
+
+    ModuleFootprint footprint = DataModule::getFootprint();
+    footprint.encodedBytes += frameIndex.size() * sizeof(FrameIndexEntry);
+    for (const auto& frame : frames) {
+        footprint.encodedBytes += frame->DataModule::getFootprint().encodedBytes;
+        if (frame->needsDecompression) {
+            footprint.encodedBytes += frame->pixelData.size();
+        }
+        else {
+            footprint.decodedBytes += frame->pixelData.size();
+        }
+    }
+    return footprint;
+}
+
+void ImageData::collectMetadataSamples(vector<vector<uint8_t>>& samples) {
+    DataModule::collectMetadataSamples(samples);
+    for (const auto& frame : frames) {
+        frame->collectMetadataSamples(samples);
+    }
+}
+
+void ImageData::decodeFrame(const FrameData& frame) const {
+    if (!frame.needsDecompression) {
+        return;
+    }
+
+    if (frame.pixelData.empty()) {
+        // Encoded frames borrowed from a mapping are copied out once for the codec
+        const auto* begin = reinterpret_cast<const uint8_t*>(frame.mappedPixels.data());
+        frame.pixelData.assign(begin, begin + frame.mappedPixels.size());
+    }
+
+    // Decompress the frame's pixel data in-place
+    frame.pixelData = decompressFrameData(frame.pixelData);
+    frame.needsDecompression = false;
+}
@@ -20,11 +20,41 @@
 #include "../../Utility/Compression/CompressionType.hpp"
 
 
+// Location of one embedded frame, relative to the start of the data section
+struct FrameIndexEntry {
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Downscaled copy of a frame, samples are laid out like the frame's own
+struct FramePreview {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t channels = 1;
+    uint8_t bitDepth = 8;
+    std::vector<uint8_t> pixels;
+};
+
+// Rectangular part of a frame at full resolution, rows top to bottom
+struct FrameRegion {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint8_t channels = 1;
+    uint8_t bitDepth = 8;
+    std::vector<uint8_t> pixels;
+};
+
 class ImageData : public DataModule { 
 
 protected:
     // Frame storage
     std::vector<std::unique_ptr<FrameData>> frames;
+
+    // Filled by readFrameIndex() for random access without loading the frames
+    std::vector<FrameIndexEntry> frameIndex;
+    uint64_t frameDataStart = 0;
     std::vector<uint16_t> dimensions;
     std::vector<std::string> dimensionNames;
     uint8_t bitDepth;
@@ -35,6 +65,11 @@ protected:
 
     // Frame schema reference
     std::string frameSchemaPath;
+
+    // Frame stream state, see beginFrameStream()
+    std::streampos streamModuleStart = 0;
+    std::streampos streamDataStart = 0;
+    std::vector<FrameIndexEntry> streamIndex;
     
     explicit ImageData() {};
 
@@ -42,18 +77,50 @@ protected:
 
     void readMetadataRows(std::istream& in) override;
     void readData(std::istream& in) override;
+    void readData(std::span<const std::byte> bytes) override;
+    // Frames are compressed one by one, never the section as a whole
+    bool hasCompressedDataSection() const override { return false; }
+
+    // ZSTD frames use the frame codec's own default level
+    ZstdSettings getDefaultDataZstd() const override;
+
+    // Open the individually sealed frames of an encrypted image via its index
+    void readSealedFrames(std::istream& in);
 
     void writeData(std::ostream& out) const override;
     void writeStringBuffer(std::ostream& out);
 
+    // Validate one frame of addData() input and build it, still unencoded
+    std::unique_ptr<FrameData> makeFrame(const ModuleData& frame, size_t i) const;
+
+    // Encode pixels with the module's codec, RAW pixels are returned as they are
+    std::vector<uint8_t> encodeFrame(const std::vector<uint8_t>& pixels, int width, int height) const;
+
+    void writeFrameIndex(std::ostream& out, const std::vector<FrameIndexEntry>& index) const;
+
     // Override the virtual method for image-specific data
     std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>> 
     getModuleSpecificData() const override;
 
+    // Decode a frame's pixel data in place if it is still encoded
+    void decodeFrame(const FrameData& frame) const;
+
+    // Read the frame at the current stream position, or the indexed frame, still encoded
+    std::unique_ptr<FrameData> readEncodedFrame(std::istream& in) const;
+    std::unique_ptr<FrameData> readEncodedFrame(std::istream& in, size_t index) const;
+
+    // Codec resolution levels first, then a box filter for whatever is left
+    FramePreview previewFrame(const FrameData& frame, uint32_t maxSide) const;
+
+    // Decoded frames are sliced directly, encoded ones go through the codec
+    FrameRegion regionOfFrame(const FrameData& frame, uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
 public:
     explicit ImageData(const std::string& schemaPath, DataHeader& dataheader);
     explicit ImageData(
         const std::string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, EncryptionData encryptionData);
+    explicit ImageData(
+        const std::string& schemaPath, std::shared_ptr<const CompiledSchema> schema, UUID uuid, EncryptionData encryptionData);
 
     virtual ~ImageData() override = default;
     
@@ -91,6 +158,64 @@ public:
     // Decompression helper method
     std::vector<uint8_t> decompressFrameData(const std::vector<uint8_t>& compressedData) const;
 
+    // Read the frame at the current stream position and decode its pixels,
+    // without keeping it in this module
+    ModuleData readFrame(std::istream& in) const;
+
+    // Locate every frame of a module read with metadataFromStream(). The stream
+    // must be positioned at the start of the data section; files without a
+    // stored frame index are indexed by walking the frame headers.
+    void readFrameIndex(std::istream& in);
+    size_t getIndexedFrameCount() const { return frameIndex.size(); }
+
+    // Seek to and decode a single frame found by readFrameIndex(). The stream
+    // must use the same positions as the one the index was read from.
+    ModuleData readFrame(std::istream& in, size_t index) const;
+
+    // Frames and frame index are sealed one by one rather than with the module
+    bool hasSealedFrames() const {
+        const auto& encryption = header->getEncryptionData();
+        return encryption.encryptionType != EncryptionType::NONE && encryption.framesSealed;
+    }
+
+    // Decode a single frame of a fully loaded module
+    ModuleData getFrame(size_t index) const;
+
+    // Write the module a frame at a time instead of through addData() and
+    // writeBinary(). beginFrameStream() writes header and metadata, every
+    // appended frame is encoded and written straight away, and
+    // finishFrameStream() adds the frame index, patches the header and
+    // records the module in xref. Only the index stays in memory. The frame
+    // count is the one declared in the metadata. Unencrypted modules only.
+    void beginFrameStream(std::streampos absoluteModuleStart, std::ostream& out,
+                          const XRefTable& xref, const std::string& author);
+    void appendStreamFrame(std::ostream& out, const ModuleData& frame);
+    void finishFrameStream(std::ostream& out, XRefTable& xref);
+    size_t getStreamedFrameCount() const { return streamIndex.size(); }
+
+    // Downscale a frame so that neither side exceeds maxSide. JPEG 2000 frames
+    // decode only the resolution levels needed, other codecs decode in full.
+    FramePreview readFramePreview(std::istream& in, size_t index, uint32_t maxSide) const;
+    FramePreview getFramePreview(size_t index, uint32_t maxSide) const;
+
+    // Decode a region of a frame. JPEG 2000 decodes only the code-blocks the
+    // region touches; RAW frames parsed from mapped bytes are sliced in place.
+    FrameRegion readFrameRegion(std::istream& in, size_t index,
+                                uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+    FrameRegion readFrameRegion(std::span<const std::byte> moduleBytes, size_t index,
+                                uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+    FrameRegion getFrameRegion(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+
+    // Decoded pixels of a single frame without copying. For RAW frames read
+    // from a memory mapping this is a view straight into the mapped file.
+    std::span<const std::byte> getFramePixelView(size_t frameIndex) const;
+
+    // Frames still awaiting decompression count as encoded, the rest as
+    // decoded. Pixels borrowed from a mapping are not counted.
+    ModuleFootprint getFootprint() const override;
+
+    void collectMetadataSamples(std::vector<std::vector<uint8_t>>& samples) override;
+
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "imageFrameStream.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+ImageFrameStream::ImageFrameStream(const string& filePath, uint64_t moduleOffset,
+    EncryptionData encryptionData, shared_ptr<const DictionaryTable> dictionaries, size_t readAheadBytes)
+    : readAheadBuffer(std::max<size_t>(readAheadBytes, 1)) {
+
+    // The buffer has to be installed before the file is opened to take effect
+    file.rdbuf()->pubsetbuf(readAheadBuffer.data(), readAheadBuffer.size());
+    file.open(filePath, ios::in | ios::binary);
+    if (!file.is_open()) {
+        throw runtime_error("Failed to open file: " + filePath);
+    }
+
+    file.seekg(moduleOffset);
+
+    unique_ptr<DataModule> dm = DataModule::metadataFromStream(
+        file, moduleOffset, ModuleType::Image, encryptionData, std::move(dictionaries));
+    if (!dm || dm->getModuleType() != ModuleType::Image) {
+        throw runtime_error("Module is not an image");
+    }
+    image.reset(static_cast<ImageData*>(dm.release()));
+
+    // Sealed frames are not self-delimiting, find them through the index
+    if (image->hasSealedFrames()) {
+        image->readFrameIndex(file);
+    }
+
+    frameCount = image->getFrameCount();
+}
+
+expected<ModuleData, string> ImageFrameStream::nextFrame() {
+
+    if (!hasNextFrame()) {
+        return unexpected("No more frames");
+    }
+
+    try {
+        ModuleData frame = image->hasSealedFrames() ? image->readFrame(file, framesRead) : image->readFrame(file);
+        ++framesRead;
+        return frame;
+    }
+    catch (const exception& e) {
+        return unexpected("Error reading frame " + to_string(framesRead) + ": " + e.what());
+    }
+}
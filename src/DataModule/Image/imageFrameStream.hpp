@@ -0,0 +1,69 @@
+#ifndef IMAGEFRAMESTREAM_HPP
+#define IMAGEFRAMESTREAM_HPP
+
+#include <cstdint>
+#include <expected>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "imageData.hpp"
+#include "../ModuleData.hpp"
+#include "../../Utility/Encryption/encryptionManager.hpp"
+
+/**
+ * @brief Sequential, bounded-memory reader for a single image module.
+ *
+ * Decodes the module header and metadata up front, then yields one frame at a
+ * time straight from the file. At most one frame (encoded and decoded) plus the
+ * read-ahead buffer is resident, so modules larger than the Reader's in-memory
+ * limit can still be consumed.
+ *
+ * The stream owns its own file handle and is independent of the Reader that
+ * created it.
+ */
+class ImageFrameStream {
+private:
+    // Declared before the file so it outlives the stream buffer that uses it
+    std::vector<char> readAheadBuffer;
+    std::ifstream file;
+
+    std::unique_ptr<ImageData> image;
+    size_t frameCount = 0;
+    size_t framesRead = 0;
+
+public:
+    static constexpr size_t DEFAULT_READ_AHEAD = 4 * 1024 * 1024; // 4 MB
+
+    /**
+     * @brief Open the image module stored at moduleOffset.
+     *
+     * @param filePath Path to the UMDF file
+     * @param moduleOffset File offset of the image module
+     * @param encryptionData File encryption parameters
+     * @param dictionaries Dictionary table of the file, if it has one
+     * @param readAheadBytes Size of the file read-ahead buffer
+     * @throws std::runtime_error if the module cannot be opened or is not an image
+     */
+    ImageFrameStream(const std::string& filePath, uint64_t moduleOffset,
+        EncryptionData encryptionData, std::shared_ptr<const DictionaryTable> dictionaries = nullptr,
+        size_t readAheadBytes = DEFAULT_READ_AHEAD);
+
+    ImageFrameStream(const ImageFrameStream&) = delete;
+    ImageFrameStream& operator=(const ImageFrameStream&) = delete;
+
+    nlohmann::json getMetadata() const { return image->getMetadataAsJson(); }
+    size_t getFrameCount() const { return frameCount; }
+    size_t getFramesRead() const { return framesRead; }
+    bool hasNextFrame() const { return framesRead < frameCount; }
+
+    /**
+     * @brief Read and decode the next frame.
+     * @return std::expected containing the frame on success, or error message on failure
+     */
+    std::expected<ModuleData, std::string> nextFrame();
+};
+
+#endif
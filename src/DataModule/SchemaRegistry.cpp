@@ -0,0 +1,233 @@
+#include "SchemaRegistry.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Schema files read by the section compile running on this thread
+thread_local vector<SchemaFileVersion>* loadedReferences = nullptr;
+
+// Records the schema files read while in scope, handing them on to an
+// enclosing compile when there is one
+class ReferenceRecorder {
+    vector<SchemaFileVersion>& loaded;
+    vector<SchemaFileVersion>* previous;
+public:
+    explicit ReferenceRecorder(vector<SchemaFileVersion>& loaded)
+        : loaded(loaded), previous(loadedReferences) {
+        loadedReferences = &loaded;
+    }
+    ~ReferenceRecorder() {
+        loadedReferences = previous;
+        if (previous) {
+            previous->insert(previous->end(), loaded.begin(), loaded.end());
+        }
+    }
+};
+
+bool readVersion(const string& path, fs::file_time_type& modified, uintmax_t& size) {
+    error_code ec;
+    modified = fs::last_write_time(path, ec);
+    size = ec ? 0 : fs::file_size(path, ec);
+    return !ec;
+}
+
+}
+
+FieldList CompiledSchema::instantiateFields(const string& section, StringBuffer* stringBuffer,
+                                            const function<FieldList()>& compile) const {
+    {
+        lock_guard<std::mutex> lock(fieldsMutex);
+        auto it = sections.find(section);
+        if (it != sections.end()) {
+            FieldList fields;
+            fields.reserve(it->second.prototype.size());
+            for (const auto& field : it->second.prototype) {
+                fields.push_back(field->clone(stringBuffer));
+            }
+            return fields;
+        }
+    }
+
+    // Compiled outside the lock, $refs load other schemas. A failed compile
+    // is not remembered, so every module reports the same error.
+    vector<SchemaFileVersion> loaded;
+    FieldList fields;
+    {
+        ReferenceRecorder recorder(loaded);
+        fields = compile();
+    }
+
+    FieldList prototype;
+    prototype.reserve(fields.size());
+    for (const auto& field : fields) {
+        prototype.push_back(field->clone(nullptr));
+    }
+
+    auto layout = make_shared<const CompiledRowLayout>(prototype);
+
+    lock_guard<std::mutex> lock(fieldsMutex);
+    if (sections.try_emplace(section, Section{ std::move(prototype), std::move(layout) }).second) {
+        for (auto& file : loaded) {
+            auto known = find_if(references.begin(), references.end(),
+                                 [&](const SchemaFileVersion& r) { return r.path == file.path; });
+            if (known == references.end()) {
+                references.push_back(std::move(file));
+            }
+        }
+    }
+    return fields;
+}
+
+shared_ptr<const CompiledRowLayout> CompiledSchema::getRowLayout(const string& section) const {
+    lock_guard<std::mutex> lock(fieldsMutex);
+    auto it = sections.find(section);
+    if (it == sections.end()) {
+        throw runtime_error("Schema section has not been compiled: " + section);
+    }
+    return it->second.layout;
+}
+
+bool CompiledSchema::referencesChanged() const {
+    vector<SchemaFileVersion> files;
+    {
+        lock_guard<std::mutex> lock(fieldsMutex);
+        files = references;
+    }
+
+    for (const auto& file : files) {
+        fs::file_time_type modified;
+        uintmax_t size = 0;
+        if (!readVersion(file.path, modified, size) || modified != file.modified || size != file.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SchemaRegistry& SchemaRegistry::shared() {
+    static SchemaRegistry registry;
+    return registry;
+}
+
+string SchemaRegistry::resolvePath(const string& path) {
+    error_code ec;
+    fs::path resolved = fs::weakly_canonical(path, ec);
+    return ec ? fs::path(path).lexically_normal().string() : resolved.string();
+}
+
+string SchemaRegistry::canonicalPath(const string& path) {
+    {
+        lock_guard<std::mutex> lock(entriesMutex);
+        auto it = canonicalPaths.find(path);
+        if (it != canonicalPaths.end()) {
+            return it->second;
+        }
+    }
+
+    // Resolving walks every component of the path, so it is done once per requested path
+    string key = resolvePath(path);
+    lock_guard<std::mutex> lock(entriesMutex);
+    canonicalPaths.try_emplace(path, key);
+    return key;
+}
+
+shared_ptr<const CompiledSchema> SchemaRegistry::get(const string& path) {
+
+    string key = canonicalPath(path);
+    auto now = chrono::steady_clock::now();
+
+    // Schemas checked within the interval are used without touching their files
+    {
+        lock_guard<std::mutex> lock(entriesMutex);
+        auto it = entries.find(key);
+        if (it != entries.end() && now < it->second.validUntil) {
+            // A compile in progress on this thread depends on this file
+            if (loadedReferences) {
+                loadedReferences->push_back(SchemaFileVersion{ key, it->second.modified, it->second.size });
+            }
+            return it->second.schema;
+        }
+    }
+
+    fs::file_time_type modified;
+    uintmax_t size = 0;
+    if (!readVersion(key, modified, size)) {
+        throw runtime_error("Failed to open schema file: " + path);
+    }
+
+    if (loadedReferences) {
+        loadedReferences->push_back(SchemaFileVersion{ key, modified, size });
+    }
+
+    shared_ptr<const CompiledSchema> cached;
+    chrono::steady_clock::time_point validUntil;
+    {
+        lock_guard<std::mutex> lock(entriesMutex);
+        validUntil = now + revalidationInterval;
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.modified == modified && it->second.size == size) {
+            cached = it->second.schema;
+        }
+    }
+    if (cached && !cached->referencesChanged()) {
+        lock_guard<std::mutex> lock(entriesMutex);
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.schema == cached) {
+            it->second.validUntil = validUntil;
+        }
+        return cached;
+    }
+
+    // Parsed outside the lock, a concurrent load of the same file is harmless
+    ifstream file(key);
+    if (!file.is_open()) {
+        throw runtime_error("Failed to open schema file: " + path);
+    }
+    nlohmann::json json;
+    try {
+        file >> json;
+    } catch (const nlohmann::json::exception& e) {
+        throw runtime_error("Failed to parse schema file " + path + ": " + e.what());
+    }
+
+    auto schema = make_shared<const CompiledSchema>(std::move(json));
+
+    lock_guard<std::mutex> lock(entriesMutex);
+    entries[key] = Entry{ modified, size, schema, validUntil };
+    return schema;
+}
+
+void SchemaRegistry::setRevalidationInterval(chrono::steady_clock::duration interval) {
+    lock_guard<std::mutex> lock(entriesMutex);
+    revalidationInterval = interval;
+}
+
+void SchemaRegistry::revalidate() {
+    lock_guard<std::mutex> lock(entriesMutex);
+    for (auto& [key, entry] : entries) {
+        entry.validUntil = chrono::steady_clock::time_point::min();
+    }
+}
+
+bool SchemaRegistry::contains(const string& path) const {
+    string key = resolvePath(path);
+    lock_guard<std::mutex> lock(entriesMutex);
+    return entries.find(key) != entries.end();
+}
+
+size_t SchemaRegistry::size() const {
+    lock_guard<std::mutex> lock(entriesMutex);
+    return entries.size();
+}
+
+void SchemaRegistry::clear() {
+    lock_guard<std::mutex> lock(entriesMutex);
+    entries.clear();
+    canonicalPaths.clear();
+}
@@ -0,0 +1,127 @@
+#ifndef SCHEMA_REGISTRY_HPP
+#define SCHEMA_REGISTRY_HPP
+
+#include "dataField.hpp"
+#include "stringBuffer.hpp"
+#include "CompiledRowLayout.hpp"
+
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using FieldList = std::vector<std::unique_ptr<DataField>>;
+
+// A schema file as it was when it was read
+struct SchemaFileVersion {
+    std::string path;
+    std::filesystem::file_time_type modified;
+    std::uintmax_t size;
+};
+
+/**
+ * @brief A parsed schema and the field lists compiled from it.
+ *
+ * Shared by every module using the schema, on any thread. The JSON never
+ * changes once loaded. Field lists are compiled by the first module that
+ * needs them and kept as prototypes, later modules get copies bound to
+ * their own string buffer. Each compiled section also gets the row layout
+ * its table rows are encoded with. The prototypes include fields taken from
+ * other schema files through $ref, so the versions of those files are kept
+ * alongside them.
+ */
+class CompiledSchema {
+private:
+    nlohmann::json json;
+
+    struct Section {
+        FieldList prototype;
+        std::shared_ptr<const CompiledRowLayout> layout;
+    };
+
+    mutable std::mutex fieldsMutex;
+    mutable std::map<std::string, Section> sections;
+    mutable std::vector<SchemaFileVersion> references;
+
+public:
+    explicit CompiledSchema(nlohmann::json json) : json(std::move(json)) {}
+
+    const nlohmann::json& getJson() const { return json; }
+
+    /**
+     * @brief Fields of a schema section, bound to stringBuffer.
+     *
+     * @param section Name of the section, e.g. "metadata" or "data"
+     * @param stringBuffer String buffer of the module the fields are for
+     * @param compile Parses the section into fields bound to stringBuffer,
+     *                only called while the section has not been compiled
+     */
+    FieldList instantiateFields(const std::string& section, StringBuffer* stringBuffer,
+                                const std::function<FieldList()>& compile) const;
+
+    /**
+     * @brief Row layout of a section's fields.
+     * @throws std::runtime_error if the section has not been compiled by instantiateFields()
+     */
+    std::shared_ptr<const CompiledRowLayout> getRowLayout(const std::string& section) const;
+
+    // Whether a schema file referenced by a compiled section has changed since
+    bool referencesChanged() const;
+};
+
+/**
+ * @brief Process-wide cache of schemas, loaded at most once per file version.
+ *
+ * Schemas are keyed by their canonical path and reloaded only when the
+ * modification time or size of the file, or of a file its compiled fields
+ * were taken from, changes. Those files are checked again at most once per
+ * revalidation interval, or on the next use after revalidate(), which
+ * readers and writers call when they open a file. Requested paths are
+ * resolved once, relative ones against the working directory at the time.
+ * Safe to use from several threads at once.
+ */
+class SchemaRegistry {
+private:
+    struct Entry {
+        std::filesystem::file_time_type modified;
+        std::uintmax_t size;
+        std::shared_ptr<const CompiledSchema> schema;
+        std::chrono::steady_clock::time_point validUntil;
+    };
+
+    mutable std::mutex entriesMutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<std::string, std::string> canonicalPaths;
+    std::chrono::steady_clock::duration revalidationInterval = DEFAULT_REVALIDATION_INTERVAL;
+
+    static std::string resolvePath(const std::string& path);
+    std::string canonicalPath(const std::string& path);
+
+public:
+    static constexpr std::chrono::milliseconds DEFAULT_REVALIDATION_INTERVAL{1000};
+
+    static SchemaRegistry& shared();
+
+    /**
+     * @brief The schema at path, from the cache unless the file has changed.
+     * @throws std::runtime_error if the file cannot be opened or parsed
+     */
+    std::shared_ptr<const CompiledSchema> get(const std::string& path);
+
+    // How long a schema is used without checking its files for changes
+    void setRevalidationInterval(std::chrono::steady_clock::duration interval);
+    // Check every schema against its files on its next use
+    void revalidate();
+
+    bool contains(const std::string& path) const;
+    size_t size() const;
+    void clear();
+};
+
+#endif // SCHEMA_REGISTRY_HPP
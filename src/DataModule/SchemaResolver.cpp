@@ -1,4 +1,5 @@
 #include "SchemaResolver.hpp"
+#include "SchemaRegistry.hpp"
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
@@ -8,8 +9,7 @@
 namespace fs = std::filesystem;
 
 // Initialize static members
-std::unordered_map<std::string, nlohmann::json> SchemaResolver::schemaCache;
-std::vector<std::string> SchemaResolver::referenceStack;
+thread_local std::vector<std::string> SchemaResolver::referenceStack;
 
 bool SchemaResolver::hasCircularReference(const std::string& refPath) {
     // Check if this (resolved) reference path is already in the current resolution stack
@@ -46,22 +46,7 @@ std::string SchemaResolver::resolveRelativePath(const std::string& refPath, cons
 }
 
 nlohmann::json SchemaResolver::getSchemaByResolvedPath(const std::string& fullPath) {
-    auto it = schemaCache.find(fullPath);
-    if (it != schemaCache.end()) {
-        return it->second;
-    }
-
-    std::ifstream file(fullPath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Failed to open referenced schema file: " + fullPath);
-    }
-
-    nlohmann::json referencedSchema;
-    file >> referencedSchema;
-    file.close();
-
-    schemaCache[fullPath] = referencedSchema;
-    return referencedSchema;
+    return SchemaRegistry::shared().get(fullPath)->getJson();
 }
 
 std::string SchemaResolver::beginReference(const std::string& refPath, const std::string& baseSchemaPath) {
@@ -120,27 +105,12 @@ nlohmann::json SchemaResolver::resolveReference(const std::string& refPath, cons
         throw std::runtime_error(stackTrace);
     }
     
-    // Check if schema is already cached
-    if (schemaCache.find(fullPath) != schemaCache.end()) {
-        return schemaCache[fullPath];
-    }
-    
     // Add to current resolution stack using resolved path for circular detection
     referenceStack.push_back(fullPath);
     
     try {
-        // Load the referenced schema file
-        std::ifstream file(fullPath);
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open referenced schema file: " + fullPath);
-        }
-        
-        nlohmann::json referencedSchema;
-        file >> referencedSchema;
-        file.close();
-        
-        // Cache the loaded schema using the resolved path
-        schemaCache[fullPath] = referencedSchema;
+        // Load the referenced schema file, or take it from the registry
+        nlohmann::json referencedSchema = getSchemaByResolvedPath(fullPath);
         
         // Remove from stack before returning
         referenceStack.pop_back();
@@ -155,7 +125,7 @@ nlohmann::json SchemaResolver::resolveReference(const std::string& refPath, cons
 }
 
 void SchemaResolver::clearCache() {
-    schemaCache.clear();
+    SchemaRegistry::shared().clear();
     referenceStack.clear();
 }
 
@@ -164,10 +134,9 @@ std::vector<std::string> SchemaResolver::getCurrentStack() {
 }
 
 bool SchemaResolver::isCached(const std::string& refPath) {
-    std::string fullPath = resolveRelativePath(refPath, "");
-    return schemaCache.find(fullPath) != schemaCache.end();
+    return SchemaRegistry::shared().contains(resolveRelativePath(refPath, ""));
 }
 
 size_t SchemaResolver::getCacheSize() {
-    return schemaCache.size();
+    return SchemaRegistry::shared().size();
 }
@@ -2,18 +2,17 @@
 #define SCHEMA_RESOLVER_HPP
 
 #include <nlohmann/json.hpp>
-#include <unordered_map>
 #include <vector>
 #include <string>
 #include <stdexcept>
 
 class SchemaResolver {
 private:
-    // Static cache for loaded schemas to avoid reloading
-    static std::unordered_map<std::string, nlohmann::json> schemaCache;
-    
-    // Current resolution stack to detect circular references
-    static std::vector<std::string> referenceStack;
+    // Loaded schemas are cached by SchemaRegistry
+
+    // Current resolution stack to detect circular references, one per thread
+    // since modules may be parsed concurrently
+    static thread_local std::vector<std::string> referenceStack;
     
     // Maximum depth to prevent excessive nesting
     static constexpr int MAX_REFERENCE_DEPTH = 50;
@@ -35,7 +34,7 @@ public:
     // New: fetch a schema by fully resolved path (cached or load)
     static nlohmann::json getSchemaByResolvedPath(const std::string& fullPath);
     
-    // Clear the schema cache (useful for testing or memory management)
+    // Clear the schema registry and this thread's stack (useful for testing or memory management)
     static void clearCache();
     
     // Get the current reference stack (useful for debugging)
@@ -22,7 +22,11 @@ TabularData::TabularData(const string& schemaPath, DataHeader& dataheader) : Dat
 
 TabularData::TabularData(
     const string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, EncryptionData encryptionData) 
-    : DataModule(schemaPath, schemaJson, uuid, ModuleType::Tabular, encryptionData) {
+    : TabularData(schemaPath, make_shared<const CompiledSchema>(schemaJson), uuid, encryptionData) {}
+
+TabularData::TabularData(
+    const string& schemaPath, shared_ptr<const CompiledSchema> schema, UUID uuid, EncryptionData encryptionData) 
+    : DataModule(schemaPath, std::move(schema), uuid, ModuleType::Tabular, encryptionData) {
     header->setDataCompression(CompressionType::ZSTD);
     initialise();
 }
@@ -43,11 +47,7 @@ void TabularData::parseDataSchema(const nlohmann::json& schemaJson) {
         throw runtime_error("Schema missing essential 'properties' field.");
     }
 
-    const auto& props = schemaJson["properties"];
-
-    for (const auto& [name, definition] : props.items()) {
-        fields.emplace_back(parseField(name, definition));
-    }
+    fields = compileFields("data", schemaJson["properties"], dataLayout);
 }
 
 void TabularData::addData(const std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>>& data) {
@@ -57,11 +57,11 @@ void TabularData::addData(const std::variant<nlohmann::json, std::vector<uint8_t
         if (jsonData.is_array()) {
             // Handle array of data rows
             for (const auto& row : jsonData) {
-                addTableData(row, fields, rows, dataRequired);
+                addTableData(row, dataLayout, rows, dataRequired);
             }
         } else {
             // Handle single data row
-            addTableData(jsonData, fields, rows, dataRequired);
+            addTableData(jsonData, dataLayout, rows, dataRequired);
         }
     }
 }
@@ -74,14 +74,12 @@ void TabularData::writeData(ostream& out) const {
 
         writeTableRows(buffer, rows);
 
-        std::vector<uint8_t> dataBytes {
-            std::istreambuf_iterator<char>(buffer),
-            std::istreambuf_iterator<char>()
-        };
-
-        std::vector<uint8_t> compressedData = ZstdCompressor::compress(dataBytes);
+        // Compress straight out of the buffer, an empty table stays empty
+        std::string_view dataBytes = buffer.view();
+        std::vector<uint8_t> compressedData(ZstdCompressor::compressBound(dataBytes.size()));
 
-        size_t compressedDataSize = compressedData.size();
+        size_t compressedDataSize = dataBytes.empty() ? 0 : ZstdCompressor::compressInto(
+            as_bytes(span(dataBytes)), as_writable_bytes(span(compressedData)), header->getDataZstd());
 
 
 
@@ -100,10 +98,18 @@ void TabularData::writeData(ostream& out) const {
 
 void TabularData::readData(istream& in) {
 
-    readTableRows(in, header->getDataSize(), fields, rows);
+    readTableRows(in, header->getDataSize(), dataLayout, rows);
 }
 
 std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>> 
 TabularData::getModuleSpecificData() const {
-    return getTableDataAsJson(dataRequired, rows, fields);
-}
\ No newline at end of file
+    return getTableDataAsJson(dataRequired, rows, dataLayout);
+}
+ModuleFootprint TabularData::getFootprint() const {
+
+    ModuleFootprint footprint = DataModule::getFootprint();
+    for (const auto& row : rows) {
+        footprint.encodedBytes += row.size();
+    }
+    return footprint;
+}
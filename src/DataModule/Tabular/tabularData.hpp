@@ -16,6 +16,7 @@ class TabularData : public DataModule {
 
 protected:
     std::vector<std::unique_ptr<DataField>> fields;
+    RowBinding dataLayout;
     std::vector<std::vector<uint8_t>> rows;
     
     size_t rowSize = 0;
@@ -37,12 +38,15 @@ public:
     explicit TabularData(const std::string& schemaPath, DataHeader& dataheader);
     explicit TabularData(
         const std::string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, EncryptionData encryptionData);
+    explicit TabularData(
+        const std::string& schemaPath, std::shared_ptr<const CompiledSchema> schema, UUID uuid, EncryptionData encryptionData);
         
     virtual ~TabularData() override = default;
     
     virtual void addData(
         const std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>>&) override;
 
+    ModuleFootprint getFootprint() const override;
 
 };
 
@@ -20,7 +20,11 @@ UnknownData::UnknownData(const string& schemaPath, DataHeader& dataheader) : Dat
 
 UnknownData::UnknownData(
     const string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, EncryptionData encryptionData) 
-    : DataModule(schemaPath, schemaJson, uuid, ModuleType::Unknown, encryptionData) {
+    : UnknownData(schemaPath, make_shared<const CompiledSchema>(schemaJson), uuid, encryptionData) {}
+
+UnknownData::UnknownData(
+    const string& schemaPath, shared_ptr<const CompiledSchema> schema, UUID uuid, EncryptionData encryptionData) 
+    : DataModule(schemaPath, std::move(schema), uuid, ModuleType::Unknown, encryptionData) {
     initialise();
 }
 
@@ -37,6 +37,8 @@ public:
     explicit UnknownData(const std::string& schemaPath, DataHeader& dataheader);
     explicit UnknownData(
         const std::string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, EncryptionData encryptionData);
+    explicit UnknownData(
+        const std::string& schemaPath, std::shared_ptr<const CompiledSchema> schema, UUID uuid, EncryptionData encryptionData);
         
     virtual ~UnknownData() override = default;
     
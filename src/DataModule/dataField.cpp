@@ -111,6 +111,12 @@ bool VarStringField::validateValue(const nlohmann::json& value) const {
     return true;
 }
 
+unique_ptr<DataField> VarStringField::clone(StringBuffer* stringBuffer) const {
+    auto copy = make_unique<VarStringField>(*this);
+    copy->stringBuffer = stringBuffer;
+    return copy;
+}
+
 /* ================== EnumField ================== */
 
 uint8_t EnumField::lookupEnumValue(const string& value) const {
@@ -273,6 +279,12 @@ ArrayField::ArrayField(std::string name, const nlohmann::json& itemDef,
     }
 }
 
+unique_ptr<DataField> ArrayField::clone(StringBuffer* stringBuffer) const {
+    unique_ptr<ArrayField> copy(new ArrayField(name, itemField->clone(stringBuffer), minItems, maxItems));
+    copy->hasValue = hasValue;
+    return copy;
+}
+
 size_t ArrayField::getLength() const {
     return 2 + (itemField->getLength() * maxItems); // 2 bytes for length + max possible items
 }
@@ -462,6 +474,17 @@ nlohmann::json ObjectField::decodeFromBuffer(
     return obj;
 }
 
+unique_ptr<DataField> ObjectField::clone(StringBuffer* stringBuffer) const {
+    vector<unique_ptr<DataField>> subFieldCopies;
+    subFieldCopies.reserve(subFields.size());
+    for (const auto& subField : subFields) {
+        subFieldCopies.push_back(subField->clone(stringBuffer));
+    }
+    auto copy = make_unique<ObjectField>(name, std::move(subFieldCopies), requiredFields);
+    copy->hasValue = hasValue;
+    return copy;
+}
+
 void ObjectField::addSubField(unique_ptr<DataField> field) {
 
     subFields.push_back(std::move(field));
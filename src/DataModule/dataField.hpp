@@ -38,6 +38,10 @@ public:
 
     virtual bool validateValue(const nlohmann::json& value) const = 0;
 
+    // Copy of this field for another module, variable length strings are
+    // bound to that module's string buffer
+    virtual std::unique_ptr<DataField> clone(StringBuffer* stringBuffer) const = 0;
+
     void writeRowBitMap();
 
     // Overload operator<< for Field
@@ -60,6 +64,8 @@ public:
     nlohmann::json decodeFromBuffer(const std::vector<uint8_t>& buffer, size_t offset) override;
 
     bool validateValue(const nlohmann::json& value) const override;
+
+    std::unique_ptr<DataField> clone(StringBuffer*) const override { return std::make_unique<StringField>(*this); }
 };
 
 /* =============== VarStringField =============== */
@@ -80,6 +86,8 @@ public:
     nlohmann::json decodeFromBuffer(const std::vector<uint8_t>& buffer, size_t offset) override;
 
     bool validateValue(const nlohmann::json& value) const override;
+
+    std::unique_ptr<DataField> clone(StringBuffer* stringBuffer) const override;
 };
 
 /* =============== EnumField =============== */
@@ -101,6 +109,8 @@ public:
     nlohmann::json decodeFromBuffer(const std::vector<uint8_t>& buffer, size_t offset) override;
 
     bool validateValue(const nlohmann::json& value) const override;
+
+    std::unique_ptr<DataField> clone(StringBuffer*) const override { return std::make_unique<EnumField>(*this); }
 };
 
 /* =============== ArrayField =============== */
@@ -110,6 +120,9 @@ private:
     std::unique_ptr<DataField> itemField;
     size_t minItems, maxItems;
 
+    ArrayField(std::string name, std::unique_ptr<DataField> itemField, size_t minItems, size_t maxItems)
+        : DataField(std::move(name), "array"), itemField(std::move(itemField)), minItems(minItems), maxItems(maxItems) {}
+
 public:
     ArrayField(std::string name, const nlohmann::json& itemDef, 
                size_t minItems, size_t maxItems);
@@ -119,6 +132,8 @@ public:
     nlohmann::json decodeFromBuffer(const std::vector<uint8_t>& buffer, size_t offset) override;
 
     bool validateValue(const nlohmann::json& value) const override;
+
+    std::unique_ptr<DataField> clone(StringBuffer* stringBuffer) const override;
 };
 
 /* =============== IntegerField =============== */
@@ -150,6 +165,8 @@ public:
 
     bool validateValue(const nlohmann::json& value) const override;
 
+    std::unique_ptr<DataField> clone(StringBuffer*) const override { return std::make_unique<IntegerField>(*this); }
+
 };
 
 /* =============== FloatField =============== */
@@ -170,6 +187,8 @@ public:
 
     bool validateValue(const nlohmann::json& value) const override;
 
+    std::unique_ptr<DataField> clone(StringBuffer*) const override { return std::make_unique<FloatField>(*this); }
+
 };
 
 /* =============== ObjectField =============== */
@@ -199,6 +218,8 @@ public:
     size_t getLength() const override;
 
     bool validateValue(const nlohmann::json& value) const override;
+
+    std::unique_ptr<DataField> clone(StringBuffer* stringBuffer) const override;
 };
 
 #endif
\ No newline at end of file
@@ -14,6 +14,8 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <array>
+#include <spanstream>
 
 using namespace std;
 
@@ -25,18 +27,20 @@ DataModule::DataModule(const string& schemaPath, DataHeader& dataheader) {
     header->setSchemaPath(schemaPath);
     header->setModuleID(dataheader.getModuleID());
     header->setMetadataCompression(dataheader.getMetadataCompression());
+    header->setMetadataZstd(dataheader.getMetadataZstd());
+    header->setDataZstd(dataheader.getDataZstd());
+    header->setMetadataDictionary(dataheader.getMetadataDictionary());
     header->setEncryptionData(dataheader.getEncryptionData());
     header->setCreatedAt(dataheader.getCreatedAt());
     header->setCreatedBy(dataheader.getCreatedBy());
     
-    ifstream file = openSchemaFile(schemaPath);
-    file >> schemaJson;
+    schema = SchemaRegistry::shared().get(schemaPath);
     
 }
 
 DataModule::DataModule(
-    const string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, ModuleType type, EncryptionData encryptionData) 
-    : schemaJson(schemaJson) {
+    const string& schemaPath, shared_ptr<const CompiledSchema> schema, UUID uuid, ModuleType type, EncryptionData encryptionData) 
+    : schema(std::move(schema)) {
 
     header = make_unique<DataHeader>();
     header->setModuleType(type);
@@ -48,14 +52,14 @@ DataModule::DataModule(
 
 void DataModule::initialise() {
     try {
-        parseSchema(schemaJson);
+        parseSchema(schema->getJson());
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to parse schema: " + std::string(e.what()));
     }
 }
 
 const nlohmann::json& DataModule::getSchema() const {
-    return schemaJson;
+    return schema->getJson();
 }
 
 void DataModule::parseSchema(const nlohmann::json& schemaJson) {
@@ -86,10 +90,7 @@ void DataModule::parseSchema(const nlohmann::json& schemaJson) {
             }
         }
 
-        const auto& metadataProps = props.at("metadata").at("properties");
-        for (const auto& [name, definition] : metadataProps.items()) {
-            metaDataFields.emplace_back(parseField(name, definition));
-        }
+        metaDataFields = compileFields("metadata", props.at("metadata").at("properties"), metaDataLayout);
     }
 
     // Parse data
@@ -122,16 +123,19 @@ void DataModule::parseSchemaHeader(const nlohmann::json& schemaJson) {
     }
 }
 
-ifstream DataModule::openSchemaFile(const string& schemaPath) {
-    ifstream file(schemaPath);
-    if (!file.is_open()) {
-        throw runtime_error("Failed to open schema file: " + schemaPath);
-    }
-    return file;
+FieldList DataModule::compileFields(const string& section, const nlohmann::json& properties, RowBinding& layout) {
+    FieldList fields = schema->instantiateFields(section, &stringBuffer, [&] {
+        FieldList fields;
+        for (const auto& [name, definition] : properties.items()) {
+            fields.emplace_back(parseField(name, definition));
+        }
+        return fields;
+    });
+    layout = RowBinding(schema->getRowLayout(section), fields);
+    return fields;
 }
 
-unique_ptr<DataModule> DataModule::fromStream(
-    istream& in, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData) {
+unique_ptr<DataHeader> DataModule::createHeader(ModuleType moduleType, EncryptionData encryptionData) {
 
     unique_ptr<DataHeader> dmHeader = make_unique<DataHeader>();
 
@@ -143,8 +147,11 @@ unique_ptr<DataModule> DataModule::fromStream(
     else {
         dmHeader->setEncryptionData(encryptionData);
     }
-    
-    dmHeader->readDataHeader(in);
+    return dmHeader;
+}
+
+unique_ptr<DataModule> DataModule::createFromHeader(
+    unique_ptr<DataHeader> dmHeader, ModuleType moduleType, uint64_t moduleStartOffset) {
 
     unique_ptr<DataModule> dm;
 
@@ -173,13 +180,26 @@ unique_ptr<DataModule> DataModule::fromStream(
 
     dm->header->setModuleStartOffset(moduleStartOffset);
 
-    if (dm->header->getEncryptionData().encryptionType != EncryptionType::NONE) {
+    return dm;
+}
 
-        // Decrypt the data
-        std::istringstream decryptedStream = dm->decryptData(in);
+unique_ptr<DataModule> DataModule::fromStream(
+    istream& in, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData,
+    shared_ptr<const DictionaryTable> dictionaries) {
 
-        dm->readDecryptedMetadataAndData(decryptedStream);
-        
+    unique_ptr<DataHeader> dmHeader = createHeader(moduleType, encryptionData);
+    
+    dmHeader->readDataHeader(in);
+    dmHeader->attachMetadataDictionary(dictionaries.get());
+
+    unique_ptr<DataModule> dm = createFromHeader(std::move(dmHeader), moduleType, moduleStartOffset);
+    if (!dm) {
+        return nullptr;
+    }
+    dm->dictionaries = std::move(dictionaries);
+
+    if (dm->header->getEncryptionData().encryptionType != EncryptionType::NONE) {
+        dm->readSealedSections(in);
     }
     else {
         dm->readDecryptedMetadataAndData(in);
@@ -188,13 +208,117 @@ unique_ptr<DataModule> DataModule::fromStream(
     return dm;
 }
 
-void DataModule::readDecryptedMetadataAndData(istream& in) {
+unique_ptr<DataModule> DataModule::fromStream(
+    span<const byte> bytes, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData,
+    shared_ptr<const DictionaryTable> dictionaries) {
+
+    unique_ptr<DataHeader> dmHeader = createHeader(moduleType, encryptionData);
+
+    dmHeader->readDataHeader(bytes);
+    dmHeader->attachMetadataDictionary(dictionaries.get());
+
+    // Sealed modules record their plaintext sizes, only plain ones can be checked up front
+    if (dmHeader->getEncryptionData().encryptionType == EncryptionType::NONE && dmHeader->getModuleSize() != bytes.size()) {
+        throw std::runtime_error("Module sections do not add up to the module size");
+    }
+
+    unique_ptr<DataModule> dm = createFromHeader(std::move(dmHeader), moduleType, moduleStartOffset);
+    if (!dm) {
+        return nullptr;
+    }
+    dm->dictionaries = std::move(dictionaries);
+
+    span<const byte> body = bytes.subspan(dm->header->getHeaderSize());
+
+    if (dm->header->getEncryptionData().encryptionType != EncryptionType::NONE) {
+
+        // Decrypted bytes are temporary, so they are parsed as a stream rather than viewed
+        ispanstream encryptedStream(span<const char>(reinterpret_cast<const char*>(body.data()), body.size()));
+        dm->readSealedSections(encryptedStream);
+    }
+    else {
+        dm->readDecryptedMetadataAndData(body);
+    }
+
+    return dm;
+}
+
+unique_ptr<DataModule> DataModule::metadataFromStream(
+    istream& in, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData,
+    shared_ptr<const DictionaryTable> dictionaries) {
+
+    unique_ptr<DataHeader> dmHeader = createHeader(moduleType, encryptionData);
+
+    dmHeader->readDataHeader(in);
+    dmHeader->attachMetadataDictionary(dictionaries.get());
+
+    EncryptionData moduleEncryption = dmHeader->getEncryptionData();
+    if (moduleEncryption.encryptionType != EncryptionType::NONE && !moduleEncryption.framesSealed) {
+        // The whole payload is sealed together, so nothing can be trusted
+        // until all of it has been read
+        throw std::runtime_error("Encrypted modules cannot be read incrementally");
+    }
+
+    unique_ptr<DataModule> dm = createFromHeader(std::move(dmHeader), moduleType, moduleStartOffset);
+    if (!dm) {
+        return nullptr;
+    }
+    dm->dictionaries = std::move(dictionaries);
+
+    if (moduleEncryption.encryptionType != EncryptionType::NONE) {
+        // Only the metadata is sealed with the module, the stream is left at the data section
+        std::vector<uint8_t> plaintext = dm->decryptData(in);
+        ispanstream metadataStream(span<const char>(
+            reinterpret_cast<const char*>(plaintext.data()), plaintext.size()));
+
+        dm->readMetadataSection(metadataStream);
+    }
+    else {
+        dm->readMetadataSection(in);
+    }
+
+    return dm;
+}
+
+void DataModule::readMetadataSection(istream& in) {
     if (header->getMetadataCompression() == CompressionType::ZSTD) {
         readCompressedMetadata(in);
     }
     else {
         readStringBufferAndMetadata(in);
     }
+}
+
+void DataModule::readSealedSections(istream& in) {
+
+    if (header->getEncryptionData().framesSealed) {
+        // Only the metadata is in the sealed payload, the frames are opened
+        // straight from in rather than read into one buffer first
+        std::vector<uint8_t> metadata = decryptData(in);
+        ispanstream metadataStream(span<const char>(
+            reinterpret_cast<const char*>(metadata.data()), metadata.size()));
+
+        readMetadataSection(metadataStream);
+        if (header->getDataSize() > 0) {
+            readData(in);
+        }
+        return;
+    }
+
+    // The segments are opened as they are read, the plaintext is parsed whole
+    std::vector<uint8_t> plaintext = decryptData(in);
+    ispanstream decryptedStream(span<const char>(
+        reinterpret_cast<const char*>(plaintext.data()), plaintext.size()));
+
+    readDecryptedMetadataAndData(decryptedStream);
+}
+
+bool DataModule::hasCompressedDataSection() const {
+    return header->getDataCompression() == CompressionType::ZSTD;
+}
+
+void DataModule::readDecryptedMetadataAndData(istream& in) {
+    readMetadataSection(in);
 
 
 
@@ -209,85 +333,134 @@ void DataModule::readDecryptedMetadataAndData(istream& in) {
 
 
         // Handle compression if needed
-        if (header->getDataCompression() == CompressionType::ZSTD) {
+        if (hasCompressedDataSection()) {
             std::vector<uint8_t> decompressedData = ZstdCompressor::decompress(buffer);
 
             // Update the data size with the decompressed data size
             header->setDataSize(decompressedData.size());
 
-            std::istringstream inputStream {
-                std::string(reinterpret_cast<char*>(decompressedData.data()), decompressedData.size())
-            };
+            ispanstream inputStream(span<const char>(
+                reinterpret_cast<const char*>(decompressedData.data()), decompressedData.size()));
 
             readData(inputStream);
         }
         else {
-            std::istringstream inputStream(
-                std::string(reinterpret_cast<char*>(buffer.data()), buffer.size())
-            );
+            ispanstream inputStream(span<const char>(
+                reinterpret_cast<const char*>(buffer.data()), buffer.size()));
             
             readData(inputStream);
         }
     }
 }
 
+void DataModule::readDecryptedMetadataAndData(span<const byte> bytes) {
 
-std::istringstream DataModule::decryptData(istream& in) {
-    // Read in the encrypted data
-    std::vector<uint8_t> encryptedData(header->getDataSize());
+    // Metadata sizes are rewritten while the metadata is parsed, so remember
+    // how many bytes the stored section occupies first
+    uint64_t metadataSectionSize = header->getStringBufferSize() + header->getMetadataSize();
+    if (metadataSectionSize > bytes.size()) {
+        throw std::runtime_error("Failed to read full metadata block");
+    }
 
-    in.read(reinterpret_cast<char*>(encryptedData.data()), encryptedData.size());
+    if (header->getMetadataCompression() == CompressionType::ZSTD) {
+        readCompressedMetadata(bytes.first(metadataSectionSize));
+    }
+    else {
+        ispanstream metadataStream(span<const char>(
+            reinterpret_cast<const char*>(bytes.data()), metadataSectionSize));
+        readStringBufferAndMetadata(metadataStream);
+    }
 
-    if (in.gcount() != static_cast<std::streamsize>(encryptedData.size())) {
-        throw std::runtime_error("Failed to read full data block");
+    if (header->getDataSize() > 0) {
+
+        span<const byte> data = bytes.subspan(metadataSectionSize);
+        if (header->getDataSize() > data.size()) {
+            throw std::runtime_error("Failed to read full data block");
+        }
+        data = data.first(header->getDataSize());
+
+        if (hasCompressedDataSection()) {
+            std::vector<uint8_t> decompressedData = ZstdCompressor::decompress(data);
+
+            // Update the data size with the decompressed data size
+            header->setDataSize(decompressedData.size());
+
+            // The decompressed buffer is temporary, so never hand out views of it
+            ispanstream inputStream(span<const char>(
+                reinterpret_cast<const char*>(decompressedData.data()), decompressedData.size()));
+
+            readData(inputStream);
+        }
+        else {
+            readData(data);
+        }
     }
+}
+
+void DataModule::readData(span<const byte> bytes) {
+    ispanstream inputStream(span<const char>(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    readData(inputStream);
+}
+
+
+std::vector<uint8_t> DataModule::decryptData(istream& in) {
 
     EncryptionData encryptionData = header->getEncryptionData();
 
-    std::vector<uint8_t> combinedSalt;
-    combinedSalt.reserve(encryptionData.baseSalt.size() + encryptionData.moduleSalt.size());
-    combinedSalt.insert(combinedSalt.end(), encryptionData.baseSalt.begin(), encryptionData.baseSalt.end());
-    combinedSalt.insert(combinedSalt.end(), encryptionData.moduleSalt.begin(), encryptionData.moduleSalt.end());
-    
-    // Derive the encryption key using the correct crypto_pwhash function
-    auto derivedKey = EncryptionManager::deriveKeyArgon2id(
-        encryptionData.masterPassword, 
-        combinedSalt,
-        encryptionData.memoryCost, encryptionData.timeCost, encryptionData.parallelism
-    );
-
-    // Decrypt the data
-    std::vector<uint8_t> decryptedData = EncryptionManager::decryptAES256GCM(
-        encryptedData,           
-        derivedKey,              
-        encryptionData.iv,       
-        encryptionData.authTag
-    );
-
-    if (decryptedData.empty()) {
-        throw std::runtime_error("Failed to decrypt data");
+    // Derive the module key from the file's master key
+    auto derivedKey = EncryptionManager::deriveModuleKey(encryptionData);
+
+    uint64_t sizes[3];  // string buffer, metadata and data
+    std::vector<uint8_t> decryptedData;
+
+    if (encryptionData.segmentSize != 0) {
+        // Segmented payload, the section sizes trail the plaintext. With sealed
+        // frames only the metadata is in it and the data section follows as is.
+        uint64_t payloadSize = encryptionData.framesSealed ? header->getMetadataSize() : header->getDataSize();
+
+        decryptedData = EncryptionManager::decryptSegmented(
+            encryptionData.encryptionType, in, payloadSize, derivedKey, encryptionData.iv, encryptionData.segmentSize);
+
+        if (decryptedData.size() < sizeof(sizes)) {
+            throw std::runtime_error("Failed to decrypt data");
+        }
+        size_t trailer = decryptedData.size() - sizeof(sizes);
+        std::memcpy(sizes, decryptedData.data() + trailer, sizeof(sizes));
+        decryptedData.resize(trailer);
     }
-    
-    // Convert the decrypted data to an istream
-    std::istringstream decryptedStream(
-        std::string(reinterpret_cast<const char*>(decryptedData.data()), 
-                    decryptedData.size())
-    );
-
-    // Read in the string buffer and metadata and data sizes
-    uint64_t stringBufferSize, metadataSize, dataSize;
-    decryptedStream.read(reinterpret_cast<char*>(&stringBufferSize), sizeof(uint64_t));
-    decryptedStream.read(reinterpret_cast<char*>(&metadataSize), sizeof(uint64_t));
-    decryptedStream.read(reinterpret_cast<char*>(&dataSize), sizeof(uint64_t));
+    else {
+        // Read in the encrypted data
+        std::vector<uint8_t> encryptedData(header->getDataSize());
 
-    // Set header sizes
-    header->setStringBufferSize(stringBufferSize);
-    header->setMetadataSize(metadataSize);
-    header->setDataSize(dataSize);
+        in.read(reinterpret_cast<char*>(encryptedData.data()), encryptedData.size());
+
+        if (in.gcount() != static_cast<std::streamsize>(encryptedData.size())) {
+            throw std::runtime_error("Failed to read full data block");
+        }
 
+        // Decrypt the data
+        decryptedData = EncryptionManager::decryptAES256GCM(
+            encryptedData,           
+            derivedKey,              
+            encryptionData.iv,       
+            encryptionData.authTag
+        );
+
+        if (decryptedData.size() < sizeof(sizes)) {
+            throw std::runtime_error("Failed to decrypt data");
+        }
 
+        // Single sealed payloads lead with the section sizes
+        std::memcpy(sizes, decryptedData.data(), sizeof(sizes));
+        decryptedData.erase(decryptedData.begin(), decryptedData.begin() + sizeof(sizes));
+    }
+
+    // Set header sizes
+    header->setStringBufferSize(sizes[0]);
+    header->setMetadataSize(sizes[1]);
+    header->setDataSize(sizes[2]);
 
-    return decryptedStream;
+    return decryptedData;
 }
 
 
@@ -299,12 +472,16 @@ void DataModule::readCompressedMetadata(istream& in) {
         throw std::runtime_error("Failed to read full metadata block");
     }
 
+    readCompressedMetadata(as_bytes(span(buffer)));
+}
+
+void DataModule::readCompressedMetadata(span<const byte> compressed) {
+
     // Decompress the metadata
-    std::vector<uint8_t> compressedData = ZstdCompressor::decompress(buffer);
+    std::vector<uint8_t> decompressedData = ZstdCompressor::decompress(compressed, header->getMetadataDictionary().get());
 
-    std::istringstream inputStream {
-        std::string(reinterpret_cast<char*>(compressedData.data()), compressedData.size())
-    };
+    ispanstream inputStream(span<const char>(
+        reinterpret_cast<const char*>(decompressedData.data()), decompressedData.size()));
 
     // Read the string buffer and metadata sizes
     uint64_t stringBufferSize;
@@ -339,9 +516,8 @@ void DataModule::readStringBufferAndMetadata(istream& in) {
         if (header->getMetadataCompression() != CompressionType::RAW) {
         }
 
-        std::istringstream inputStream(
-            std::string(reinterpret_cast<char*>(buffer.data()), buffer.size())
-        );
+        ispanstream inputStream(span<const char>(
+            reinterpret_cast<const char*>(buffer.data()), buffer.size()));
 
         readMetadataRows(inputStream);
     }
@@ -387,89 +563,39 @@ size_t calcRowSize(const std::vector<uint8_t>& bitmap,
 }
 
 void DataModule::readTableRows(
-    istream& in, size_t dataSize, vector<unique_ptr<DataField>>& fields, 
+    istream& in, size_t dataSize, const RowBinding& layout, 
     vector<std::vector<uint8_t>>& rows) {
 
-    // Build flattened field list including nested fields
-    std::vector<std::pair<std::string, DataField*>> flattenedFields;
-    
-    for (const auto& field : fields) {
-        if (auto* objectField = dynamic_cast<ObjectField*>(field.get())) {
-            // Add nested fields with dot notation
-            const auto& nestedFields = objectField->getNestedFields();
-            for (const auto& nestedField : nestedFields) {
-                std::string fieldPath = field->getName() + "." + nestedField->getName();
-                flattenedFields.push_back({fieldPath, nestedField.get()});
-            }
-        } else {
-            // Regular field
-            flattenedFields.push_back({field->getName(), field.get()});
-        }
-    }
-    
-    size_t numFlattenedFields = flattenedFields.size();
-    size_t bitmapSize = (numFlattenedFields + 7) / 8;
-
-
-    
-
+    const CompiledRowLayout& rowLayout = *layout.layout;
+    size_t bitmapSize = rowLayout.getBitmapSize();
 
     size_t bytesRemaining = dataSize;
+    std::vector<uint8_t> bitmap(bitmapSize);
 
     while (bytesRemaining > 0) {
         // Read bitmap for all fields (including nested)
-        std::vector<uint8_t> bitmap(bitmapSize);
         in.read(reinterpret_cast<char*>(bitmap.data()), bitmapSize);
         if (in.gcount() != static_cast<std::streamsize>(bitmapSize)) {
             throw std::runtime_error("Truncated bitmap");
         }
-        
-        // Calculate row size based on which fields are present
-        size_t rowSize = bitmapSize;
-        for (size_t i = 0; i < numFlattenedFields; ++i) {
-            bool present = bitmap[i / 8] & (1 << (i % 8));
-            if (present) {
-                const auto& [fieldPath, fieldPtr] = flattenedFields[i];
-                rowSize += fieldPtr->getLength();
-            }
-        }
-        
-
-        
-        // Start a row with the bitmap
-        std::vector<uint8_t> row(rowSize);
 
-        // Start writing at position 0
-        size_t writePos = 0;
+        // Present fields follow the bitmap back to back, read them in one go
+        std::vector<uint8_t> row(rowLayout.rowSize(bitmap.data()));
         memcpy(row.data(), bitmap.data(), bitmapSize);
-        writePos += bitmapSize;
-
-        // Read each present field (including nested)
-        for (size_t i = 0; i < numFlattenedFields; ++i) {
-            bool present = bitmap[i / 8] & (1 << (i % 8));
-            if (present) {
-                const auto& [fieldPath, fieldPtr] = flattenedFields[i];
-                size_t fieldLen = fieldPtr->getLength();
-                
-                in.read(reinterpret_cast<char*>(row.data() + writePos), fieldLen);
-
-                if (in.gcount() != static_cast<std::streamsize>(fieldLen)) {
-                    throw std::runtime_error("Failed to read full field from stream");
-                }
-                
-                writePos += fieldLen;
-            }
+
+        size_t fieldBytes = row.size() - bitmapSize;
+        in.read(reinterpret_cast<char*>(row.data() + bitmapSize), fieldBytes);
+        if (in.gcount() != static_cast<std::streamsize>(fieldBytes)) {
+            throw std::runtime_error("Failed to read full field from stream");
         }
 
         bytesRemaining -= row.size();
         rows.push_back(std::move(row));
     }
-
-    
 }
 
 void DataModule::readMetadataRows(istream& in) {
-    readTableRows(in, header->getMetadataSize(), metaDataFields, metaDataRows);
+    readTableRows(in, header->getMetadataSize(), metaDataLayout, metaDataRows);
 }
 
 unique_ptr<DataField> DataModule::parseField(const string& name,
@@ -481,10 +607,15 @@ unique_ptr<DataField> DataModule::parseField(const string& name,
         
         // Keep the resolved path on the resolver's stack while we parse the referenced schema
         std::string fullPath = SchemaResolver::beginReference(refPath, header->getSchemaPath());
-        nlohmann::json resolvedDef = SchemaResolver::getSchemaByResolvedPath(fullPath);
-        auto field = parseField(name, resolvedDef);
-        SchemaResolver::endReference();
-        return field;
+        try {
+            shared_ptr<const CompiledSchema> resolved = SchemaRegistry::shared().get(fullPath);
+            auto field = parseField(name, resolved->getJson());
+            SchemaResolver::endReference();
+            return field;
+        } catch (...) {
+            SchemaResolver::endReference();
+            throw;
+        }
     }
 
     string type = definition.contains("type") ? definition["type"] : "string";
@@ -626,6 +757,24 @@ unique_ptr<DataField> DataModule::parseField(const string& name,
 void DataModule::writeBinary(std:: streampos absoluteModuleStart, 
     std::ostream& out, XRefTable& xref, std::string author) {
 
+    streampos moduleStart = beginBinary(absoluteModuleStart, out, xref, author);
+
+    if (header->getModuleType() != ModuleType::Frame && header->getEncryptionData().encryptionType != EncryptionType::NONE) {
+        // Encrypted, compression is handled by the section writers
+        encryptModule(out);
+    }
+    else {
+        // Not encrypted
+        writeMetadataSection(out);
+        writeData(out);
+    }
+
+    finishBinary(moduleStart, out, xref);
+}
+
+streampos DataModule::beginBinary(std::streampos absoluteModuleStart, std::ostream& out,
+    const XRefTable& xref, const std::string& author) {
+
     if (author.empty()) {
         throw runtime_error("Author is empty");
     }
@@ -653,48 +802,28 @@ void DataModule::writeBinary(std:: streampos absoluteModuleStart,
     // Write header
     header->writeToFile(out);
 
-    if (header->getModuleType() != ModuleType::Frame && header->getEncryptionData().encryptionType != EncryptionType::NONE) {
-        // Encrypted
-        if (header->getMetadataCompression() == CompressionType::ZSTD) {
-
-            std::stringstream metadataBuffer;
-            writeCompressedMetadata(metadataBuffer);
-
-            std::stringstream dataBuffer;
-            writeData(dataBuffer); // Compression handled in writeData
-
-            encryptModule(metadataBuffer, dataBuffer, out);
-            
-        }
-        else {
-
-            // Encrypted but metadata not compressed
-            std::stringstream metadataBuffer;
-            writeStringBuffer(metadataBuffer);
-            writeMetaData(metadataBuffer);
-
-            std::stringstream dataBuffer;
-            writeData(dataBuffer);
-
-
+    return moduleStart;
+}
 
-            encryptModule(metadataBuffer, dataBuffer, out);
-        }
+void DataModule::writeMetadataSection(std::ostream& out) {
+    if (header->getMetadataCompression() == CompressionType::ZSTD) {
+        // Compressed but not encrypted
+        writeCompressedMetadata(out);
     }
     else {
-        // Not encrypted
-        if (header->getMetadataCompression() == CompressionType::ZSTD) {
-            // Compressed but not encrypted
-            writeCompressedMetadata(out);
-        }
-        else {
-            // Not compressed or encrypted
-            // Write String Buffer
-            writeStringBuffer(out);
-            // Write Metadata
-            writeMetaData(out);
-        }
-        writeData(out);
+        // Not compressed or encrypted
+        // Write String Buffer
+        writeStringBuffer(out);
+        // Write Metadata
+        writeMetaData(out);
+    }
+}
+
+void DataModule::finishBinary(std::streampos moduleStart, std::ostream& out, XRefTable& xref) {
+
+    // Nothing is recorded for a module that did not make it to the stream
+    if (!out) {
+        throw std::runtime_error("Failed to write module");
     }
 
     streampos moduleEnd = out.tellp();
@@ -726,7 +855,23 @@ void DataModule::writeBinary(std:: streampos absoluteModuleStart,
         header->getSchemaPath());
 }
 
-void DataModule::writeCompressedMetadata(std::ostream& metadataStream) {
+void DataModule::applyCompressionPolicy(const CompressionPolicy& policy) {
+    header->setMetadataZstd(policy.get(header->getModuleType(), CompressionSection::Metadata));
+    header->setDataZstd(policy.find(header->getModuleType(), CompressionSection::Data).value_or(getDefaultDataZstd()));
+}
+
+void DataModule::setMetadataDictionary(shared_ptr<const ZstdDictionary> dictionary) {
+    header->setMetadataDictionary(std::move(dictionary));
+}
+
+void DataModule::collectMetadataSamples(vector<vector<uint8_t>>& samples) {
+    std::stringstream block;
+    writeMetadataBlock(block);
+    std::string_view bytes = block.view();
+    samples.emplace_back(bytes.begin(), bytes.end());
+}
+
+void DataModule::writeMetadataBlock(std::ostream& out) {
 
     uint64_t stringBufferSize = stringBuffer.getSize();
     uint64_t metadataSize = 0;
@@ -734,26 +879,26 @@ void DataModule::writeCompressedMetadata(std::ostream& metadataStream) {
         metadataSize += row.size();
     }
 
-    // Create a buffer and write metadata and stringBuffer sizes
-    std::stringstream buffer;
-    
-    buffer.write(reinterpret_cast<const char*>(&stringBufferSize), sizeof(stringBufferSize));
-    buffer.write(reinterpret_cast<const char*>(&metadataSize), sizeof(metadataSize));
+    out.write(reinterpret_cast<const char*>(&stringBufferSize), sizeof(stringBufferSize));
+    out.write(reinterpret_cast<const char*>(&metadataSize), sizeof(metadataSize));
     
     // Write string buffer and metadata to buffer
-    writeStringBuffer(buffer);
-    writeMetaData(buffer);
+    writeStringBuffer(out);
+    writeMetaData(out);
+}
 
-    // Convert to bytes
-    std::vector<uint8_t> dataBytes {
-        std::istreambuf_iterator<char>(buffer),
-        std::istreambuf_iterator<char>()
-    };
+void DataModule::writeCompressedMetadata(std::ostream& metadataStream) {
+
+    std::stringstream buffer;
+    writeMetadataBlock(buffer);
 
-    // Compress the buffer
-    std::vector<uint8_t> compressedData = ZstdCompressor::compress(dataBytes);
+    // Compress straight out of the buffer
+    std::string_view dataBytes = buffer.view();
+    std::vector<uint8_t> compressedData(ZstdCompressor::compressBound(dataBytes.size()));
 
-    size_t compressedDataSize = compressedData.size();
+    size_t compressedDataSize = ZstdCompressor::compressInto(
+        as_bytes(span(dataBytes)), as_writable_bytes(span(compressedData)),
+        header->getMetadataZstd(), header->getMetadataDictionary().get());
 
     // Write the compressed data to the output stream
     metadataStream.write(reinterpret_cast<const char*>(compressedData.data()), compressedDataSize);
@@ -763,75 +908,81 @@ void DataModule::writeCompressedMetadata(std::ostream& metadataStream) {
     header->setMetadataSize(compressedDataSize);
 }
 
-void DataModule::encryptModule(std::stringstream& metadataStream,
-    std::stringstream& dataStream,
-    std::ostream& out) 
-{
-    std::vector<uint8_t> encryptionBuffer;
+void DataModule::encryptModule(std::ostream& out) {
 
-    uint64_t stringBufferSize = header->getStringBufferSize();
-    uint64_t metadataSize     = header->getMetadataSize();
-    uint64_t dataSize         = header->getDataSize();
+    // Encryption parameters
+    EncryptionData encryptionData = header->getEncryptionData();
 
-    // Pre-allocate
-    encryptionBuffer.reserve(sizeof(uint64_t) * 3 + stringBufferSize + metadataSize + dataSize);
+    auto derivedKey = EncryptionManager::deriveModuleKey(encryptionData);
 
-    auto appendUint64 = [&](uint64_t value) {
-    uint8_t buf[sizeof(uint64_t)];
-    std::memcpy(buf, &value, sizeof(value));
-    encryptionBuffer.insert(encryptionBuffer.end(), buf, buf + sizeof(value));
+    // Section sizes go after the plaintext, so the final segment carries them
+    auto sectionSizes = [&]() {
+        return std::array<uint64_t, 3>{
+            header->getStringBufferSize(),
+            header->getMetadataSize(),
+            header->getDataSize()
+        };
     };
 
-    // Append sizes
-    appendUint64(stringBufferSize);
-    appendUint64(metadataSize);
-    appendUint64(dataSize);
+    if (encryptionData.framesSealed) {
+        // The data section already holds sealed frames and follows the sealed
+        // metadata, whose trailer needs the data size. Only the metadata is
+        // buffered, space is left for it and it is sealed once the data is out.
+        std::stringstream metadataBuffer;
+        writeMetadataSection(metadataBuffer);
+        std::string_view metadata = metadataBuffer.view();
 
-    // Append actual metadata and data streams
-    std::string metaStr = metadataStream.str();
-    std::string dataStr = dataStream.str();
-    encryptionBuffer.insert(encryptionBuffer.end(), metaStr.begin(), metaStr.end());
-    encryptionBuffer.insert(encryptionBuffer.end(), dataStr.begin(), dataStr.end());
+        uint64_t sealedSize = EncryptionManager::segmentedSize(
+            metadata.size() + sizeof(uint64_t) * 3, encryptionData.segmentSize);
+        streampos sealedStart = out.tellp();
+        std::vector<char> placeholder(sealedSize);
+        out.write(placeholder.data(), placeholder.size());
 
-    // Encryption parameters
-    EncryptionData encryptionData = header->getEncryptionData();
+        writeData(out);
+        streampos dataEnd = out.tellp();
+        auto sizes = sectionSizes();
+
+        out.seekp(sealedStart);
+        SegmentedEncryptor encryptor(out, encryptionData.encryptionType, std::move(derivedKey),
+            encryptionData.iv, encryptionData.segmentSize);
+        encryptor.write(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(metadata.data()), metadata.size()));
+        encryptor.write(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(sizes.data()), sizeof(sizes)));
+        uint64_t encryptedSize = encryptor.finish();
+        out.seekp(dataEnd);
+
+        if (encryptedSize != sealedSize) {
+            throw std::runtime_error("Sealed metadata does not fit the space left for it");
+        }
 
-    std::vector<uint8_t> combinedSalt;
-    combinedSalt.reserve(encryptionData.baseSalt.size() + encryptionData.moduleSalt.size());
-    combinedSalt.insert(combinedSalt.end(), encryptionData.baseSalt.begin(), encryptionData.baseSalt.end());
-    combinedSalt.insert(combinedSalt.end(), encryptionData.moduleSalt.begin(), encryptionData.moduleSalt.end());
-
-    auto derivedKey = EncryptionManager::deriveKeyArgon2id(
-    encryptionData.masterPassword, 
-    combinedSalt,
-    encryptionData.memoryCost,
-    encryptionData.timeCost,
-    encryptionData.parallelism
-    );
-
-    // Encrypt the entire buffer
-    std::vector<uint8_t> encryptedData = EncryptionManager::encryptAES256GCM(
-    encryptionBuffer,
-    derivedKey,
-    encryptionData.iv,
-    encryptionData.authTag
-    );
-
-    // Update encryption data back into header
-    header->setEncryptionData(encryptionData);
+        header->setStringBufferSize(0);
+        header->setMetadataSize(encryptedSize);
+        return;
+    }
+
+    // Serialise the sections straight into the encryptor, one segment at a time
+    SegmentedEncryptor encryptor(out, encryptionData.encryptionType, std::move(derivedKey),
+        encryptionData.iv, encryptionData.segmentSize);
+    SegmentedEncryptorBuffer sealedBuffer(encryptor);
+    std::ostream sealed(&sealedBuffer);
+    sealed.exceptions(std::ios::badbit);
+
+    writeMetadataSection(sealed);
+    writeData(sealed);
+
+    auto sizes = sectionSizes();
+    sealed.write(reinterpret_cast<const char*>(sizes.data()), sizeof(sizes));
 
-    // Write encrypted data to output
-    out.write(reinterpret_cast<const char*>(encryptedData.data()), encryptedData.size());
+    uint64_t encryptedSize = encryptor.finish();
 
     // Update header sizes (only encrypted payload is stored now)
     header->setStringBufferSize(0);
     header->setMetadataSize(0);
-    header->setDataSize(encryptedData.size());
+    header->setDataSize(encryptedSize);
 }
 
 
 void DataModule::addTableData(
-    const nlohmann::json& data, vector<unique_ptr<DataField>>& fields, 
+    const nlohmann::json& data, const RowBinding& layout, 
     vector<vector<uint8_t>>& rows, vector<std::string>& requiredFields) {
 
     for (const auto& field : requiredFields) {
@@ -841,59 +992,46 @@ void DataModule::addTableData(
     }
     
     // Validate object fields' required subfields before flattening
-    for (const auto& fieldPtrTop : fields) {
-        if (auto* objectField = dynamic_cast<ObjectField*>(fieldPtrTop.get())) {
-            const std::string& objName = objectField->getName();
-            if (!data.contains(objName) || !data.at(objName).is_object()) {
-                throw std::runtime_error("Invalid value for field: " + objName);
-            }
-            if (!objectField->validateValue(data.at(objName))) {
-                throw std::runtime_error("Invalid value for field: " + objName);
-            }
-        }
-    }
-    
-    // Build flattened field list including nested fields
-    std::vector<std::pair<std::string, DataField*>> flattenedFields;
-    
-    for (const auto& field : fields) {
-        if (auto* objectField = dynamic_cast<ObjectField*>(field.get())) {
-            // Add nested fields with dot notation
-            const auto& nestedFields = objectField->getNestedFields();
-            for (const auto& nestedField : nestedFields) {
-                std::string fieldPath = field->getName() + "." + nestedField->getName();
-                flattenedFields.push_back({fieldPath, nestedField.get()});
-            }
-        } else {
-            // Regular field
-            flattenedFields.push_back({field->getName(), field.get()});
+    for (ObjectField* objectField : layout.objects) {
+        const std::string& objName = objectField->getName();
+        auto it = data.find(objName);
+        if (it == data.end() || !it->is_object() || !objectField->validateValue(*it)) {
+            throw std::runtime_error("Invalid value for field: " + objName);
         }
     }
     
-    size_t numFlattenedFields = flattenedFields.size();
+    const CompiledRowLayout& rowLayout = *layout.layout;
+    const auto& slots = rowLayout.getSlots();
+    size_t bitmapSize = rowLayout.getBitmapSize();
 
-    size_t bitmapSize = (numFlattenedFields + 7) / 8;
-    
-    // Build bitmap for all fields (including nested)
+    // Look up each slot's value once, null when the field is absent
+    std::vector<const nlohmann::json*> values(slots.size(), nullptr);
     std::vector<uint8_t> bitmap(bitmapSize, 0);
-    
-    for (size_t i = 0; i < numFlattenedFields; ++i) {
-        const auto& [fieldPath, fieldPtr] = flattenedFields[i];
-        bool present = fieldExistsInData(data, fieldPath);
-        if (present) {
-            bitmap[i / 8] |= (1 << (i % 8));
+    size_t rowSize = bitmapSize;
+
+    const nlohmann::json* parent = nullptr;
+    size_t parentField = CompiledRowLayout::npos;
+
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const auto& slot = slots[i];
+        const nlohmann::json* scope = &data;
+        if (slot.nested != CompiledRowLayout::npos) {
+            // Object values were checked above, slots of one object are adjacent
+            if (slot.field != parentField) {
+                parentField = slot.field;
+                parent = &data.at(slot.key);
+            }
+            scope = parent;
         }
-    }
-    
-    // Calculate row size including nested objects
-    size_t maxRowSize = 0;
-    for (const auto& [fieldPath, fieldPtr] : flattenedFields) {
-        if (fieldExistsInData(data, fieldPath)) {
-            maxRowSize += fieldPtr->getLength();
+        auto it = scope->find(slot.nested == CompiledRowLayout::npos ? slot.key : slot.child);
+        if (it != scope->end() && !it->is_null()) {
+            values[i] = &*it;
+            bitmap[i / 8] |= (1 << (i % 8));
+            rowSize += slot.length;
         }
     }
     
-    vector<uint8_t> row(bitmapSize + maxRowSize, 0);
+    vector<uint8_t> row(rowSize, 0);
     
     // Write in the bitmap at the start of the row
     memcpy(row.data(), bitmap.data(), bitmapSize);
@@ -901,61 +1039,31 @@ void DataModule::addTableData(
     size_t offset = bitmapSize;
     
     // Encode all fields (including nested)
-    for (const auto& [fieldPath, fieldPtr] : flattenedFields) {
-        if (fieldExistsInData(data, fieldPath)) {
-            nlohmann::json value = getNestedValue(data, fieldPath);
-            if (!fieldPtr->validateValue(value)) {
-                throw std::runtime_error("Invalid value for field: " + fieldPath);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (values[i]) {
+            DataField* field = layout.fields[i];
+            if (!field->validateValue(*values[i])) {
+                throw std::runtime_error("Invalid value for field: " + slots[i].path);
             }
-            fieldPtr->encodeToBuffer(value, row, offset);
-            offset += fieldPtr->getLength();
+            field->encodeToBuffer(*values[i], row, offset);
+            offset += slots[i].length;
         }
     }
     
-    row.resize(offset);
     rows.push_back(std::move(row));
 }
 
-bool DataModule::fieldExistsInData(const nlohmann::json& data, const std::string& fieldPath) {
-    // Handle "image_structure.dimensions" -> data["image_structure"]["dimensions"]
-    size_t dotPos = fieldPath.find('.');
-    if (dotPos == std::string::npos) {
-        return data.contains(fieldPath) && !data[fieldPath].is_null();
-    }
-    
-    std::string parentField = fieldPath.substr(0, dotPos);
-    std::string childField = fieldPath.substr(dotPos + 1);
-    
-    if (!data.contains(parentField) || !data[parentField].is_object()) {
-        return false;
-    }
-    
-    return data[parentField].contains(childField) && !data[parentField][childField].is_null();
-}
-
-nlohmann::json DataModule::getNestedValue(const nlohmann::json& data, const std::string& fieldPath) {
-    size_t dotPos = fieldPath.find('.');
-    if (dotPos == std::string::npos) {
-        return data[fieldPath];
-    }
-    
-    std::string parentField = fieldPath.substr(0, dotPos);
-    std::string childField = fieldPath.substr(dotPos + 1);
-    
-    return data[parentField][childField];
-}
-
 
 void DataModule::addMetaData(const nlohmann::json& data) {
 
     if (data.is_array()) {
         // Handle array of metadata rows
         for (const auto& row : data) {
-            addTableData(row, metaDataFields, metaDataRows, metadataRequired);
+            addTableData(row, metaDataLayout, metaDataRows, metadataRequired);
         }
     } else {
         // Handle single metadata row (backward compatibility)
-        addTableData(data, metaDataFields, metaDataRows, metadataRequired);
+        addTableData(data, metaDataLayout, metaDataRows, metadataRequired);
     }
 }
 
@@ -968,72 +1076,66 @@ ModuleData DataModule::getModuleData() const {
     };
 }
 
+ModuleFootprint DataModule::getFootprint() const {
+
+    ModuleFootprint footprint;
+    footprint.encodedBytes = stringBuffer.getSize();
+    for (const auto& row : metaDataRows) {
+        footprint.encodedBytes += row.size();
+    }
+    return footprint;
+}
+
 nlohmann::json DataModule::getTableDataAsJson(
     const vector<std::string>& requiredFields,
     const vector<vector<uint8_t>>& rows, 
-    const vector<unique_ptr<DataField>>& fields) const {
+    const RowBinding& layout) const {
 
     nlohmann::json dataArray = nlohmann::json::array();
 
-    // Build flattened field list including nested fields (same logic as readTableRows)
-    std::vector<std::pair<std::string, DataField*>> flattenedFields;
-    
-    // Also keep track of the original field structure for reconstruction
-    std::vector<std::pair<std::string, std::string>> fieldMapping; // parentField, childField
-    
-    for (const auto& field : fields) {
-        if (auto* objectField = dynamic_cast<ObjectField*>(field.get())) {
-            // Add nested fields with dot notation for bitmap calculation
-            const auto& nestedFields = objectField->getNestedFields();
-            for (const auto& nestedField : nestedFields) {
-                std::string fieldPath = field->getName() + "." + nestedField->getName();
-                flattenedFields.push_back({fieldPath, nestedField.get()});
-                fieldMapping.push_back({field->getName(), nestedField->getName()});
-            }
-        } else {
-            // Regular field
-            flattenedFields.push_back({field->getName(), field.get()});
-            fieldMapping.push_back({field->getName(), ""}); // Empty string means no parent
-        }
-    }
-    
-    size_t numFlattenedFields = flattenedFields.size();
-    size_t bitmapSize = (numFlattenedFields + 7) / 8;
+    const CompiledRowLayout& rowLayout = *layout.layout;
+    const auto& slots = rowLayout.getSlots();
     
     for (const auto& row : rows) {
-        size_t offset = 0;
+        if (row.size() < rowLayout.getBitmapSize()) {
+            throw std::runtime_error("Row buffer too small to contain bitmap");
+        }
 
         // Read bitmap from start of row
-        std::vector<uint8_t> bitmap(bitmapSize);
-        memcpy(bitmap.data(), row.data(), bitmapSize);
-        offset += bitmapSize;
+        const uint8_t* bitmap = row.data();
+        bool full = rowLayout.isFull(bitmap);
+        size_t offset = rowLayout.getBitmapSize();
 
         nlohmann::json rowJson = nlohmann::json::object();
+        nlohmann::json* parent = nullptr;
+        size_t parentField = CompiledRowLayout::npos;
 
-        for (size_t i = 0; i < numFlattenedFields; ++i) {
-            bool present = bitmap[i / 8] & (1 << (i % 8));
-            if (present) {
-                const auto& [fieldPath, fieldPtr] = flattenedFields[i];
-                const auto& [parentField, childField] = fieldMapping[i];
-                
-                if (childField.empty()) {
-                    // Regular field - add directly to row
-                    rowJson[parentField] = fieldPtr->decodeFromBuffer(row, offset);
-                } else {
-                    // Nested field - create parent object if it doesn't exist
-                    if (!rowJson.contains(parentField)) {
-                        rowJson[parentField] = nlohmann::json::object();
-                    }
-                    rowJson[parentField][childField] = fieldPtr->decodeFromBuffer(row, offset);
-                }
-                offset += fieldPtr->getLength();
+        for (size_t i = 0; i < slots.size(); ++i) {
+            // Missing fields are skipped to keep the output clean
+            if (!full && !rowLayout.isPresent(bitmap, i)) {
+                continue;
+            }
+            const auto& slot = slots[i];
+            if (full) {
+                offset = slot.fixedOffset;
+            }
+
+            if (slot.nested == CompiledRowLayout::npos) {
+                // Regular field - add directly to row
+                rowJson[slot.key] = layout.fields[i]->decodeFromBuffer(row, offset);
             } else {
-                // Handle missing fields - could set to null or skip entirely
-                // For now, we'll skip missing fields to keep the output clean
+                // Nested field - create parent object on its first present property
+                if (slot.field != parentField) {
+                    parentField = slot.field;
+                    parent = &rowJson[slot.key];
+                    *parent = nlohmann::json::object();
+                }
+                (*parent)[slot.child] = layout.fields[i]->decodeFromBuffer(row, offset);
             }
+            offset += slot.length;
         }
 
-        dataArray.push_back(rowJson);
+        dataArray.push_back(std::move(rowJson));
     }
     for (const auto& row : dataArray) {
         for (const auto& field : requiredFields) {
@@ -1051,7 +1153,7 @@ nlohmann::json DataModule::getTableDataAsJson(
 nlohmann::json DataModule::getMetadataAsJson() const {
     nlohmann::json metadataArray = nlohmann::json::array();
 
-    return getTableDataAsJson(metadataRequired, metaDataRows, metaDataFields);
+    return getTableDataAsJson(metadataRequired, metaDataRows, metaDataLayout);
 }
 
 // Note: Schema caching is now handled by SchemaResolver class
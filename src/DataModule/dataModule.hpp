@@ -7,6 +7,7 @@
 #include "stringBuffer.hpp"
 #include "ModuleData.hpp"
 #include "../Utility/Encryption/encryptionManager.hpp"
+#include "../Utility/Compression/CompressionPolicy.hpp"
 
 #include <vector>
 #include <unordered_map>
@@ -14,7 +15,11 @@
 #include <memory>
 #include <fstream>
 #include <variant>
+#include <span>
+#include <string_view>
+#include <cstddef>
 #include "SchemaResolver.hpp"
+#include "SchemaRegistry.hpp"
 
 struct FieldInfo {
     size_t offset;   
@@ -23,7 +28,18 @@ struct FieldInfo {
     DataField* field;    
 };
 
-using FieldMap = std::unordered_map<std::string, FieldInfo>;
+// Keyed by the slot paths of the row's layout
+using FieldMap = std::unordered_map<std::string_view, FieldInfo>;
+
+// Heap bytes held by a loaded module, split by representation. Encoded bytes
+// are still in their stored form (metadata rows, tabular rows, compressed
+// frames); decoded bytes are pixel data ready to be handed out.
+struct ModuleFootprint {
+    size_t encodedBytes = 0;
+    size_t decodedBytes = 0;
+
+    size_t total() const { return encodedBytes + decodedBytes; }
+};
 
 class DataModule {
 protected:
@@ -31,10 +47,15 @@ protected:
 
     std::unique_ptr<DataHeader> header;
 
-    nlohmann::json schemaJson;
+    // Dictionaries of the file this module was read from, handed on to frames
+    std::shared_ptr<const DictionaryTable> dictionaries;
+
+    // Shared with every module of the same schema, see SchemaRegistry
+    std::shared_ptr<const CompiledSchema> schema;
     
     StringBuffer stringBuffer;
     std::vector<std::unique_ptr<DataField>> metaDataFields;
+    RowBinding metaDataLayout;
     std::vector<std::vector<uint8_t>> metaDataRows;
     std::vector<std::vector<std::unique_ptr<DataField>>> decodedMetaDataRows;
 
@@ -48,7 +69,7 @@ protected:
     DataModule(const std::string& schemaPath, DataHeader& header);
     
     DataModule(
-        const std::string& schemaPath, const nlohmann::json& schemaJson, UUID uuid, ModuleType type, EncryptionData encryptionData);
+        const std::string& schemaPath, std::shared_ptr<const CompiledSchema> schema, UUID uuid, ModuleType type, EncryptionData encryptionData);
 
     // Initialisation methods
     void initialise();
@@ -61,31 +82,29 @@ protected:
 
     std::unique_ptr<DataField> parseField(const std::string& name, 
                                             const nlohmann::json& definition);
-                                            
-    std::ifstream openSchemaFile(const std::string& schemaPath);
+
+    // Fields of a section's properties, compiled once per schema, see CompiledSchema.
+    // layout is bound to the returned fields.
+    FieldList compileFields(const std::string& section, const nlohmann::json& properties, RowBinding& layout);
 
 
     // Helper functions to avoid code duplication between Metadata and tabular data
     void addTableData(
-        const nlohmann::json&, std::vector<std::unique_ptr<DataField>>&, 
+        const nlohmann::json&, const RowBinding&, 
         std::vector<std::vector<uint8_t>>&, std::vector<std::string>&);
 
 
-    bool fieldExistsInData(const nlohmann::json& data, const std::string& fieldPath);
-    nlohmann::json getNestedValue(const nlohmann::json& data, const std::string& fieldPath);
-
-
     void readTableRows(
             std::istream& in, 
             size_t dataSize, 
-            std::vector<std::unique_ptr<DataField>>& fields, 
+            const RowBinding& layout, 
             std::vector<std::vector<uint8_t>>& rows
         );
     
     nlohmann::json getTableDataAsJson(
         const std::vector<std::string>& requiredFields,
         const std::vector<std::vector<uint8_t>>& rows, 
-        const std::vector<std::unique_ptr<DataField>>& fields) const;
+        const RowBinding& layout) const;
 
     // Write Methods
 
@@ -93,21 +112,54 @@ protected:
     virtual void writeData(std::ostream& out) const = 0;
     void writeStringBuffer(std::ostream& out);
     void writeCompressedMetadata(std::ostream& metadataStream);
+    // Section sizes, string buffer and metadata rows, the input to metadata compression
+    void writeMetadataBlock(std::ostream& out);
     size_t writeTableRows(std::ostream& out, const std::vector<std::vector<uint8_t>>& dataRows) const;
 
-    void encryptModule(std::stringstream& metadataStream, std::stringstream& dataStream, std::ostream& out);
+    // Serialise and seal the metadata and data sections as segments written
+    // straight to out, holding one segment at a time besides the metadata
+    void encryptModule(std::ostream& out);
+
+    // The parts of writeBinary(). beginBinary() stamps and writes the header
+    // and returns where it starts, writeMetadataSection() writes unencrypted
+    // metadata, finishBinary() checks the section sizes, patches the header
+    // and records the module in the xref table.
+    std::streampos beginBinary(std::streampos absoluteModuleStart, std::ostream& out,
+        const XRefTable& xref, const std::string& author);
+    void writeMetadataSection(std::ostream& out);
+    void finishBinary(std::streampos moduleStart, std::ostream& out, XRefTable& xref);
 
     // Read Methods
-    std::istringstream decryptData(std::istream& in);
+    // Decrypts the payload and restores the plaintext section sizes in the header.
+    // Modules with sealed frames stop after the metadata, leaving in at their
+    // data section.
+    std::vector<uint8_t> decryptData(std::istream& in);
+    // Decrypts and parses the sections of an encrypted module from in
+    void readSealedSections(std::istream& in);
 
     virtual void readMetadataRows(std::istream& in);
     virtual void readData(std::istream& in) = 0;
 
+    // ZSTD settings for the data section when the compression policy leaves it open
+    virtual ZstdSettings getDefaultDataZstd() const { return ZstdSettings{}; }
+
+    // True when the whole data section is one ZSTD frame. Modules whose items
+    // carry their own codec, like image frames, opt out.
+    virtual bool hasCompressedDataSection() const;
+
+    // Span overload used when the module is backed by a memory mapping.
+    // Subclasses may keep views into the bytes; the default copies via a stream.
+    virtual void readData(std::span<const std::byte> bytes);
+
     void readCompressedMetadata(std::istream& in);
+    void readCompressedMetadata(std::span<const std::byte> compressed);
+    void readMetadataSection(std::istream& in);
     void readDecryptedMetadataAndData(std::istream& in);
+    void readDecryptedMetadataAndData(std::span<const std::byte> bytes);
 
-    // Helper method to reconstruct metadata from encoded fields
-    nlohmann::json getMetadataAsJson() const;
+    static std::unique_ptr<DataHeader> createHeader(ModuleType moduleType, EncryptionData encryptionData);
+    static std::unique_ptr<DataModule> createFromHeader(
+        std::unique_ptr<DataHeader> dmHeader, ModuleType moduleType, uint64_t moduleStartOffset);
 
     // Virtual method for module-specific data
     virtual std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>> 
@@ -117,8 +169,26 @@ protected:
 public:
     virtual ~DataModule() = default; 
 
+    // Modules whose metadata names a dictionary can only be read with the
+    // dictionary table of their file
+    static std::unique_ptr<DataModule> fromStream(
+        std::istream& in, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData,
+        std::shared_ptr<const DictionaryTable> dictionaries = nullptr);
+
+    // Parse a module directly from memory. Unencrypted RAW frames keep views
+    // into bytes, so the caller must keep the buffer alive as long as the module.
     static std::unique_ptr<DataModule> fromStream(
-        std::istream& in, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData);
+        std::span<const std::byte> bytes, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData,
+        std::shared_ptr<const DictionaryTable> dictionaries = nullptr);
+
+    // Read only the header and metadata, leaving the stream at the start of the
+    // data section so that large modules can be consumed piece by piece
+    static std::unique_ptr<DataModule> metadataFromStream(
+        std::istream& in, uint64_t moduleStartOffset, ModuleType moduleType, EncryptionData encryptionData,
+        std::shared_ptr<const DictionaryTable> dictionaries = nullptr);
+
+    // Helper method to reconstruct metadata from encoded fields
+    nlohmann::json getMetadataAsJson() const;
 
     const nlohmann::json& getSchema() const;
 
@@ -126,12 +196,27 @@ public:
     virtual void addData(const std::variant<nlohmann::json, std::vector<uint8_t>, std::vector<ModuleData>>&) = 0;
     virtual void addMetaData(const nlohmann::json& rowData);
 
+    // Pick the ZSTD settings for this module's sections, call before adding data
+    // so that frames inherit them
+    void applyCompressionPolicy(const CompressionPolicy& policy);
+
+    // Compress metadata against a dictionary, call before adding data so that
+    // frames inherit it. nullptr compresses without one.
+    void setMetadataDictionary(std::shared_ptr<const ZstdDictionary> dictionary);
+
+    // Append the uncompressed metadata blocks this module would write, for
+    // training a dictionary. Images add one block per frame.
+    virtual void collectMetadataSamples(std::vector<std::vector<uint8_t>>& samples);
+
     void writeBinary(std::streampos absoluteModuleStart,
             std::ostream& out, XRefTable& xref, std::string author);
 
     // Template method that handles common functionality
     ModuleData getModuleData() const;
 
+    // Current memory held by the module. Changes as frames are decoded.
+    virtual ModuleFootprint getFootprint() const;
+
     // Public methods to access header information
     UUID getModuleID() const { return header->getModuleID(); }
     ModuleType getModuleType() const { return header->getModuleType(); }
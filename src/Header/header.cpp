@@ -21,6 +21,7 @@ bool Header::writePrimaryHeader(ostream& outfile) {
     if (!getCurrentFilePosition(outfile, offset)) { return false; };
 
     uint32_t size = MAGIC_NUMBER.size();
+    fileVersion = UMDF_VERSION;
 
     // WRITE MAGIC NUMBER
     outfile.write(MAGIC_NUMBER.data(), size);
@@ -100,10 +101,15 @@ std::expected<EncryptionData, std::string> Header::readPrimaryHeader(std::istrea
         return std::unexpected("Failed to parse version");
     }
 
-    if (version.major > UMDF_VERSION.major) {
+    if (!version.is_compatible_with(UMDF_VERSION)) {
         return std::unexpected("Unsupported UMDF version");
     }
 
+    fileVersion = version;
+
+    // 1.0 files ran Argon2id for every module
+    encryptionData.keyScheme = version.minor == 0 ? KeyScheme::PerModuleArgon2id : KeyScheme::MasterKey;
+
     // Read header size
     uint8_t typeId;
     uint32_t length;
@@ -135,6 +141,9 @@ std::expected<EncryptionData, std::string> Header::readPrimaryHeader(std::istrea
             case HeaderFieldType::EncryptionType:
                 if (length != 1) return std::unexpected("Invalid EncryptionType length.");
                 encryptionData.encryptionType = EncryptionManager::decodeEncryptionType(buffer[0]);
+                if (encryptionData.encryptionType == EncryptionType::UNKNOWN) {
+                    return std::unexpected("Unsupported EncryptionType: " + std::to_string(static_cast<uint8_t>(buffer[0])));
+                }
                 break;
 
             case HeaderFieldType::BaseSalt:
@@ -168,4 +177,14 @@ std::expected<EncryptionData, std::string> Header::readPrimaryHeader(std::istrea
     }
 
     return encryptionData;
-}
\ No newline at end of file
+}
+
+void Header::setEncryptionPassword(std::string password) {
+
+    encryptionData.masterPassword = password;
+    encryptionData.masterKey.reset();
+
+    if (encryptionData.encryptionType != EncryptionType::NONE) {
+        encryptionData.masterKey = EncryptionManager::deriveMasterKey(encryptionData);
+    }
+}
@@ -15,10 +15,12 @@ class Header {
 
 private:
     // Define a magic number and version
-    inline static constexpr Version UMDF_VERSION = Version{1, 0, 0};
-    inline static constexpr std::string_view MAGIC_NUMBER = "#UMDFv1.0\n";
+    // 1.1: module keys derived from a per-file master key
+    inline static constexpr Version UMDF_VERSION = Version{1, 1, 0};
+    inline static constexpr std::string_view MAGIC_NUMBER = "#UMDFv1.1\n";
 
     EncryptionData encryptionData;
+    Version fileVersion = UMDF_VERSION;
 
 public:
     bool writePrimaryHeader(std::ostream& outfile);
@@ -27,7 +29,13 @@ public:
     void setEncryptionData(EncryptionData data) { encryptionData = data; }
     EncryptionData getEncryptionData() const { return encryptionData; }
 
-    void setEncryptionPassword(std::string password) { encryptionData.masterPassword = password; }
+    // Version from the magic line of the file last read, or the current one
+    Version getFileVersion() const { return fileVersion; }
+    // An older minor revision, whose header the current writer cannot extend
+    bool predatesCurrentVersion() const { return fileVersion.minor < UMDF_VERSION.minor; }
+
+    // Also derives the master key, the one Argon2id run per opened file
+    void setEncryptionPassword(std::string password);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "CompressionPolicy.hpp"
+#include "../threadPool.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+CompressionPolicy CompressionPolicy::fromPreset(CompressionPreset preset) {
+
+    switch (preset) {
+        case CompressionPreset::Fastest:
+            return CompressionPolicy(ZstdSettings{ .level = 1 });
+
+        case CompressionPreset::Balanced: {
+            // Metadata blocks are small, so a higher level costs little
+            CompressionPolicy policy(ZstdSettings{ .level = 3 });
+            policy.set(ModuleType::Tabular, CompressionSection::Metadata, ZstdSettings{ .level = 9 });
+            policy.set(ModuleType::Image, CompressionSection::Metadata, ZstdSettings{ .level = 9 });
+            return policy;
+        }
+
+        case CompressionPreset::Smallest: {
+            CompressionPolicy policy(ZstdSettings{ .level = 19 });
+            policy.set(ModuleType::Tabular, CompressionSection::Data, ZstdSettings{
+                .level = 19,
+                .longDistanceMatching = true,
+                .workers = static_cast<int>(ThreadPool::defaultThreadCount())
+            });
+            return policy;
+        }
+    }
+
+    return CompressionPolicy();
+}
+
+CompressionPolicy& CompressionPolicy::set(ModuleType type, CompressionSection section, ZstdSettings zstd) {
+    settings[{ type, section }] = zstd;
+    return *this;
+}
+
+ZstdSettings CompressionPolicy::get(ModuleType type, CompressionSection section) const {
+    auto it = settings.find({ type, section });
+    return it != settings.end() ? it->second : fallback;
+}
+
+optional<ZstdSettings> CompressionPolicy::find(ModuleType type, CompressionSection section) const {
+    auto it = settings.find({ type, section });
+    if (it != settings.end()) {
+        return it->second;
+    }
+    return explicitFallback ? optional(fallback) : nullopt;
+}
+
+optional<CompressionPreset> stringToPreset(const string& str) {
+    string s = str;
+    transform(s.begin(), s.end(), s.begin(), ::tolower);
+    if (s == "fastest")  return CompressionPreset::Fastest;
+    if (s == "balanced") return CompressionPreset::Balanced;
+    if (s == "smallest") return CompressionPreset::Smallest;
+    return nullopt;
+}
+
+string presetToString(CompressionPreset preset) {
+    switch (preset) {
+        case CompressionPreset::Fastest:  return "fastest";
+        case CompressionPreset::Balanced: return "balanced";
+        case CompressionPreset::Smallest: return "smallest";
+        default:                          return "unknown";
+    }
+}
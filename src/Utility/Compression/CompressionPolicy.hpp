@@ -0,0 +1,60 @@
+#ifndef COMPRESSIONPOLICY_HPP
+#define COMPRESSIONPOLICY_HPP
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "ZstdCompressor.hpp"
+#include "../moduleType.hpp"
+
+enum class CompressionPreset : uint8_t {
+    Fastest,  // Level 1 everywhere
+    Balanced, // Cheap data sections, denser metadata
+    Smallest  // Level 19, long-distance matching and workers for data sections
+};
+
+enum class CompressionSection : uint8_t {
+    Metadata, // String buffer and metadata rows
+    Data      // Module data, tabular rows or ZSTD image frames
+};
+
+/**
+ * @brief ZSTD settings chosen per module type and section.
+ * 
+ * Sections without an explicit setting use the fallback, which defaults to
+ * level 15 as before policies existed. Image data is the exception: unless a
+ * fallback or override is given, ZSTD frames keep their codec's own default
+ * level, see find(). The writer applies the policy to each
+ * module it writes and the settings used are recorded in the module header,
+ * so reading a file never depends on the policy it was written with.
+ */
+class CompressionPolicy {
+private:
+    ZstdSettings fallback;
+    bool explicitFallback = false;
+    std::map<std::pair<ModuleType, CompressionSection>, ZstdSettings> settings;
+
+public:
+    CompressionPolicy() = default;
+    explicit CompressionPolicy(ZstdSettings fallback) : fallback(fallback), explicitFallback(true) {}
+
+    static CompressionPolicy fromPreset(CompressionPreset preset);
+
+    // Returns *this so that overrides can be chained onto a preset
+    CompressionPolicy& set(ModuleType type, CompressionSection section, ZstdSettings zstd);
+
+    ZstdSettings get(ModuleType type, CompressionSection section) const;
+
+    // Like get(), but nullopt where neither an override nor a fallback was
+    // given, so that modules can apply their own default there
+    std::optional<ZstdSettings> find(ModuleType type, CompressionSection section) const;
+    const ZstdSettings& getFallback() const { return fallback; }
+};
+
+std::optional<CompressionPreset> stringToPreset(const std::string& str);
+std::string presetToString(CompressionPreset preset);
+
+#endif
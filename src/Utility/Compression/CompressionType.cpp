@@ -9,6 +9,8 @@ std::optional<CompressionType> stringToCompression(const std::string& str) {
         return CompressionType::PNG;
     } else if (str == "ZSTD" || str == "zstd") {
         return CompressionType::ZSTD;
+    } else if (str == "JPEGLS_LOSSLESS" || str == "jpegls-lossless") {
+        return CompressionType::JPEGLS_LOSSLESS;
     }
     return std::nullopt;
 }
@@ -23,6 +25,8 @@ std::string compressionToString(CompressionType compression) {
             return "PNG";
         case CompressionType::ZSTD:
             return "ZSTD";
+        case CompressionType::JPEGLS_LOSSLESS:
+            return "JPEGLS_LOSSLESS";
         default:
             return "UNKNOWN";
     }
@@ -11,13 +11,15 @@ enum class CompressionType : uint8_t {
     JPEG2000_LOSSLESS, // JPEG 2000 lossless compression
     PNG,               // PNG lossless compression
     ZSTD,              // Zstandard compression
+    JPEGLS_LOSSLESS,   // JPEG-LS lossless compression
 };
 
-const std::array<CompressionType, 4> validCompressions = {
+const std::array<CompressionType, 5> validCompressions = {
     CompressionType::RAW,
     CompressionType::JPEG2000_LOSSLESS,
     CompressionType::PNG,
-    CompressionType::ZSTD
+    CompressionType::ZSTD,
+    CompressionType::JPEGLS_LOSSLESS
 };
 
 
@@ -1,4 +1,5 @@
 #include "ZstdCompressor.hpp"
+#include "ZstdDictionary.hpp"
 #include <zstd.h>
 #include <stdexcept>
 #include <sstream>
@@ -7,15 +8,45 @@
 #include <iostream>
 
 // Initialize static variables
-size_t ZstdCompressor::totalCompressions = 0;
-size_t ZstdCompressor::totalDecompressions = 0;
-size_t ZstdCompressor::totalOriginalSize = 0;
-size_t ZstdCompressor::totalCompressedSize = 0;
-int ZstdCompressor::compressionLevel = 0;
+std::atomic<size_t> ZstdCompressor::totalCompressions = 0;
+std::atomic<size_t> ZstdCompressor::totalDecompressions = 0;
+std::atomic<size_t> ZstdCompressor::totalOriginalSize = 0;
+std::atomic<size_t> ZstdCompressor::totalCompressedSize = 0;
+std::atomic<int> ZstdCompressor::compressionLevel = 0;
+
+namespace {
+    // One context of each kind per thread, created on first use. A level 15
+    // compression context alone holds several megabytes of match tables.
+    struct ThreadContexts {
+        ZSTD_CCtx* cctx = nullptr;
+        ZSTD_DCtx* dctx = nullptr;
+
+        ~ThreadContexts() {
+            ZSTD_freeCCtx(cctx);
+            ZSTD_freeDCtx(dctx);
+        }
+
+        ZSTD_CCtx* compression() {
+            if (!cctx && !(cctx = ZSTD_createCCtx())) {
+                throw std::runtime_error("Failed to create ZSTD compression context");
+            }
+            return cctx;
+        }
+
+        ZSTD_DCtx* decompression() {
+            if (!dctx && !(dctx = ZSTD_createDCtx())) {
+                throw std::runtime_error("Failed to create ZSTD decompression context");
+            }
+            return dctx;
+        }
+    };
+
+    thread_local ThreadContexts contexts;
+}
 
 std::vector<uint8_t> ZstdCompressor::compress(const std::vector<uint8_t>& data) {
     // Use higher compression level for better ratios
-    return compressWithLevel(data, 15);  // Changed from ZSTD_CLEVEL_DEFAULT (3) to 15
+    return compressWithLevel(data, DEFAULT_LEVEL);
 }
 
 std::vector<uint8_t> ZstdCompressor::compressWithLevel(const std::vector<uint8_t>& data, int level) {
@@ -23,46 +54,81 @@ std::vector<uint8_t> ZstdCompressor::compressWithLevel(const std::vector<uint8_t
         return {};
     }
     
+    // Calculate maximum compressed size
+    std::vector<uint8_t> compressed(compressBound(data.size()));
+
+    size_t actualCompressedSize = compressInto(
+        std::as_bytes(std::span(data)), std::as_writable_bytes(std::span(compressed)), level);
+    
+    // Resize to actual compressed size
+    compressed.resize(actualCompressedSize);
+    return compressed;
+}
+
+size_t ZstdCompressor::compressInto(std::span<const std::byte> data, std::span<std::byte> out, int level) {
+    return compressInto(data, out, ZstdSettings{ .level = level });
+}
+
+size_t ZstdCompressor::compressInto(std::span<const std::byte> data, std::span<std::byte> out,
+    const ZstdSettings& settings, const ZstdDictionary* dictionary) {
+
     // Validate compression level
+    int level = settings.level;
     if (level < ZSTD_minCLevel() || level > ZSTD_maxCLevel()) {
         throw std::runtime_error("Invalid compression level: " + std::to_string(level) + 
                                " (valid range: " + std::to_string(ZSTD_minCLevel()) + 
                                " to " + std::to_string(ZSTD_maxCLevel()) + ")");
     }
-    
-    // Calculate maximum compressed size
-    size_t maxCompressedSize = ZSTD_compressBound(data.size());
-    std::vector<uint8_t> compressed(maxCompressedSize);
-    
-    // Compress the data
-    size_t actualCompressedSize = ZSTD_compress(
-        compressed.data(), maxCompressedSize,
-        data.data(), data.size(),
-        level
-    );
-    
-    // Check for compression errors
-    if (ZSTD_isError(actualCompressedSize)) {
-        throw std::runtime_error("ZSTD compression failed: " + 
-                               std::string(ZSTD_getErrorName(actualCompressedSize)));
+
+    auto check = [](size_t result) {
+        if (ZSTD_isError(result)) {
+            throw std::runtime_error("ZSTD compression failed: " + 
+                                   std::string(ZSTD_getErrorName(result)));
+        }
+    };
+
+    // Parameters and dictionaries stick to the context, so start each call from the defaults
+    ZSTD_CCtx* cctx = contexts.compression();
+    check(ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters));
+    check(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level));
+
+    if (dictionary) {
+        check(ZSTD_CCtx_refCDict(cctx, dictionary->forCompression(level)));
     }
-    
-    // Resize to actual compressed size
-    compressed.resize(actualCompressedSize);
-    
-    // Always track compression statistics
-    totalCompressions++;
-    totalOriginalSize += data.size();
-    totalCompressedSize += actualCompressedSize;
-    // Track the compression level used (use the highest level if multiple compressions)
-    if (level > compressionLevel) {
-        compressionLevel = level;
+
+    if (settings.longDistanceMatching) {
+        check(ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1));
     }
-    
-    return compressed;
+
+    if (settings.workers > 0) {
+        // A single-threaded libzstd reports an upper bound of 0
+        ZSTD_bounds bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+        if (!ZSTD_isError(bounds.error) && bounds.upperBound > 0) {
+            check(ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, std::min(settings.workers, bounds.upperBound)));
+        }
+    }
+
+    // Compress the data, reusing this thread's context
+    size_t actualCompressedSize = ZSTD_compress2(
+        cctx,
+        out.data(), out.size(),
+        data.data(), data.size()
+    );
+    check(actualCompressedSize);
+
+    recordCompression(data.size(), actualCompressedSize, level);
+    return actualCompressedSize;
+}
+
+size_t ZstdCompressor::compressBound(size_t size) {
+    return ZSTD_compressBound(size);
 }
 
 std::vector<uint8_t> ZstdCompressor::decompress(const std::vector<uint8_t>& compressedData) {
+    return decompress(std::as_bytes(std::span(compressedData)));
+}
+
+std::vector<uint8_t> ZstdCompressor::decompress(std::span<const std::byte> compressedData, const ZstdDictionary* dictionary) {
     if (compressedData.empty()) {
         return {};
     }
@@ -86,17 +152,8 @@ std::vector<uint8_t> ZstdCompressor::decompress(const std::vector<uint8_t>& comp
     // Allocate buffer for decompressed data
     std::vector<uint8_t> decompressed(originalSize);
     
-    // Decompress the data
-    size_t actualDecompressedSize = ZSTD_decompress(
-        decompressed.data(), originalSize,
-        compressedData.data(), compressedData.size()
-    );
-    
-    // Check for decompression errors
-    if (ZSTD_isError(actualDecompressedSize)) {
-        throw std::runtime_error("ZSTD decompression failed: " + 
-                               std::string(ZSTD_getErrorName(actualDecompressedSize)));
-    }
+    size_t actualDecompressedSize = decompressInto(
+        compressedData, std::as_writable_bytes(std::span(decompressed)), dictionary);
     
     // Verify the decompressed size matches expected
     if (actualDecompressedSize != originalSize) {
@@ -105,14 +162,48 @@ std::vector<uint8_t> ZstdCompressor::decompress(const std::vector<uint8_t>& comp
                                std::to_string(actualDecompressedSize));
     }
     
-    // Always track decompression statistics
-    totalDecompressions++;
-    totalOriginalSize += actualDecompressedSize;
-    totalCompressedSize += compressedData.size();
-    
     return decompressed;
 }
 
+size_t ZstdCompressor::decompressInto(std::span<const std::byte> compressedData, std::span<std::byte> out,
+    const ZstdDictionary* dictionary) {
+
+    // Decompress the data, reusing this thread's context. Frames compressed
+    // with a dictionary fail with a dictionary mismatch unless it is given.
+    size_t actualDecompressedSize = ZSTD_decompress_usingDDict(
+        contexts.decompression(),
+        out.data(), out.size(),
+        compressedData.data(), compressedData.size(),
+        dictionary ? dictionary->forDecompression() : nullptr
+    );
+    
+    // Check for decompression errors
+    if (ZSTD_isError(actualDecompressedSize)) {
+        throw std::runtime_error("ZSTD decompression failed: " + 
+                               std::string(ZSTD_getErrorName(actualDecompressedSize)));
+    }
+
+    recordDecompression(actualDecompressedSize, compressedData.size());
+    return actualDecompressedSize;
+}
+
+void ZstdCompressor::recordCompression(size_t originalSize, size_t compressedSize, int level) {
+    totalCompressions.fetch_add(1, std::memory_order_relaxed);
+    totalOriginalSize.fetch_add(originalSize, std::memory_order_relaxed);
+    totalCompressedSize.fetch_add(compressedSize, std::memory_order_relaxed);
+
+    // Track the compression level used (use the highest level if multiple compressions)
+    int highest = compressionLevel.load(std::memory_order_relaxed);
+    while (level > highest && !compressionLevel.compare_exchange_weak(highest, level, std::memory_order_relaxed)) {
+    }
+}
+
+void ZstdCompressor::recordDecompression(size_t originalSize, size_t compressedSize) {
+    totalDecompressions.fetch_add(1, std::memory_order_relaxed);
+    totalOriginalSize.fetch_add(originalSize, std::memory_order_relaxed);
+    totalCompressedSize.fetch_add(compressedSize, std::memory_order_relaxed);
+}
+
 double ZstdCompressor::getCompressionRatio(size_t originalSize, size_t compressedSize) {
     if (originalSize == 0) {
         return 0.0;
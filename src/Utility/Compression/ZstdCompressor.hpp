@@ -3,7 +3,13 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <span>
 #include <string>
+#include <atomic>
+
+struct ZstdSettings;
+class ZstdDictionary;
 
 /**
  * @brief ZSTD compression utility class for header data (metadata + string buffer)
@@ -14,9 +20,15 @@
  * 
  * The class automatically tracks all compression/decompression operations and provides
  * summary statistics when requested.
+ * 
+ * Each thread keeps one compression and one decompression context for its
+ * lifetime, so repeated calls do not reallocate zstd's internal tables. All
+ * methods are safe to call from several threads at once.
  */
 class ZstdCompressor {
 public:
+    static constexpr int DEFAULT_LEVEL = 15;
+
     /**
      * @brief Compress data using ZSTD with default compression level
      * 
@@ -34,6 +46,20 @@ public:
      * @throws std::runtime_error if decompression fails
      */
     static std::vector<uint8_t> decompress(const std::vector<uint8_t>& compressedData);
+
+    /**
+     * @brief Decompress ZSTD compressed data held in a borrowed buffer
+     * 
+     * Lets callers decompress straight out of a memory-mapped file without
+     * first copying the compressed bytes into a vector.
+     * 
+     * @param compressedData View of the compressed data
+     * @param dictionary Dictionary the data was compressed with, if any
+     * @return Decompressed data vector
+     * @throws std::runtime_error if decompression fails
+     */
+    static std::vector<uint8_t> decompress(std::span<const std::byte> compressedData,
+                                           const ZstdDictionary* dictionary = nullptr);
     
     /**
      * @brief Compress data with specified compression level
@@ -44,6 +70,54 @@ public:
      * @throws std::runtime_error if compression fails
      */
     static std::vector<uint8_t> compressWithLevel(const std::vector<uint8_t>& data, int level);
+
+    /**
+     * @brief Compress into a caller-provided buffer
+     * 
+     * Lets callers reuse one output buffer across calls. Sizing the buffer with
+     * compressBound() guarantees that compression cannot run out of space.
+     * 
+     * @param data Raw data to compress
+     * @param out Destination buffer
+     * @param level Compression level (1-22)
+     * @return Number of bytes written to out
+     * @throws std::runtime_error if compression fails or out is too small
+     */
+    static size_t compressInto(std::span<const std::byte> data, std::span<std::byte> out, int level = DEFAULT_LEVEL);
+
+    /**
+     * @brief Compress into a caller-provided buffer with explicit encoder settings
+     * 
+     * Worker threads are only used when the linked zstd library was built
+     * with multithreading support, otherwise compression stays on the calling
+     * thread. The output decompresses with decompress() either way.
+     * 
+     * @param data Raw data to compress
+     * @param out Destination buffer
+     * @param settings Level, long-distance matching and worker count
+     * @param dictionary Dictionary to compress against, needed again to decompress
+     * @return Number of bytes written to out
+     * @throws std::runtime_error if compression fails or out is too small
+     */
+    static size_t compressInto(std::span<const std::byte> data, std::span<std::byte> out,
+                               const ZstdSettings& settings, const ZstdDictionary* dictionary = nullptr);
+
+    /**
+     * @brief Decompress into a caller-provided buffer
+     * 
+     * @param compressedData View of the compressed data
+     * @param out Destination buffer, at least as large as the original data
+     * @param dictionary Dictionary the data was compressed with, if any
+     * @return Number of bytes written to out
+     * @throws std::runtime_error if decompression fails or out is too small
+     */
+    static size_t decompressInto(std::span<const std::byte> compressedData, std::span<std::byte> out,
+                                 const ZstdDictionary* dictionary = nullptr);
+
+    /**
+     * @brief Worst-case compressed size of size bytes
+     */
+    static size_t compressBound(size_t size);
     
     /**
      * @brief Calculate compression ratio
@@ -97,11 +171,28 @@ private:
     ZstdCompressor& operator=(const ZstdCompressor&) = delete;
     
     // Always track statistics
-    static size_t totalCompressions;
-    static size_t totalDecompressions;
-    static size_t totalOriginalSize;
-    static size_t totalCompressedSize;
-    static int compressionLevel;
+    static std::atomic<size_t> totalCompressions;
+    static std::atomic<size_t> totalDecompressions;
+    static std::atomic<size_t> totalOriginalSize;
+    static std::atomic<size_t> totalCompressedSize;
+    static std::atomic<int> compressionLevel;
+
+    static void recordCompression(size_t originalSize, size_t compressedSize, int level);
+    static void recordDecompression(size_t originalSize, size_t compressedSize);
+};
+
+/**
+ * @brief Encoder-side ZSTD parameters
+ * 
+ * Decoders need none of these: every frame records its own window size, and
+ * long-distance matching stays within the window zstd decoders accept by default.
+ */
+struct ZstdSettings {
+    int level = ZstdCompressor::DEFAULT_LEVEL;
+    bool longDistanceMatching = false;
+    int workers = 0; // 0 compresses on the calling thread
+
+    bool operator==(const ZstdSettings&) const = default;
 };
 
 #endif // ZSTDCOMPRESSOR_HPP
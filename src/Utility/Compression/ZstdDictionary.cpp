@@ -0,0 +1,152 @@
+#include "ZstdDictionary.hpp"
+
+#include <zstd.h>
+#include <zdict.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+    constexpr char DICTIONARY_SIGNATURE[4] = { 'D', 'I', 'C', 'T' };
+}
+
+ZstdDictionary::ZstdDictionary(vector<uint8_t> dictionary) : content(std::move(dictionary)) {
+
+    // Raw content dictionaries carry no ID, so frames could not name them
+    id = ZDICT_getDictID(content.data(), content.size());
+    if (id == 0) {
+        throw runtime_error("Not a zstd dictionary");
+    }
+
+    ddict = ZSTD_createDDict(content.data(), content.size());
+    if (!ddict) {
+        throw runtime_error("Failed to create ZSTD decompression dictionary");
+    }
+}
+
+ZstdDictionary::~ZstdDictionary() {
+    for (auto& [level, cdict] : cdicts) {
+        ZSTD_freeCDict(cdict);
+    }
+    ZSTD_freeDDict(ddict);
+}
+
+shared_ptr<const ZstdDictionary> ZstdDictionary::train(const vector<vector<uint8_t>>& samples, size_t capacity) {
+
+    vector<uint8_t> joined;
+    vector<size_t> sizes;
+    sizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        joined.insert(joined.end(), sample.begin(), sample.end());
+        sizes.push_back(sample.size());
+    }
+
+    vector<uint8_t> dictionary(capacity);
+    size_t size = ZDICT_trainFromBuffer(
+        dictionary.data(), dictionary.size(),
+        joined.data(), sizes.data(), static_cast<unsigned>(sizes.size()));
+
+    if (ZDICT_isError(size)) {
+        throw runtime_error("Dictionary training failed: " + string(ZDICT_getErrorName(size)));
+    }
+
+    dictionary.resize(size);
+    return make_shared<const ZstdDictionary>(std::move(dictionary));
+}
+
+const ZSTD_CDict_s* ZstdDictionary::forCompression(int level) const {
+
+    lock_guard<mutex> lock(cdictMutex);
+
+    auto it = cdicts.find(level);
+    if (it != cdicts.end()) {
+        return it->second;
+    }
+
+    ZSTD_CDict* cdict = ZSTD_createCDict(content.data(), content.size(), level);
+    if (!cdict) {
+        throw runtime_error("Failed to create ZSTD compression dictionary");
+    }
+    cdicts.emplace(level, cdict);
+    return cdict;
+}
+
+void DictionaryTable::add(shared_ptr<const ZstdDictionary> dictionary) {
+    dictionaries[dictionary->getID()] = std::move(dictionary);
+}
+
+shared_ptr<const ZstdDictionary> DictionaryTable::find(uint32_t id) const {
+    auto it = dictionaries.find(id);
+    return it != dictionaries.end() ? it->second : nullptr;
+}
+
+uint32_t DictionaryTable::write(ostream& out) const {
+
+    // Signature, count, then (id, size, content) per dictionary
+    out.write(DICTIONARY_SIGNATURE, sizeof(DICTIONARY_SIGNATURE));
+    uint32_t count = static_cast<uint32_t>(dictionaries.size());
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    uint32_t written = sizeof(DICTIONARY_SIGNATURE) + sizeof(count);
+    for (const auto& [id, dictionary] : dictionaries) {
+        const auto& content = dictionary->getContent();
+        uint32_t size = static_cast<uint32_t>(content.size());
+        out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(reinterpret_cast<const char*>(content.data()), size);
+        written += sizeof(id) + sizeof(size) + size;
+    }
+
+    if (!out.good()) {
+        throw runtime_error("Failed to write dictionary table");
+    }
+    return written;
+}
+
+DictionaryTable DictionaryTable::read(istream& in, uint32_t size) {
+
+    vector<char> section(size);
+    in.read(section.data(), section.size());
+    if (in.gcount() != static_cast<streamsize>(section.size())) {
+        throw runtime_error("Truncated dictionary table");
+    }
+
+    size_t pos = 0;
+    auto readFixed = [&](void* dest, size_t length) {
+        if (length > section.size() - pos) {
+            throw runtime_error("Truncated dictionary table");
+        }
+        memcpy(dest, section.data() + pos, length);
+        pos += length;
+    };
+
+    char signature[sizeof(DICTIONARY_SIGNATURE)];
+    readFixed(signature, sizeof(signature));
+    if (memcmp(signature, DICTIONARY_SIGNATURE, sizeof(signature)) != 0) {
+        throw runtime_error("Missing dictionary table signature");
+    }
+
+    uint32_t count;
+    readFixed(&count, sizeof(count));
+
+    DictionaryTable table;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t id;
+        uint32_t length;
+        readFixed(&id, sizeof(id));
+        readFixed(&length, sizeof(length));
+
+        vector<uint8_t> content(length);
+        readFixed(content.data(), length);
+
+        auto dictionary = make_shared<const ZstdDictionary>(std::move(content));
+        if (dictionary->getID() != id) {
+            throw runtime_error("Dictionary ID mismatch in dictionary table");
+        }
+        table.add(std::move(dictionary));
+    }
+
+    return table;
+}
@@ -0,0 +1,100 @@
+#ifndef ZSTDDICTIONARY_HPP
+#define ZSTDDICTIONARY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+/**
+ * @brief A zstd dictionary with its digested compression and decompression forms.
+ * 
+ * Small blocks that share structure, such as module and frame metadata,
+ * compress far better against a dictionary trained on similar blocks. The
+ * digested forms are built once and shared, so a dictionary may be used by
+ * several threads at once.
+ */
+class ZstdDictionary {
+private:
+    std::vector<uint8_t> content;
+    uint32_t id = 0;
+
+    ZSTD_DDict_s* ddict = nullptr;
+
+    // Compression dictionaries are digested for one level each
+    mutable std::mutex cdictMutex;
+    mutable std::map<int, ZSTD_CDict_s*> cdicts;
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16 * 1024;
+
+    /**
+     * @param content Dictionary in zstd format, as produced by train() or zstd --train
+     * @throws std::runtime_error if content is not a zstd dictionary
+     */
+    explicit ZstdDictionary(std::vector<uint8_t> content);
+    ~ZstdDictionary();
+
+    ZstdDictionary(const ZstdDictionary&) = delete;
+    ZstdDictionary& operator=(const ZstdDictionary&) = delete;
+
+    /**
+     * @brief Train a dictionary on sample blocks.
+     * 
+     * @param samples Blocks resembling the data to be compressed
+     * @param capacity Maximum dictionary size in bytes
+     * @throws std::runtime_error if there are too few samples to train on
+     */
+    static std::shared_ptr<const ZstdDictionary> train(
+        const std::vector<std::vector<uint8_t>>& samples, size_t capacity = DEFAULT_CAPACITY);
+
+    // Non-zero identifier stored in the dictionary and in every frame compressed with it
+    uint32_t getID() const { return id; }
+    const std::vector<uint8_t>& getContent() const { return content; }
+
+    const ZSTD_CDict_s* forCompression(int level) const;
+    const ZSTD_DDict_s* forDecompression() const { return ddict; }
+};
+
+/**
+ * @brief The dictionaries of one file, keyed by dictionary ID.
+ * 
+ * Stored as a section of its own that the XREF table points to. Modules name
+ * the dictionary their metadata was compressed with in their header.
+ */
+class DictionaryTable {
+private:
+    std::map<uint32_t, std::shared_ptr<const ZstdDictionary>> dictionaries;
+
+public:
+    // A dictionary with the same ID replaces the one already present
+    void add(std::shared_ptr<const ZstdDictionary> dictionary);
+
+    // Returns nullptr if the table has no dictionary with this ID
+    std::shared_ptr<const ZstdDictionary> find(uint32_t id) const;
+
+    bool empty() const { return dictionaries.empty(); }
+    size_t size() const { return dictionaries.size(); }
+    void clear() { dictionaries.clear(); }
+
+    /**
+     * @brief Write the table as a section.
+     * @return Number of bytes written
+     */
+    uint32_t write(std::ostream& out) const;
+
+    /**
+     * @brief Read a section written by write().
+     * @throws std::runtime_error if the section is malformed
+     */
+    static DictionaryTable read(std::istream& in, uint32_t size);
+};
+
+#endif // ZSTDDICTIONARY_HPP
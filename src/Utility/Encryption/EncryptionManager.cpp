@@ -1,4 +1,5 @@
 #include "encryptionManager.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <mutex>
 #include <iostream>
@@ -62,6 +63,70 @@ std::vector<uint8_t> EncryptionManager::deriveKeyArgon2id(
     return key;
 }
 
+std::shared_ptr<const std::vector<uint8_t>> EncryptionManager::deriveMasterKey(const EncryptionData& encryptionData) {
+
+    if (encryptionData.baseSalt.size() < crypto_pwhash_SALTBYTES) {
+        throw std::runtime_error("Base salt too short");
+    }
+
+    return std::make_shared<const std::vector<uint8_t>>(deriveKeyArgon2id(
+        encryptionData.masterPassword,
+        encryptionData.baseSalt,
+        encryptionData.memoryCost,
+        encryptionData.timeCost,
+        encryptionData.parallelism
+    ));
+}
+
+std::vector<uint8_t> EncryptionManager::deriveModuleKey(const EncryptionData& encryptionData) {
+
+    if (encryptionData.keyScheme == KeyScheme::PerModuleArgon2id) {
+        // crypto_pwhash only reads crypto_pwhash_SALTBYTES of the salt, which for
+        // v1.0 files are all base salt, so every module shares the master key
+        if (encryptionData.masterKey && encryptionData.baseSalt.size() >= crypto_pwhash_SALTBYTES) {
+            return *encryptionData.masterKey;
+        }
+
+        std::vector<uint8_t> combinedSalt = encryptionData.baseSalt;
+        combinedSalt.insert(combinedSalt.end(), encryptionData.moduleSalt.begin(), encryptionData.moduleSalt.end());
+        if (combinedSalt.size() < crypto_pwhash_SALTBYTES) {
+            throw std::runtime_error("Salt too short");
+        }
+
+        return deriveKeyArgon2id(
+            encryptionData.masterPassword,
+            combinedSalt,
+            encryptionData.memoryCost,
+            encryptionData.timeCost,
+            encryptionData.parallelism
+        );
+    }
+
+    ensureInitialized();  // Ensure libsodium is initialized
+
+    if (encryptionData.moduleSalt.size() != crypto_generichash_blake2b_SALTBYTES) {
+        throw std::runtime_error("Module salt must be 16 bytes");
+    }
+
+    auto masterKey = encryptionData.masterKey ? encryptionData.masterKey : deriveMasterKey(encryptionData);
+
+    // Domain separated so the same master key can feed other subkeys later
+    static constexpr unsigned char personal[crypto_generichash_blake2b_PERSONALBYTES] = "UMDF module key";
+
+    std::vector<uint8_t> key(32); // 256-bit key for AES-256
+    if (crypto_generichash_blake2b_salt_personal(
+        key.data(), key.size(),
+        nullptr, 0,
+        masterKey->data(), masterKey->size(),
+        encryptionData.moduleSalt.data(),
+        personal
+    ) != 0) {
+        throw std::runtime_error("Module key derivation failed");
+    }
+
+    return key;
+}
+
 std::vector<uint8_t> EncryptionManager::generateSalt(size_t length) {
     ensureInitialized();  // Ensure libsodium is initialized
     
@@ -74,7 +139,7 @@ std::vector<uint8_t> EncryptionManager::generateIV(size_t length) {
     ensureInitialized();  // Ensure libsodium is initialized
     
     std::vector<uint8_t> iv(length);
-    
+    randombytes_buf(iv.data(), length);
     return iv;
 }
 
@@ -154,10 +219,247 @@ std::vector<uint8_t> EncryptionManager::decryptAES256GCM(
     return plaintext;
 }
 
+uint64_t EncryptionManager::segmentedSize(uint64_t plaintextSize, uint32_t segmentSize) {
+    // An empty payload still has one (empty) final segment
+    uint64_t segments = plaintextSize == 0 ? 1 : (plaintextSize + segmentSize - 1) / segmentSize;
+    return plaintextSize + segments * crypto_aead_aes256gcm_ABYTES;
+}
+
+EncryptionType EncryptionManager::selectCipher() {
+    ensureInitialized();  // Ensure libsodium is initialized
+
+    return crypto_aead_aes256gcm_is_available() ? EncryptionType::AES_256_GCM : EncryptionType::XCHACHA20_POLY1305;
+}
+
+size_t EncryptionManager::nonceSize(EncryptionType cipher) {
+    switch (cipher) {
+        case EncryptionType::AES_256_GCM: return crypto_aead_aes256gcm_NPUBBYTES;
+        case EncryptionType::XCHACHA20_POLY1305: return crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+        default: throw std::runtime_error("Unsupported encryption type");
+    }
+}
+
+size_t EncryptionManager::tagSize(EncryptionType cipher) {
+    switch (cipher) {
+        case EncryptionType::AES_256_GCM: return crypto_aead_aes256gcm_ABYTES;
+        case EncryptionType::XCHACHA20_POLY1305: return crypto_aead_xchacha20poly1305_ietf_ABYTES;
+        default: throw std::runtime_error("Unsupported encryption type");
+    }
+}
+
+// Segments are sized the same for either cipher, segmentedSize() relies on it
+static_assert(crypto_aead_aes256gcm_ABYTES == crypto_aead_xchacha20poly1305_ietf_ABYTES);
+
+static std::vector<uint8_t> segmentNonce(
+    EncryptionType cipher, const std::vector<uint8_t>& iv, uint64_t index, SegmentDomain domain) {
+
+    if (iv.size() != EncryptionManager::nonceSize(cipher)) {
+        throw std::runtime_error("Invalid IV size for " + EncryptionManager::encryptionToString(cipher));
+    }
+
+    std::vector<uint8_t> nonce = iv;
+    for (size_t i = 0; i < sizeof(index); ++i) {
+        nonce[i] ^= static_cast<uint8_t>(index >> (8 * i));
+    }
+    nonce[sizeof(index)] ^= static_cast<uint8_t>(domain);
+    return nonce;
+}
+
+std::vector<uint8_t> EncryptionManager::sealSegment(
+    EncryptionType cipher,
+    std::span<const uint8_t> plaintext,
+    const std::vector<uint8_t>& key,
+    const std::vector<uint8_t>& iv,
+    uint64_t index,
+    bool final,
+    SegmentDomain domain
+) {
+    ensureInitialized();  // Ensure libsodium is initialized
+
+    if (key.size() != 32) {
+        throw std::runtime_error(encryptionToString(cipher) + " requires 32-byte key");
+    }
+
+    std::vector<uint8_t> nonce = segmentNonce(cipher, iv, index, domain);
+    uint8_t finalFlag = final ? 1 : 0;
+
+    std::vector<uint8_t> sealed(plaintext.size() + tagSize(cipher));
+    unsigned long long sealedLen;
+
+    auto encrypt = cipher == EncryptionType::XCHACHA20_POLY1305
+        ? crypto_aead_xchacha20poly1305_ietf_encrypt
+        : crypto_aead_aes256gcm_encrypt;
+
+    if (encrypt(
+        sealed.data(), &sealedLen,
+        plaintext.data(), plaintext.size(),
+        &finalFlag, sizeof(finalFlag),
+        nullptr,
+        nonce.data(),
+        key.data()
+    ) != 0) {
+        throw std::runtime_error(encryptionToString(cipher) + " encryption failed");
+    }
+
+    sealed.resize(sealedLen);
+    return sealed;
+}
+
+std::vector<uint8_t> EncryptionManager::openSegment(
+    EncryptionType cipher,
+    std::span<const uint8_t> sealed,
+    const std::vector<uint8_t>& key,
+    const std::vector<uint8_t>& iv,
+    uint64_t index,
+    bool final,
+    SegmentDomain domain
+) {
+    ensureInitialized();  // Ensure libsodium is initialized
+
+    if (key.size() != 32) {
+        throw std::runtime_error(encryptionToString(cipher) + " requires 32-byte key");
+    }
+    if (sealed.size() < tagSize(cipher)) {
+        throw std::runtime_error("Encrypted segment too short");
+    }
+
+    std::vector<uint8_t> nonce = segmentNonce(cipher, iv, index, domain);
+    uint8_t finalFlag = final ? 1 : 0;
+
+    std::vector<uint8_t> plaintext(sealed.size() - tagSize(cipher));
+    unsigned long long plaintextLen;
+
+    auto decrypt = cipher == EncryptionType::XCHACHA20_POLY1305
+        ? crypto_aead_xchacha20poly1305_ietf_decrypt
+        : crypto_aead_aes256gcm_decrypt;
+
+    if (decrypt(
+        plaintext.data(), &plaintextLen,
+        nullptr,
+        sealed.data(), sealed.size(),
+        &finalFlag, sizeof(finalFlag),
+        nonce.data(),
+        key.data()
+    ) != 0) {
+        throw std::runtime_error(encryptionToString(cipher) + " decryption failed");
+    }
+
+    plaintext.resize(plaintextLen);
+    return plaintext;
+}
+
+std::vector<uint8_t> EncryptionManager::decryptSegmented(
+    EncryptionType cipher,
+    std::istream& in,
+    uint64_t payloadSize,
+    const std::vector<uint8_t>& key,
+    const std::vector<uint8_t>& iv,
+    uint32_t segmentSize
+) {
+    if (segmentSize == 0) {
+        throw std::runtime_error("Invalid encryption segment size");
+    }
+
+    const uint64_t tag = tagSize(cipher);
+    const uint64_t sealedSegmentSize = uint64_t(segmentSize) + tag;
+    uint64_t segments = (payloadSize + sealedSegmentSize - 1) / sealedSegmentSize;
+    if (segments == 0) {
+        throw std::runtime_error("Encrypted payload is empty");
+    }
+
+    std::vector<uint8_t> plaintext;
+    plaintext.reserve(payloadSize - std::min(payloadSize, segments * tag));
+
+    std::vector<uint8_t> sealed;
+    uint64_t remaining = payloadSize;
+    for (uint64_t index = 0; remaining > 0; ++index) {
+
+        sealed.resize(std::min(remaining, sealedSegmentSize));
+        in.read(reinterpret_cast<char*>(sealed.data()), sealed.size());
+        if (in.gcount() != static_cast<std::streamsize>(sealed.size())) {
+            throw std::runtime_error("Failed to read full data block");
+        }
+        remaining -= sealed.size();
+
+        std::vector<uint8_t> segment = openSegment(cipher, sealed, key, iv, index, remaining == 0);
+        plaintext.insert(plaintext.end(), segment.begin(), segment.end());
+    }
+
+    return plaintext;
+}
+
+SegmentedEncryptor::SegmentedEncryptor(std::ostream& out, EncryptionType cipher, std::vector<uint8_t> key,
+    std::vector<uint8_t> iv, uint32_t segmentSize)
+    : out(out), cipher(cipher), key(std::move(key)), iv(std::move(iv)), segmentSize(segmentSize) {
+
+    if (segmentSize == 0) {
+        throw std::runtime_error("Invalid encryption segment size");
+    }
+    pending.reserve(segmentSize);
+}
+
+void SegmentedEncryptor::write(std::span<const uint8_t> bytes) {
+
+    while (!bytes.empty()) {
+        // A full segment is only sealed once more data arrives, as until then
+        // it may still turn out to be the final one
+        if (pending.size() == segmentSize) {
+            sealPending(false);
+        }
+
+        size_t take = std::min<size_t>(bytes.size(), segmentSize - pending.size());
+        pending.insert(pending.end(), bytes.begin(), bytes.begin() + take);
+        bytes = bytes.subspan(take);
+    }
+}
+
+uint64_t SegmentedEncryptor::finish() {
+    sealPending(true);
+    return bytesWritten;
+}
+
+void SegmentedEncryptor::sealPending(bool final) {
+
+    std::vector<uint8_t> sealed = EncryptionManager::sealSegment(cipher, pending, key, iv, segmentIndex++, final);
+    out.write(reinterpret_cast<const char*>(sealed.data()), sealed.size());
+    if (!out) {
+        throw std::runtime_error("Failed to write encrypted segment");
+    }
+
+    bytesWritten += sealed.size();
+    pending.clear();
+}
+
+std::streamsize SegmentedEncryptorBuffer::xsputn(const char* bytes, std::streamsize count) {
+    encryptor.write(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(bytes), static_cast<size_t>(count)));
+    plaintextWritten += count;
+    return count;
+}
+
+SegmentedEncryptorBuffer::int_type SegmentedEncryptorBuffer::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    char byte = traits_type::to_char_type(ch);
+    xsputn(&byte, 1);
+    return ch;
+}
+
+SegmentedEncryptorBuffer::pos_type SegmentedEncryptorBuffer::seekoff(
+    off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+
+    // Sealed segments cannot be rewritten, so the position can be read but not moved
+    if (offset != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out)) {
+        return pos_type(off_type(-1));
+    }
+    return pos_type(static_cast<off_type>(plaintextWritten));
+}
+
 EncryptionType EncryptionManager::decodeEncryptionType(uint8_t value) {
     switch (value) {
         case 1: return EncryptionType::NONE;
         case 2: return EncryptionType::AES_256_GCM;
+        case 3: return EncryptionType::XCHACHA20_POLY1305;
         default: return EncryptionType::UNKNOWN;
     }
 }
@@ -166,6 +468,7 @@ std::string EncryptionManager::encryptionToString(EncryptionType encryptionType)
     switch (encryptionType) {
         case EncryptionType::NONE: return "NONE";
         case EncryptionType::AES_256_GCM: return "AES_256_GCM";
+        case EncryptionType::XCHACHA20_POLY1305: return "XCHACHA20_POLY1305";
         default: return "UNKNOWN";
     }
 }
\ No newline at end of file
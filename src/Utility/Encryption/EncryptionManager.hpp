@@ -4,16 +4,29 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <memory>
+#include <span>
+#include <ostream>
+#include <istream>
+#include <streambuf>
 #include <sodium.h>
 
 enum class EncryptionType {
     UNKNOWN = 0,
     NONE = 1,
-    AES_256_GCM = 2
+    AES_256_GCM = 2,
+    XCHACHA20_POLY1305 = 3
+};
+
+// How module keys are obtained from the password, fixed by the file format version
+enum class KeyScheme {
+    PerModuleArgon2id = 0,  // v1.0: Argon2id over baseSalt + moduleSalt for every module
+    MasterKey = 1           // v1.1: Argon2id once per file, keyed BLAKE2b over moduleSalt per module
 };
 
 struct EncryptionData {
     EncryptionType encryptionType = EncryptionType::NONE;
+    KeyScheme keyScheme = KeyScheme::MasterKey;
 
     std::string masterPassword = "";
     
@@ -22,11 +35,23 @@ struct EncryptionData {
     uint64_t memoryCost;                  // Memory cost in bytes (e.g., 65536 = 64KB)
     uint32_t timeCost;                    // Time cost/iterations (e.g., 3)
     uint32_t parallelism;                 // Parallelism (usually 1)
+
+    // Argon2id(password, baseSalt), derived once when the password is set
+    std::shared_ptr<const std::vector<uint8_t>> masterKey;
     
-    // AES256-GCM parameters:
+    // AEAD parameters:
     std::vector<uint8_t> moduleSalt;      // Module-specific salt
-    std::vector<uint8_t> iv;             // Nonce (12 bytes for GCM)
-    std::vector<uint8_t> authTag{crypto_aead_aes256gcm_ABYTES};        // Authentication tag (16 bytes)
+    std::vector<uint8_t> iv;             // Nonce (12 bytes for GCM, 24 for XChaCha20)
+    std::vector<uint8_t> authTag = std::vector<uint8_t>(crypto_aead_aes256gcm_ABYTES); // Authentication tag (16 bytes)
+    uint32_t segmentSize = 0;             // Plaintext bytes per sealed segment, 0 = whole payload under one tag
+    bool framesSealed = false;            // Image frames and frame index sealed on their own, outside the payload
+};
+
+// Separates the nonces of the independently sealed parts of one module
+enum class SegmentDomain : uint8_t {
+    Payload = 0,
+    Frame = 1,
+    FrameIndex = 2
 };
 
 
@@ -41,9 +66,22 @@ public:
         uint32_t parallelism
     );
     
+    // Argon2id over the file's base salt, run once per file open
+    static std::shared_ptr<const std::vector<uint8_t>> deriveMasterKey(const EncryptionData& encryptionData);
+
+    // AES key of a single module under the file's key scheme. Uses the cached
+    // master key when present and only falls back to Argon2id without one.
+    static std::vector<uint8_t> deriveModuleKey(const EncryptionData& encryptionData);
+
     // Salt and IV generation
     static std::vector<uint8_t> generateSalt(size_t length = 32);
     static std::vector<uint8_t> generateIV(size_t length = 12);
+
+    // AES-256-GCM where the CPU accelerates it (AES-NI and PCLMUL), XChaCha20-Poly1305 otherwise
+    static EncryptionType selectCipher();
+    static size_t nonceSize(EncryptionType cipher);
+    // Length of the authentication tag each seal with cipher appends
+    static size_t tagSize(EncryptionType cipher);
     
     // Main encryption/decryption
     static std::vector<uint8_t> encryptAES256GCM(
@@ -60,6 +98,46 @@ public:
         const std::vector<uint8_t>& authTag
     );
     
+    // Segmented AEAD, see SegmentedEncryptor for the layout
+    static constexpr uint32_t DEFAULT_SEGMENT_SIZE = 1024 * 1024; // 1 MiB
+
+    // Ciphertext size of a segmented payload holding plaintextSize bytes
+    static uint64_t segmentedSize(uint64_t plaintextSize, uint32_t segmentSize);
+
+    // Seal or open a single segment with either AEAD cipher, the result of seal
+    // is ciphertext followed by its 16 byte tag
+    static std::vector<uint8_t> sealSegment(
+        EncryptionType cipher,
+        std::span<const uint8_t> plaintext,
+        const std::vector<uint8_t>& key,
+        const std::vector<uint8_t>& iv,
+        uint64_t index,
+        bool final,
+        SegmentDomain domain = SegmentDomain::Payload
+    );
+
+    static std::vector<uint8_t> openSegment(
+        EncryptionType cipher,
+        std::span<const uint8_t> sealed,
+        const std::vector<uint8_t>& key,
+        const std::vector<uint8_t>& iv,
+        uint64_t index,
+        bool final,
+        SegmentDomain domain = SegmentDomain::Payload
+    );
+
+    // Read and open payloadSize sealed bytes, holding at most one segment of
+    // ciphertext at a time. The plaintext is returned whole, since modules are
+    // parsed from complete section buffers; only the ciphertext side is bounded.
+    static std::vector<uint8_t> decryptSegmented(
+        EncryptionType cipher,
+        std::istream& in,
+        uint64_t payloadSize,
+        const std::vector<uint8_t>& key,
+        const std::vector<uint8_t>& iv,
+        uint32_t segmentSize
+    );
+
     // Utility methods
     static EncryptionType decodeEncryptionType(uint8_t value);
     static std::string encryptionToString(EncryptionType encryptionType);
@@ -67,6 +145,59 @@ public:
     static void ensureInitialized();
 };
 
+/**
+ * Seals a payload as a sequence of independently authenticated segments.
+ *
+ * Every segment but the last holds exactly segmentSize plaintext bytes and is
+ * stored as ciphertext followed by its 16 byte tag. The nonce of segment i is
+ * the module IV (12 or 24 bytes, by cipher) with i XORed into its first 8 bytes and the SegmentDomain into
+ * the ninth, so frames sealed separately never share a nonce with the payload.
+ * A final flag is bound as associated data, so segments cannot be reordered,
+ * dropped or truncated without failing authentication. Only one segment is
+ * buffered at a time, wrap the encryptor in a SegmentedEncryptorBuffer to
+ * serialise sections straight into it.
+ */
+class SegmentedEncryptor {
+private:
+    std::ostream& out;
+    EncryptionType cipher;
+    std::vector<uint8_t> key;
+    std::vector<uint8_t> iv;
+    uint32_t segmentSize;
+
+    std::vector<uint8_t> pending;
+    uint64_t segmentIndex = 0;
+    uint64_t bytesWritten = 0;
+
+    void sealPending(bool final);
+
+public:
+    SegmentedEncryptor(std::ostream& out, EncryptionType cipher, std::vector<uint8_t> key, std::vector<uint8_t> iv,
+        uint32_t segmentSize = EncryptionManager::DEFAULT_SEGMENT_SIZE);
+
+    void write(std::span<const uint8_t> bytes);
+
+    // Seal the last segment, returns the number of bytes written to the stream
+    uint64_t finish();
+};
+
+// std::streambuf over a SegmentedEncryptor, so that sections can be written
+// into the sealed payload through a std::ostream without buffering them first
+class SegmentedEncryptorBuffer : public std::streambuf {
+private:
+    SegmentedEncryptor& encryptor;
+    uint64_t plaintextWritten = 0;
+
+protected:
+    std::streamsize xsputn(const char* bytes, std::streamsize count) override;
+    int_type overflow(int_type ch) override;
+    // Only reports the plaintext position, so that tellp() works
+    pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+public:
+    explicit SegmentedEncryptorBuffer(SegmentedEncryptor& encryptor) : encryptor(encryptor) {}
+};
+
 
 
 
@@ -0,0 +1,28 @@
+#include "mappedFile.hpp"
+
+#include <stdexcept>
+
+using namespace std;
+namespace bip = boost::interprocess;
+
+MappedFile::MappedFile(const string& path) {
+    try {
+        mapping = bip::file_mapping(path.c_str(), bip::read_only);
+        region = bip::mapped_region(mapping, bip::read_only);
+    }
+    catch (const bip::interprocess_exception& e) {
+        throw runtime_error("Failed to map file " + path + ": " + e.what());
+    }
+}
+
+span<const byte> MappedFile::bytes() const {
+    return { static_cast<const byte*>(region.get_address()), region.get_size() };
+}
+
+span<const byte> MappedFile::bytes(uint64_t offset, uint64_t length) const {
+    if (offset > size() || length > size() - offset) {
+        throw out_of_range("Mapped range [" + to_string(offset) + ", +" + to_string(length) +
+            ") exceeds file size " + to_string(size()));
+    }
+    return bytes().subspan(offset, length);
+}
@@ -0,0 +1,50 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Used by the Reader's memory-mapped mode so that modules can be parsed
+ * directly out of the page cache instead of being copied through an
+ * ifstream. Any span handed out stays valid until the MappedFile is destroyed.
+ */
+class MappedFile {
+private:
+    boost::interprocess::file_mapping mapping;
+    boost::interprocess::mapped_region region;
+
+public:
+    /**
+     * @brief Map the given file read-only.
+     * @param path Path to the file to map
+     * @throws std::runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    size_t size() const { return region.get_size(); }
+
+    /**
+     * @brief View of the complete mapping.
+     */
+    std::span<const std::byte> bytes() const;
+
+    /**
+     * @brief Bounds-checked view of part of the mapping.
+     * @param offset Offset from the start of the file
+     * @param length Number of bytes in the view
+     * @throws std::out_of_range if the range lies outside the file
+     */
+    std::span<const std::byte> bytes(uint64_t offset, uint64_t length) const;
+};
+
+#endif
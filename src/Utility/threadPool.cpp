@@ -0,0 +1,154 @@
+#include "threadPool.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+
+using namespace std;
+
+namespace {
+    mutex sharedPoolMutex;
+    unique_ptr<ThreadPool> sharedPool;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+
+    workers.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(function<void()> task) {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const function<void(size_t)>& body) {
+
+    if (count == 0) {
+        return;
+    }
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // Shared with the helpers, which may only get to run after this call returned
+    struct Loop {
+        function<void(size_t)> body;
+        size_t count;
+        atomic<size_t> next{0};
+        atomic<bool> failed{false};
+
+        std::mutex mutex;
+        condition_variable done;
+        size_t active = 0;
+        exception_ptr error;
+
+        void run() {
+            size_t i;
+            while (!failed.load(memory_order_relaxed) &&
+                   (i = next.fetch_add(1, memory_order_relaxed)) < count) {
+                try {
+                    body(i);
+                }
+                catch (...) {
+                    lock_guard<std::mutex> lock(mutex);
+                    if (!error) {
+                        error = current_exception();
+                    }
+                    failed = true;
+                }
+            }
+        }
+    };
+
+    auto loop = make_shared<Loop>();
+    loop->body = body;
+    loop->count = count;
+
+    size_t helpers = min(workers.size(), count - 1);
+    for (size_t h = 0; h < helpers; ++h) {
+        submit([loop] {
+            {
+                lock_guard<std::mutex> lock(loop->mutex);
+                if (loop->failed || loop->next.load() >= loop->count) {
+                    return;
+                }
+                ++loop->active;
+            }
+
+            loop->run();
+
+            lock_guard<std::mutex> lock(loop->mutex);
+            if (--loop->active == 0) {
+                loop->done.notify_all();
+            }
+        });
+    }
+
+    loop->run();
+
+    // Only helpers that actually started are waited for, queued ones find no work left
+    unique_lock<std::mutex> lock(loop->mutex);
+    loop->done.wait(lock, [&] { return loop->active == 0; });
+
+    if (loop->error) {
+        rethrow_exception(loop->error);
+    }
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    unsigned int hardware = thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+}
+
+ThreadPool& ThreadPool::shared() {
+    lock_guard<std::mutex> lock(sharedPoolMutex);
+    if (!sharedPool) {
+        sharedPool = make_unique<ThreadPool>();
+    }
+    return *sharedPool;
+}
+
+void ThreadPool::setSharedThreadCount(size_t threadCount) {
+    lock_guard<std::mutex> lock(sharedPoolMutex);
+    sharedPool = make_unique<ThreadPool>(threadCount);
+}
@@ -0,0 +1,66 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size worker pool for data-parallel loops.
+ *
+ * The calling thread always takes part in parallelFor(), so a pool of N
+ * threads runs N-1 workers and a pool of 1 thread runs everything inline.
+ * Because callers never just block on queued work, parallelFor() may be
+ * nested or called from several threads at once without deadlocking.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    bool stopping = false;
+
+    void workerLoop();
+    void submit(std::function<void()> task);
+
+public:
+    /**
+     * @param threadCount Total threads including the caller, 0 selects defaultThreadCount()
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getThreadCount() const { return workers.size() + 1; }
+
+    /**
+     * @brief Run body(i) for every i in [0, count) and wait for all of them.
+     *
+     * Indices are handed out dynamically, so uneven work balances itself.
+     * If a call throws, no further indices are started and the first
+     * exception is rethrown once running calls have finished.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    static size_t defaultThreadCount();
+
+    /**
+     * @brief Process-wide pool used by the image codecs.
+     */
+    static ThreadPool& shared();
+
+    /**
+     * @brief Resize the shared pool.
+     * @note Must not be called while the shared pool is in use
+     */
+    static void setSharedThreadCount(size_t threadCount);
+};
+
+#endif
@@ -33,7 +33,13 @@ enum class HeaderFieldType : uint8_t {
     CreatedAt = 23,
     CreatedBy = 24,
     ModifiedAt = 25,
-    ModifiedBy = 26
+    ModifiedBy = 26,
+    FrameIndexOffset = 27,
+    EncryptionSegmentSize = 28,
+    FramesSealed = 29,
+    MetadataZstdSettings = 30,
+    DataZstdSettings = 31,
+    MetadataDictionaryID = 32
 };
 
 void writeTLVString(std::ostream& out, HeaderFieldType type, const std::string& value);
@@ -6,6 +6,9 @@
 #include <string>
 #include <sstream>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 using namespace std;
 
 Version Version::parse(const string& versionStr) {
@@ -34,4 +37,19 @@ bool getCurrentFilePosition(ostream& outfile, uint64_t& offset) {
     // Convert to integer offset
     offset = static_cast<uint64_t>(pos);
     return true;
-}
\ No newline at end of file
+}
+
+bool syncFile(const string& path) {
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+#if defined(__APPLE__)
+    // fsync only reaches the drive cache on macOS
+    bool synced = ::fcntl(fd, F_FULLFSYNC) == 0 || ::fsync(fd) == 0;
+#else
+    bool synced = ::fsync(fd) == 0;
+#endif
+    ::close(fd);
+    return synced;
+}
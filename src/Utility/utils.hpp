@@ -15,4 +15,7 @@ struct Version {
 
 bool getCurrentFilePosition(std::ostream& outfile, uint64_t& offset);
 
+// Force the file's written data to stable storage, flush streams writing it first
+bool syncFile(const std::string& path);
+
 #endif
\ No newline at end of file
@@ -2,6 +2,9 @@
 #define UUID_HPP
 
 #include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
 
 class UUID {
 private:
@@ -26,6 +29,19 @@ public:
 
     const std::array<uint8_t, 16>& data() const;
     void setData(const std::array<uint8_t, 16>& newData);
+
+    // Mix both 64-bit halves of the raw bytes. Version 4 UUIDs are already
+    // random, this only has to spread them over every bit of the result.
+    uint64_t hash() const {
+        uint64_t lo, hi;
+        std::memcpy(&lo, uuid.data(), sizeof(lo));
+        std::memcpy(&hi, uuid.data() + sizeof(lo), sizeof(hi));
+        uint64_t h = (lo * 0x9E3779B97F4A7C15ull) ^ hi;
+        h ^= h >> 32;
+        h *= 0xD6E8FEB86659FD93ull;
+        h ^= h >> 32;
+        return h;
+    }
 };
 
 // Hash function specialization for UUID
@@ -33,12 +49,7 @@ namespace std {
     template<>
     struct hash<UUID> {
         size_t operator()(const UUID& uuid) const {
-            const auto& data = uuid.data();
-            size_t hash = 0;
-            for (uint8_t byte : data) {
-                hash = hash * 31 + byte;
-            }
-            return hash;
+            return static_cast<size_t>(uuid.hash());
         }
     };
 }
@@ -2,6 +2,7 @@
 #include "Utility/utils.hpp"
 #include "Utility/uuid.hpp"
 
+#include <cstring>
 #include <string>
 #include <algorithm> 
 #include <vector>
@@ -18,7 +19,7 @@ void XRefTable::addEntry(
     ModuleType type, 
     UUID uuid, 
     uint64_t offset, 
-    uint32_t size, 
+    uint64_t size, 
     std::string schemaPath) {
         
     XrefEntry newEntry;
@@ -27,27 +28,100 @@ void XRefTable::addEntry(
     newEntry.offset = offset;
     newEntry.size = size;
     newEntry.schemaPath = schemaPath;
-    entries.push_back(newEntry);
+
+    if (!index.empty()) {
+        size_t slot = findSlot(uuid);
+        if (index[slot] != EMPTY_SLOT) {
+            entries[index[slot]] = std::move(newEntry);
+            return;
+        }
+    }
+
+    entries.push_back(std::move(newEntry));
+
+    if (entries.size() * 2 > index.size()) {
+        rebuildIndex();
+    }
+    else {
+        index[findSlot(uuid)] = static_cast<uint32_t>(entries.size() - 1);
+    }
 }
 
-bool XRefTable::deleteEntry(UUID entryId) {
+bool XRefTable::deleteEntry(const UUID& entryId) {
 
-    if (erase_if(entries, [entryId](const XrefEntry& entry) {
-        return entry.id == entryId;
-    }) > 0) { return true; }
-    else { return false; }
-    
+    if (index.empty()) { return false; }
+
+    size_t slot = findSlot(entryId);
+    if (index[slot] == EMPTY_SLOT) { return false; }
+
+    uint32_t position = index[slot];
+    eraseSlot(slot);
+
+    // Fill the gap with the last entry and repoint its slot
+    if (position != entries.size() - 1) {
+        entries[position] = std::move(entries.back());
+        index[findSlot(entries[position].id)] = position;
+    }
+    entries.pop_back();
+
+    return true;
 }
 
+size_t XRefTable::findSlot(const UUID& id) const {
+    size_t mask = index.size() - 1;
+    size_t slot = id.hash() & mask;
+    while (index[slot] != EMPTY_SLOT && entries[index[slot]].id != id) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void XRefTable::eraseSlot(size_t slot) {
+    // Backward-shift deletion keeps every probe sequence unbroken without tombstones
+    size_t mask = index.size() - 1;
+    size_t hole = slot;
+    size_t next = (slot + 1) & mask;
+    while (index[next] != EMPTY_SLOT) {
+        size_t home = entries[index[next]].id.hash() & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index[hole] = index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    index[hole] = EMPTY_SLOT;
+}
 
-const XrefEntry& XRefTable::getEntry(UUID id) const {
-    for (const XrefEntry& entry : entries) {
-        if (entry.id == id) return entry;
+void XRefTable::rebuildIndex() {
+    size_t capacity = 16;
+    while (capacity < entries.size() * 2) {
+        capacity *= 2;
     }
-    throw std::runtime_error("Entry not found");
+
+    index.assign(capacity, EMPTY_SLOT);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        index[findSlot(entries[i].id)] = static_cast<uint32_t>(i);
+    }
+}
+
+const XrefEntry* XRefTable::findEntry(const UUID& id) const {
+    if (index.empty()) return nullptr;
+
+    uint32_t position = index[findSlot(id)];
+    return position == EMPTY_SLOT ? nullptr : &entries[position];
+}
+
+const XrefEntry& XRefTable::getEntry(const UUID& id) const {
+    const XrefEntry* entry = findEntry(id);
+    if (!entry) throw std::runtime_error("Entry not found");
+    return *entry;
 }
 
 bool XRefTable::writeXref(std::ostream& out) const{
+    return writeTable(out) && writeFooter(out);
+}
+
+bool XRefTable::writeTable(std::ostream& out) const {
     // 1. Write Header Signature
     out.write("XREF", 4);
 
@@ -63,8 +137,10 @@ bool XRefTable::writeXref(std::ostream& out) const{
     uint8_t widths[5] = {16, 1, 8, 8, 4};
     out.write(reinterpret_cast<const char*>(widths), sizeof(widths));
 
-    // 5. Write Reserved (zeroed)
+    // 5. Write Reserved, starting with the dictionary table location
     uint8_t reserved[32] = {};
+    std::memcpy(reserved, &dictionaryOffset, sizeof(dictionaryOffset));
+    std::memcpy(reserved + sizeof(dictionaryOffset), &dictionarySize, sizeof(dictionarySize));
     out.write(reinterpret_cast<const char*>(reserved), sizeof(reserved));
 
     // 6. Write Each Entry as binary row
@@ -78,6 +154,13 @@ bool XRefTable::writeXref(std::ostream& out) const{
         out.write(entry.schemaPath.c_str(), schemaPathLength);
     }
 
+    return out.good();
+}
+
+bool XRefTable::writeFooter(std::ostream& out) const {
+    static_assert(FOOTER_SIZE == sizeof(xrefMarker) + sizeof(xrefOffset) + sizeof(moduleGraphOffset)
+        + sizeof(moduleGraphSize) + sizeof(EOFmarker));
+
     // 7. Write footer
     out.write(xrefMarker, sizeof(xrefMarker));
     out.write(reinterpret_cast<const char*>(&xrefOffset), sizeof(xrefOffset));
@@ -91,14 +174,6 @@ bool XRefTable::writeXref(std::ostream& out) const{
 
 XRefTable XRefTable::loadXrefTable(std::istream& in) {
 
-    constexpr size_t FOOTER_SIZE = sizeof(EOFmarker) 
-        + sizeof(xrefOffset) 
-        + sizeof(moduleGraphOffset) 
-        + sizeof(moduleGraphSize) 
-        + sizeof(xrefMarker);
-
-    XRefTable table;
-
     // 1. Seek to end minus footer size
     in.seekg(0, std::ios::end);
     size_t fileSize = static_cast<size_t>(in.tellg());
@@ -107,7 +182,140 @@ XRefTable XRefTable::loadXrefTable(std::istream& in) {
         throw runtime_error("File too small to contain valid footer.");
     }
 
-    in.seekg(fileSize - FOOTER_SIZE);
+    return loadXrefTableAt(in, fileSize, true);
+}
+
+XRefTable XRefTable::recoverXrefTable(std::istream& in, uint64_t& committedSize) {
+
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+
+    if (fileSize < FOOTER_SIZE) {
+        throw runtime_error("File too small to contain valid footer.");
+    }
+
+    // Fast path, the last commit completed
+    try {
+        XRefTable table = loadXrefTableAt(in, fileSize, false);
+        committedSize = fileSize;
+        return table;
+    }
+    catch (const std::exception&) {
+        in.clear();
+    }
+
+    // Search backwards for end of file markers, chunks overlap by a marker length
+    constexpr uint64_t CHUNK_SIZE = 1 << 20;
+    std::vector<char> chunk;
+    uint64_t chunkEnd = fileSize;
+
+    while (chunkEnd > FOOTER_SIZE) {
+        uint64_t chunkStart = chunkEnd > CHUNK_SIZE ? chunkEnd - CHUNK_SIZE : 0;
+        chunk.resize(chunkEnd - chunkStart);
+        in.seekg(chunkStart);
+        in.read(chunk.data(), chunk.size());
+        if (!in) {
+            throw runtime_error("Failed to read file while recovering Xref table.");
+        }
+
+        for (size_t i = chunk.size() - sizeof(EOFmarker) + 1; i-- > 0;) {
+            if (std::memcmp(chunk.data() + i, EOFmarker, sizeof(EOFmarker)) != 0) {
+                continue;
+            }
+            uint64_t footerEnd = chunkStart + i + sizeof(EOFmarker);
+            if (footerEnd < FOOTER_SIZE || footerEnd == fileSize) {
+                continue;
+            }
+            try {
+                XRefTable table = loadXrefTableAt(in, footerEnd, false);
+                committedSize = footerEnd;
+                return table;
+            }
+            catch (const std::exception&) {
+                in.clear();
+            }
+        }
+
+        if (chunkStart == 0) {
+            break;
+        }
+        chunkEnd = chunkStart + sizeof(EOFmarker) - 1;
+    }
+
+    throw runtime_error("No complete Xref table found.");
+}
+
+bool XRefTable::hasFooterAfter(std::istream& in, uint64_t offset) {
+
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+
+    // Search forwards for footers, chunks overlap by a footer length
+    constexpr uint64_t CHUNK_SIZE = 1 << 20;
+    constexpr size_t EOF_OFFSET = FOOTER_SIZE - sizeof(EOFmarker);
+    std::vector<char> chunk;
+    uint64_t chunkStart = offset;
+
+    while (chunkStart + FOOTER_SIZE <= fileSize) {
+        uint64_t chunkEnd = std::min(fileSize, chunkStart + CHUNK_SIZE);
+        chunk.resize(chunkEnd - chunkStart);
+        in.seekg(chunkStart);
+        in.read(chunk.data(), chunk.size());
+        if (!in) {
+            throw runtime_error("Failed to read file while searching for a footer.");
+        }
+
+        for (size_t i = 0; i + FOOTER_SIZE <= chunk.size(); ++i) {
+            if (std::memcmp(chunk.data() + i, xrefMarker, sizeof(xrefMarker)) == 0 &&
+                std::memcmp(chunk.data() + i + EOF_OFFSET, EOFmarker, sizeof(EOFmarker)) == 0 &&
+                footerOpensTable(in, chunkStart + i + FOOTER_SIZE)) {
+                return true;
+            }
+        }
+
+        if (chunkEnd == fileSize) {
+            break;
+        }
+        chunkStart = chunkEnd - FOOTER_SIZE + 1;
+    }
+    return false;
+}
+
+bool XRefTable::footerOpensTable(std::istream& in, uint64_t footerEnd) {
+
+    uint64_t footerStart = footerEnd - FOOTER_SIZE;
+    uint64_t inXrefOffset = 0;
+    uint64_t inModuleGraphOffset = 0;
+    uint32_t inModuleGraphSize = 0;
+
+    in.seekg(footerStart + sizeof(xrefMarker));
+    in.read(reinterpret_cast<char*>(&inXrefOffset), sizeof(inXrefOffset));
+    in.read(reinterpret_cast<char*>(&inModuleGraphOffset), sizeof(inModuleGraphOffset));
+    in.read(reinterpret_cast<char*>(&inModuleGraphSize), sizeof(inModuleGraphSize));
+
+    // The table header has to fit between the module graph and the footer
+    constexpr uint64_t TABLE_HEADER_SIZE = 4 + 1 + 4 + 5 + 32;
+    if (!in || inXrefOffset > footerStart || footerStart - inXrefOffset < TABLE_HEADER_SIZE ||
+        inModuleGraphOffset > inXrefOffset || inModuleGraphSize > inXrefOffset - inModuleGraphOffset) {
+        in.clear();
+        return false;
+    }
+
+    char table[TABLE_HEADER_SIZE];
+    in.seekg(inXrefOffset);
+    in.read(table, sizeof(table));
+    bool opens = in && std::memcmp(table, "XREF", 4) == 0 && static_cast<uint8_t>(table[4]) <= 1 &&
+        std::memcmp(table + 9, "\x10\x01\x08\x08\x04", 5) == 0;
+    in.clear();
+    return opens;
+}
+
+XRefTable XRefTable::loadXrefTableAt(std::istream& in, uint64_t footerEnd, bool requireCurrent) {
+
+    XRefTable table;
+    uint64_t footerStart = footerEnd - FOOTER_SIZE;
+
+    in.seekg(footerStart);
 
     // 2. Read footer marker and xref offset
     char inXrefMarker[12];
@@ -129,6 +337,9 @@ XRefTable XRefTable::loadXrefTable(std::istream& in) {
     if (std::memcmp(inEOFmarker, EOFmarker, 8) != 0) {
         throw std::runtime_error("Invalid footer marker.");
     }
+    if (inXrefOffset >= footerStart || inModuleGraphOffset + inModuleGraphSize > inXrefOffset) {
+        throw std::runtime_error("Xref footer points outside the file.");
+    }
 
     // 3. Seek to xref offset
     table.setXrefOffset(inXrefOffset);
@@ -146,7 +357,7 @@ XRefTable XRefTable::loadXrefTable(std::istream& in) {
     // 5. Read Current Table Flag
     uint8_t isCurrent = 0;
     in.read(reinterpret_cast<char*>(&isCurrent), sizeof(isCurrent));
-    if (isCurrent == 0) {
+    if (requireCurrent && isCurrent == 0) {
         throw std::runtime_error("Obsolete Xref table.");
     }
 
@@ -162,11 +373,20 @@ XRefTable XRefTable::loadXrefTable(std::istream& in) {
         throw std::runtime_error("Unexpected field widths.");
     }
 
-    // 8. Skip reserved
+    // 8. Read reserved, files without dictionaries leave it zeroed
     uint8_t reserved[32];
     in.read(reinterpret_cast<char*>(reserved), sizeof(reserved));
+    std::memcpy(&table.dictionaryOffset, reserved, sizeof(table.dictionaryOffset));
+    std::memcpy(&table.dictionarySize, reserved + sizeof(table.dictionaryOffset), sizeof(table.dictionarySize));
+
+    // 9. Read entries, every one must lie between the table header and the footer
+    constexpr uint64_t MIN_ENTRY_SIZE = 16 + 1 + 8 + 8 + 4;
+    uint64_t position = static_cast<uint64_t>(in.tellg());
+    if (!in || count > (footerStart - position) / MIN_ENTRY_SIZE) {
+        throw std::runtime_error("Xref entry count exceeds table size.");
+    }
+    table.entries.reserve(count);
 
-    // 9. Read entries
     for (uint32_t i = 0; i < count; ++i) {
         XrefEntry entry{};
         in.read(reinterpret_cast<char*>(&entry.id), sizeof(entry.id));
@@ -175,11 +395,25 @@ XRefTable XRefTable::loadXrefTable(std::istream& in) {
         in.read(reinterpret_cast<char*>(&entry.offset), sizeof(entry.offset));
         uint32_t schemaPathLength = 0;
         in.read(reinterpret_cast<char*>(&schemaPathLength), sizeof(schemaPathLength));
+        position += MIN_ENTRY_SIZE;
+        if (!in || schemaPathLength > footerStart - position) {
+            throw std::runtime_error("Truncated Xref entry.");
+        }
         entry.schemaPath.resize(schemaPathLength);
         in.read(entry.schemaPath.data(), schemaPathLength);
+        position += schemaPathLength;
+        if (entry.offset > inXrefOffset || entry.size > inXrefOffset - entry.offset) {
+            throw std::runtime_error("Xref entry points past its table.");
+        }
         table.entries.push_back(entry);
     }
 
+    if (!in || position != footerStart) {
+        throw std::runtime_error("Xref table does not end at its footer.");
+    }
+
+    table.rebuildIndex();
+
     return table;
 }
 
@@ -200,6 +434,10 @@ ostream& operator<<(ostream& os, const XRefTable& table) {
 }
 
 void XRefTable::setObsolete(std::ostream& out) {
+    markObsolete(out, xrefOffset);
+}
+
+void XRefTable::markObsolete(std::ostream& out, uint64_t xrefOffset) {
 
     // Get current position
     std::streampos currentPos = out.tellp();
@@ -230,20 +468,15 @@ void XRefTable::setObsolete(std::ostream& out) {
     
 }
 
-void XRefTable::updateEntryOffset(UUID id, uint64_t offset) {
-    for (auto& entry : entries) {
-        if (entry.id == id) {
-            entry.offset = offset;
-            break;
-        }
+void XRefTable::updateEntryOffset(const UUID& id, uint64_t offset) {
+    if (index.empty()) return;
+
+    uint32_t position = index[findSlot(id)];
+    if (position != EMPTY_SLOT) {
+        entries[position].offset = offset;
     }
 }
 
-bool XRefTable::contains(UUID id) const {
-    for (const auto& entry : entries) {
-        if (entry.id == id) {
-            return true;
-        }
-    }
-    return false;
-}
\ No newline at end of file
+bool XRefTable::contains(const UUID& id) const {
+    return findEntry(id) != nullptr;
+}
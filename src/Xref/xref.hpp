@@ -9,6 +9,7 @@
 #include <iostream>
 #include <array>
 #include <vector>
+#include <cstdint>
 
 struct XrefEntry {
     UUID id;
@@ -21,30 +22,54 @@ struct XrefEntry {
 class XRefTable {
 private:
     std::vector<XrefEntry> entries;
+
+    // Open-addressing index from module UUID to position in entries.
+    // Linear probing over a power-of-two table that is kept at most half full.
+    std::vector<uint32_t> index;
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
     uint64_t xrefOffset;
 
     uint64_t moduleGraphOffset;
     uint32_t moduleGraphSize;
 
+    // Stored in the reserved bytes of the table header, 0 when the file has no dictionaries
+    uint64_t dictionaryOffset = 0;
+    uint32_t dictionarySize = 0;
+
     static char xrefMarker[12];
     static char EOFmarker[8];
 
     //std::map<int, std::streampos> references;
 
+    // Slot holding id, or the empty slot where its probe sequence ends
+    size_t findSlot(const UUID& id) const;
+
+    // Load the table whose footer ends at footerEnd
+    static XRefTable loadXrefTableAt(std::istream& in, uint64_t footerEnd, bool requireCurrent);
+    // Whether the footer ending at footerEnd points back at a table header
+    static bool footerOpensTable(std::istream& in, uint64_t footerEnd);
+    void eraseSlot(size_t slot);
+    void rebuildIndex();
+
 public:
+    // Adding an id that is already present replaces its entry
     void addEntry(
         ModuleType type, 
-        UUID uuid, uint64_t offset, uint32_t size, std::string schemaPath);
+        UUID uuid, uint64_t offset, uint64_t size, std::string schemaPath);
         
-    bool deleteEntry(UUID entryId);
-    void clear() { entries.clear(); }
+    // Removal is O(1): the last entry is moved into the freed position, so
+    // entry order is not preserved across deletions
+    bool deleteEntry(const UUID& entryId);
+    void clear() { entries.clear(); index.clear(); }
 
     // const XrefEntry* findEntry(ModuleType);
-    const XrefEntry& getEntry(UUID id) const;
+    const XrefEntry& getEntry(const UUID& id) const;
+    const XrefEntry* findEntry(const UUID& id) const;
 
-    std::vector<XrefEntry>& getEntries() { return entries; }
+    const std::vector<XrefEntry>& getEntries() const { return entries; }
 
-    bool contains(UUID id) const;
+    bool contains(const UUID& id) const;
 
     void setXrefOffset(uint64_t offset) { xrefOffset = offset; }
     uint64_t getXrefOffset() const { return xrefOffset; }
@@ -55,15 +80,53 @@ public:
     void setModuleGraphSize(uint32_t size) { moduleGraphSize = size; }
     uint32_t getModuleGraphSize() const { return moduleGraphSize; }
 
+    void setDictionaryOffset(uint64_t offset) { dictionaryOffset = offset; }
+    uint64_t getDictionaryOffset() const { return dictionaryOffset; }
+
+    void setDictionarySize(uint32_t size) { dictionarySize = size; }
+    uint32_t getDictionarySize() const { return dictionarySize; }
+
+    // Table followed by footer. The footer, the last bytes of the file,
+    // is what publishes a table, so commits write the two separately.
     bool writeXref(std::ostream& out) const;
+    bool writeTable(std::ostream& out) const;
+    bool writeFooter(std::ostream& out) const;
+
+    // Size of the footer that ends every committed file
+    static constexpr size_t FOOTER_SIZE = 12 + 8 + 8 + 4 + 8;
 
     static XRefTable loadXrefTable(std::istream& in);
 
+    /**
+     * Load the table of the newest complete footer, ignoring anything after it.
+     *
+     * A commit that was cut short leaves a partial module, table or footer at
+     * the end of the file. Scanning back to the last footer that describes a
+     * well-formed table recovers the last committed state.
+     * @param committedSize Set to the end of that footer
+     * @throws std::runtime_error if the file holds no complete table at all
+     */
+    static XRefTable recoverXrefTable(std::istream& in, uint64_t& committedSize);
+
+    /**
+     * Whether a footer lies after offset that ends a commit.
+     *
+     * recoverXrefTable only skips footers whose table it cannot read. Such a
+     * footer ended a commit that did complete, so the bytes before it must
+     * not be treated as the remains of an interrupted one. Matching the
+     * footer's markers is not enough, since frame data can contain them: the
+     * footer must also point back at a table header inside the file.
+     */
+    static bool hasFooterAfter(std::istream& in, uint64_t offset);
+
     friend std::ostream& operator<<(std::ostream& os, const XRefTable& table);
 
     void setObsolete(std::ostream& out);
 
-    void updateEntryOffset(UUID id, uint64_t offset);
+    // Clear the current flag of the table written at xrefOffset
+    static void markObsolete(std::ostream& out, uint64_t xrefOffset);
+
+    void updateEntryOffset(const UUID& id, uint64_t offset);
 
 };
 
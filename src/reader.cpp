@@ -1,6 +1,7 @@
 #include "reader.hpp"
 #include "writer.hpp"
 #include "Utility/Compression/ZstdCompressor.hpp"
+#include "DataModule/Image/imageData.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -8,6 +9,8 @@
 #include <expected>
 #include <nlohmann/json.hpp>
 #include <optional>
+#include <spanstream>
+#include <type_traits>
 
 using namespace std;
 
@@ -20,11 +23,26 @@ Result Reader::openFile(const std::string& filename, std::string password) {
     // Reset header
     header = Header();
     xrefTable = XRefTable();
-    loadedModules.clear();
+    moduleCache.clear();
+    wholeSealedImages.clear();
+
+    // Schemas edited since the last file was opened are picked up by this one
+    SchemaRegistry::shared().revalidate();
 
     // UMDFFile opens the stream
     fileStream.open(filename, std::ios::in | std::ios::out | std::ios::binary);
     if (!fileStream.is_open()) return Result{false, "Failed to open file"};
+    filePath = filename;
+
+    if (readMode == ReadMode::MemoryMapped) {
+        try {
+            mappedFile = std::make_unique<MappedFile>(filename);
+        }
+        catch (const std::exception& e) {
+            closeFile();
+            return Result{false, "Failed to map file: " + string(e.what())};
+        }
+    }
     
     // Read header and confirm UMDF
     auto headerResult = header.readPrimaryHeader(fileStream);
@@ -43,14 +61,27 @@ Result Reader::openFile(const std::string& filename, std::string password) {
     }
 
     try {
-        // Read XREF table
-        xrefTable = XRefTable::loadXrefTable(fileStream);
+        // Read the XREF table of the last commit, a writer may be appending after it
+        uint64_t committedSize = 0;
+        xrefTable = XRefTable::recoverXrefTable(fileStream, committedSize);
     }
     catch (const std::exception& e) {
         closeFile();
         return Result{false, "Failed to read XREF table: " + string(e.what())};
     }
 
+    if (xrefTable.getDictionarySize() > 0) {
+        try {
+            fileStream.seekg(xrefTable.getDictionaryOffset());
+            dictionaries = std::make_shared<const DictionaryTable>(
+                DictionaryTable::read(fileStream, xrefTable.getDictionarySize()));
+        }
+        catch (const std::exception& e) {
+            closeFile();
+            return Result{false, "Failed to read dictionary table: " + string(e.what())};
+        }
+    }
+
     try {
         // Read ModuleGraph
         fileStream.seekg(xrefTable.getModuleGraphOffset());
@@ -80,7 +111,12 @@ Result Reader::closeFile() {
     if (fileStream.is_open()) {
 
         xrefTable.clear();
-        loadedModules.clear();
+        moduleCache.clear();
+        wholeSealedImages.clear();
+
+        // Cached modules may hold views into the mapping, so unmap after them
+        mappedFile.reset();
+        dictionaries.reset();
 
         fileStream.close();
     }
@@ -132,59 +168,343 @@ nlohmann::json Reader::getFileInfo() {
 std::expected<ModuleData, std::string> Reader::getModuleData(
     const std::string& moduleId) {
 
-    if (!fileStream.is_open()) {
-        return std::unexpected("No file is currently open");  // Error case
+    UUID id;
+    try {
+        id = UUID::fromString(moduleId);
     }
-    
-    // Find the module in the loadedModules vector
-    for (const auto& module : loadedModules) {
-        if (module->getModuleID().toString() == moduleId) {
-            return module->getModuleData();  // Success case
+    catch (const std::exception&) {
+        return std::unexpected("Invalid module ID: " + moduleId);
+    }
+    return getModuleData(id);
+}
+
+std::expected<ModuleData, std::string> Reader::getModuleData(const UUID& moduleId) {
+
+    auto module = getLoadedModule(moduleId);
+    if (!module) {
+        return std::unexpected(module.error());
+    }
+
+    ModuleData data = module.value()->getModuleData();
+
+    // Frames are decoded on first access
+    moduleCache.refresh(moduleId);
+    return data;
+}
+
+std::expected<std::span<const std::byte>, std::string> Reader::getFrameView(
+    const std::string& moduleId, size_t frameIndex) {
+
+    UUID id;
+    try {
+        id = UUID::fromString(moduleId);
+    }
+    catch (const std::exception&) {
+        return std::unexpected("Invalid module ID: " + moduleId);
+    }
+
+    auto module = getLoadedModule(id);
+    if (!module) {
+        return std::unexpected(module.error());
+    }
+
+    auto* image = dynamic_cast<ImageData*>(module.value());
+    if (!image) {
+        return std::unexpected("Module is not an image: " + moduleId);
+    }
+
+    try {
+        auto view = image->getFramePixelView(frameIndex);
+        moduleCache.refresh(id);
+        return view;
+    }
+    catch (const std::exception& e) {
+        return std::unexpected("Error reading frame: " + string(e.what()));
+    }
+}
+
+std::expected<ModuleData, std::string> Reader::getFrame(const std::string& moduleId, size_t frameIndex) {
+
+    auto frames = getFrames(moduleId, frameIndex, 1);
+    if (!frames) {
+        return std::unexpected(frames.error());
+    }
+    return std::move(frames.value()[0]);
+}
+
+template <typename FromModule, typename FromIndex>
+auto Reader::withImageFrames(const std::string& moduleId, size_t firstFrame, size_t frameCount,
+                             const std::string& what, FromModule fromModule, FromIndex fromIndex)
+    -> std::expected<std::invoke_result_t<FromModule&, ImageData&>, std::string> {
+
+    auto found = findImageEntry(moduleId);
+    if (!found) {
+        return std::unexpected(found.error());
+    }
+    const XrefEntry* entry = found.value();
+
+    try {
+        ImageData* indexed = nullptr;
+        if (!moduleCache.contains(entry->id)) {
+            auto image = getFrameIndex(*entry);
+            if (!image) {
+                return std::unexpected(image.error());
+            }
+            indexed = image.value();
+        }
+
+        // Cached modules, and encrypted ones sealed as a whole, are served from the loaded module
+        if (!indexed) {
+            auto module = getLoadedModule(entry->id);
+            if (!module) {
+                return std::unexpected(module.error());
+            }
+
+            auto* image = static_cast<ImageData*>(module.value());
+            size_t total = static_cast<size_t>(image->getFrameCount());
+            if (firstFrame > total || frameCount > total - firstFrame) {
+                return std::unexpected("Frame range out of bounds for module: " + moduleId);
+            }
+
+            auto result = fromModule(*image);
+            moduleCache.refresh(entry->id);
+            return result;
         }
+
+        size_t total = indexed->getIndexedFrameCount();
+        if (firstFrame > total || frameCount > total - firstFrame) {
+            return std::unexpected("Frame range out of bounds for module: " + moduleId);
+        }
+
+        if (mappedFile) {
+            auto bytes = mappedFile->bytes(entry->offset, entry->size);
+            ispanstream stream(span<const char>(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+            return fromIndex(*indexed, stream, bytes);
+        }
+        return fromIndex(*indexed, fileStream, span<const std::byte>());
+    }
+    catch (const std::exception& e) {
+        fileStream.clear();
+        return std::unexpected("Error reading " + what + ": " + string(e.what()));
     }
+}
 
-    // If the module is not found, load it from the file
-    for (const auto& entry : xrefTable.getEntries()) {
-        if (entry.id.toString() == moduleId) {
-            auto moduleResult = loadModule(entry.offset, entry.size, static_cast<ModuleType>(entry.type));
-            if (moduleResult) {
-                loadedModules.push_back(std::move(moduleResult.value()));
-                return loadedModules.back()->getModuleData();
+std::expected<std::vector<ModuleData>, std::string> Reader::getFrames(
+    const std::string& moduleId, size_t firstFrame, size_t frameCount) {
+
+    return withImageFrames(moduleId, firstFrame, frameCount, "frames",
+        [&](ImageData& image) {
+            vector<ModuleData> frames;
+            frames.reserve(frameCount);
+            for (size_t i = firstFrame; i < firstFrame + frameCount; ++i) {
+                frames.push_back(image.getFrame(i));
             }
-            else {
-                cout << "Error loading module: " << moduleResult.error() << endl;
-                return std::unexpected("Error loading module: " + moduleResult.error());
+            return frames;
+        },
+        [&](ImageData& image, std::istream& in, span<const std::byte>) {
+            vector<ModuleData> frames;
+            frames.reserve(frameCount);
+            for (size_t i = firstFrame; i < firstFrame + frameCount; ++i) {
+                frames.push_back(image.readFrame(in, i));
+            }
+            return frames;
+        });
+}
+
+std::expected<FramePreview, std::string> Reader::getFramePreview(
+    const std::string& moduleId, size_t frameIndex, uint32_t maxSide) {
+
+    return withImageFrames(moduleId, frameIndex, 1, "frame preview",
+        [&](ImageData& image) {
+            return image.getFramePreview(frameIndex, maxSide);
+        },
+        [&](ImageData& image, std::istream& in, span<const std::byte>) {
+            return image.readFramePreview(in, frameIndex, maxSide);
+        });
+}
+
+std::expected<FrameRegion, std::string> Reader::getFrameRegion(
+    const std::string& moduleId, size_t frameIndex, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+
+    return withImageFrames(moduleId, frameIndex, 1, "frame region",
+        [&](ImageData& image) {
+            return image.getFrameRegion(frameIndex, x, y, width, height);
+        },
+        [&](ImageData& image, std::istream& in, span<const std::byte> mapped) {
+            // Mapped modules are decoded in place rather than through the stream
+            if (!mapped.empty()) {
+                return image.readFrameRegion(mapped, frameIndex, x, y, width, height);
             }
+            return image.readFrameRegion(in, frameIndex, x, y, width, height);
+        });
+}
+
+std::expected<const XrefEntry*, std::string> Reader::findImageEntry(const std::string& moduleId) const {
+
+    if (!fileStream.is_open()) {
+        return std::unexpected("No file is currently open");
+    }
+
+    const XrefEntry* entry = nullptr;
+    try {
+        entry = xrefTable.findEntry(UUID::fromString(moduleId));
+    }
+    catch (const std::exception&) {
+        return std::unexpected("Invalid module ID: " + moduleId);
+    }
+    if (!entry) {
+        return std::unexpected("Module not found: " + moduleId);
+    }
+    if (static_cast<ModuleType>(entry->type) != ModuleType::Image) {
+        return std::unexpected("Module is not an image: " + moduleId);
+    }
+    return entry;
+}
+
+std::expected<ImageData*, std::string> Reader::getFrameIndex(const XrefEntry& entry) {
+
+    if (DataModule* cached = moduleCache.findFrameIndex(entry.id)) {
+        return static_cast<ImageData*>(cached);
+    }
+    if (wholeSealedImages.contains(entry.id)) {
+        return nullptr;
+    }
+
+    if (header.getEncryptionData().encryptionType != EncryptionType::NONE) {
+        // Only modules with individually sealed frames can be read frame by frame
+        DataHeader moduleHeader;
+        moduleHeader.setEncryptionData(header.getEncryptionData());
+        if (mappedFile) {
+            moduleHeader.readDataHeader(mappedFile->bytes(entry.offset, entry.size));
+        }
+        else {
+            fileStream.seekg(entry.offset);
+            moduleHeader.readDataHeader(fileStream);
+        }
+
+        if (!moduleHeader.getEncryptionData().framesSealed) {
+            wholeSealedImages.insert(entry.id);
+            return nullptr;
         }
     }
 
+    unique_ptr<DataModule> dm;
+    if (mappedFile) {
+        // Positions are relative to the module so that they match getFrames()
+        auto bytes = mappedFile->bytes(entry.offset, entry.size);
+        ispanstream stream(span<const char>(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+        dm = DataModule::metadataFromStream(stream, entry.offset, ModuleType::Image, header.getEncryptionData(), dictionaries);
+        if (dm) {
+            static_cast<ImageData*>(dm.get())->readFrameIndex(stream);
+        }
+    }
+    else {
+        fileStream.seekg(entry.offset);
+        dm = DataModule::metadataFromStream(fileStream, entry.offset, ModuleType::Image, header.getEncryptionData(), dictionaries);
+        if (dm) {
+            static_cast<ImageData*>(dm.get())->readFrameIndex(fileStream);
+        }
+    }
+
+    if (!dm || dm->getModuleType() != ModuleType::Image) {
+        return std::unexpected("Module is not an image: " + entry.id.toString());
+    }
+
+    return static_cast<ImageData*>(moduleCache.insertFrameIndex(std::move(dm)));
+}
+
+std::expected<std::unique_ptr<ImageFrameStream>, std::string> Reader::openFrameStream(
+    const std::string& moduleId, size_t readAheadBytes) {
+
+    if (!fileStream.is_open()) {
+        return std::unexpected("No file is currently open");
+    }
+
+    const XrefEntry* entry = nullptr;
+    try {
+        entry = xrefTable.findEntry(UUID::fromString(moduleId));
+    }
+    catch (const std::exception&) {
+        return std::unexpected("Invalid module ID: " + moduleId);
+    }
+    if (!entry) {
+        return std::unexpected("Module not found: " + moduleId);
+    }
+
+    if (static_cast<ModuleType>(entry->type) != ModuleType::Image) {
+        return std::unexpected("Module is not an image: " + moduleId);
+    }
+    try {
+        return std::make_unique<ImageFrameStream>(
+            filePath, entry->offset, header.getEncryptionData(), dictionaries, readAheadBytes);
+    }
+    catch (const std::exception& e) {
+        return std::unexpected("Error opening frame stream: " + string(e.what()));
+    }
+}
 
-    return std::unexpected("Module not found: " + moduleId);
+std::expected<DataModule*, std::string> Reader::getLoadedModule(const UUID& moduleId) {
+
+    if (!fileStream.is_open()) {
+        return std::unexpected("No file is currently open");  // Error case
+    }
+    
+    if (DataModule* module = moduleCache.find(moduleId)) {
+        return module;  // Success case
+    }
+
+    // If the module is not found, load it from the file
+    const XrefEntry* entry = xrefTable.findEntry(moduleId);
+    if (!entry) {
+        return std::unexpected("Module not found: " + moduleId.toString());
+    }
+
+    auto moduleResult = loadModule(entry->offset, entry->size, static_cast<ModuleType>(entry->type));
+    if (!moduleResult) {
+        cout << "Error loading module: " << moduleResult.error() << endl;
+        return std::unexpected("Error loading module: " + moduleResult.error());
+    }
+
+    return moduleCache.insert(std::move(moduleResult.value()));
 }
 
-std::expected<unique_ptr<DataModule>, std::string> Reader::loadModule(uint64_t offset, uint32_t size, ModuleType type) {
+std::expected<unique_ptr<DataModule>, std::string> Reader::loadModule(uint64_t offset, uint64_t size, ModuleType type) {
 
      if (size <= MAX_IN_MEMORY_MODULE_SIZE) {
-        vector<char> buffer(size);
-        fileStream.seekg(offset);
-        fileStream.read(buffer.data(), size);
-        istringstream stream(string(buffer.begin(), buffer.end()));
 
         // Reset ZSTD statistics for this module
         ZstdCompressor::resetStatistics();
 
         unique_ptr<DataModule> dm;
         try {
-            dm = DataModule::fromStream(stream, offset, type, header.getEncryptionData());
+            if (mappedFile) {
+                // Parse in place, no copy of the module is made
+                dm = DataModule::fromStream(mappedFile->bytes(offset, size), offset, type, header.getEncryptionData(), dictionaries);
+            }
+            else if (header.getEncryptionData().encryptionType != EncryptionType::NONE) {
+                // Opened a segment at a time straight from the file, the ciphertext is never held whole
+                fileStream.clear();
+                fileStream.seekg(offset);
+                dm = DataModule::fromStream(fileStream, offset, type, header.getEncryptionData(), dictionaries);
+                if (dm && static_cast<uint64_t>(fileStream.tellg()) - offset > size) {
+                    throw std::runtime_error("Module extends past its XREF entry");
+                }
+            }
+            else {
+                vector<char> buffer(size);
+                fileStream.seekg(offset);
+                fileStream.read(buffer.data(), size);
+                ispanstream stream(span<const char>(buffer.data(), buffer.size()));
+
+                dm = DataModule::fromStream(stream, offset, type, header.getEncryptionData(), dictionaries);
+            }
             if (!dm) {
                 return std::unexpected("Skipped unknown or unsupported module type: " + module_type_to_string(type));
             }
 
-            // Validate the module before storing it
-            try {
-                dm->getModuleData();  // Test if data access works
-            } catch (const std::exception& e) {
-                return std::unexpected("Module validation failed: " + string(e.what()));
+            // Parsing has checked the structure, frames stay encoded (or mapped) until requested
+            if (dm->getModuleType() != type) {
+                return std::unexpected("Module validation failed: module type does not match its XREF entry");
             }
         }
         catch (const std::exception& e) {
@@ -195,10 +515,14 @@ std::expected<unique_ptr<DataModule>, std::string> Reader::loadModule(uint64_t o
         std::cout << "Module ZSTD decompression summary:" << std::endl;
         ZstdCompressor::printSummary();
         
-        return std::move(dm);
+        return dm;
+    }
+    else if (type == ModuleType::Image) {
+        return std::unexpected("Image module of " + to_string(size) + 
+            " bytes exceeds the in-memory limit, read it with openFrameStream()");
     }
     else {
-        return std::unexpected("TODO: Handle a large DataModule");
+        return std::unexpected("Module of " + to_string(size) + " bytes exceeds the in-memory limit");
     }
 }
 
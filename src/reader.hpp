@@ -7,15 +7,35 @@
 #include <expected>
 #include <vector>
 #include <optional>
+#include <span>
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <type_traits>
 #include "Header/header.hpp"
 #include "Xref/xref.hpp"
 #include "DataModule/dataModule.hpp"
 #include "DataModule/ModuleData.hpp"
 #include "Utility/uuid.hpp"
+#include "Utility/mappedFile.hpp"
+#include "Cache/moduleCache.hpp"
+#include "DataModule/Image/imageFrameStream.hpp"
 #include "./writer.hpp"
 #include "./AuditTrail/auditTrail.hpp"
 
 
+/**
+ * @brief How the Reader accesses module bytes.
+ *
+ * Stream reads each module through the file stream into a private buffer.
+ * MemoryMapped maps the file once and parses modules in place, so RAW frames
+ * of unencrypted image modules are returned as views into the mapping.
+ */
+enum class ReadMode {
+    Stream,
+    MemoryMapped
+};
+
 /**
  * @brief Reader class for reading and accessing UMDF (Unified Medical Data Format) files.
  * 
@@ -26,7 +46,7 @@
  * 
  * Key features:
  * - File encryption support (AES-256-GCM)
- * - Lazy module loading with memory management
+ * - Lazy module loading into a byte-budgeted LRU cache
  * - Audit trail access for module modification history
  * - Cross-reference table navigation
  * - Module graph traversal for encounter-based data access
@@ -37,12 +57,23 @@ private:
     Header header;
     XRefTable xrefTable;
     ModuleGraph moduleGraph;
+
+    // Shared with the modules and frame streams that decompress metadata with it
+    std::shared_ptr<const DictionaryTable> dictionaries;
     
     static constexpr size_t MAX_IN_MEMORY_MODULE_SIZE = 512 * 1024 * 1024; // 500 MB
 
     std::ifstream fileStream;
+    std::string filePath;
 
-    std::vector<std::unique_ptr<DataModule>> loadedModules;
+    ReadMode readMode = ReadMode::Stream;
+    std::unique_ptr<MappedFile> mappedFile;
+
+    ModuleCache moduleCache;
+
+    // Encrypted image modules whose frames are not sealed individually, they
+    // are read as a whole rather than through a frame index
+    std::unordered_set<UUID> wholeSealedImages;
     std::unique_ptr<AuditTrail> auditTrail;
 
     /**
@@ -63,9 +94,53 @@ private:
      * @param size Size of the module in bytes
      * @param type Type of module to load (determines which DataModule subclass to instantiate)
      * @return std::expected containing the loaded DataModule on success, or error message on failure
+     * 
+     * @note Modules larger than MAX_IN_MEMORY_MODULE_SIZE are rejected; image
+     *       modules of that size can be read with openFrameStream()
      */
     std::expected<std::unique_ptr<DataModule>, std::string> loadModule
-        (uint64_t offset, uint32_t size, ModuleType type);
+        (uint64_t offset, uint64_t size, ModuleType type);
+
+    /**
+     * @brief Find a loaded module, loading it from the file if necessary.
+     * 
+     * @param moduleId UUID of the module
+     * @return std::expected containing the module on success, or error message on failure
+     */
+    std::expected<DataModule*, std::string> getLoadedModule(const UUID& moduleId);
+
+    /**
+     * @brief Find or read the frame index of an image module.
+     * 
+     * Only the module header, metadata and frame index are read; the frames
+     * stay on disk until requested. The index is kept in the module cache and
+     * counts towards its budget.
+     * 
+     * @param entry XREF entry of the image module
+     * @return std::expected containing the indexed image on success, nullptr if the
+     *         module is encrypted as a whole and has to be loaded completely, or
+     *         error message on failure
+     */
+    std::expected<ImageData*, std::string> getFrameIndex(const XrefEntry& entry);
+
+    // XREF entry of an image module, or why there is none
+    std::expected<const XrefEntry*, std::string> findImageEntry(const std::string& moduleId) const;
+
+    /**
+     * @brief Shared lookup behind the frame accessors.
+     * 
+     * Finds the image module and checks the frame range. Loaded modules
+     * (cached, or encrypted as a whole) are passed to fromModule; otherwise the
+     * frame index is passed to fromIndex together with a stream over the
+     * module and, when the file is mapped, the module's bytes.
+     * 
+     * @param what Names the request in error messages
+     * @return std::expected containing the callback's result on success, or error message on failure
+     */
+    template <typename FromModule, typename FromIndex>
+    auto withImageFrames(const std::string& moduleId, size_t firstFrame, size_t frameCount,
+                         const std::string& what, FromModule fromModule, FromIndex fromIndex)
+        -> std::expected<std::invoke_result_t<FromModule&, ImageData&>, std::string>;
 
 public:
 
@@ -78,11 +153,134 @@ public:
      * @param moduleId String representation of the module UUID
      * @return std::expected containing ModuleData on success, or error message on failure
      * 
-     * @note This method will load the module into memory if not already cached
+     * @note This method will load the module into memory if not already cached,
+     *       which may evict other modules to stay within the cache budget
      */
     std::expected<ModuleData, std::string> getModuleData(const std::string& moduleId);
+
+    /**
+     * @brief Retrieve module data by module UUID.
+     * 
+     * Same as getModuleData(const std::string&) without the string round trip.
+     * 
+     * @param moduleId UUID of the module
+     * @return std::expected containing ModuleData on success, or error message on failure
+     */
+    std::expected<ModuleData, std::string> getModuleData(const UUID& moduleId);
     
 
+    /**
+     * @brief Retrieve a single decoded frame of an image module.
+     * 
+     * Seeks straight to the frame through the module's frame index and decodes
+     * only that frame, so the rest of the module is never read. Encrypted images
+     * open just that frame's sealed segment. Modules that are already loaded, or
+     * that were encrypted as a whole, are served from the module cache.
+     * 
+     * @param moduleId String representation of the image module UUID
+     * @param frameIndex Zero-based frame index
+     * @return std::expected containing the frame metadata and pixels on success, or error message on failure
+     */
+    std::expected<ModuleData, std::string> getFrame(const std::string& moduleId, size_t frameIndex);
+
+    /**
+     * @brief Retrieve a contiguous range of decoded frames of an image module.
+     * 
+     * @param moduleId String representation of the image module UUID
+     * @param firstFrame Zero-based index of the first frame
+     * @param frameCount Number of frames to return
+     * @return std::expected containing the frames in order on success, or error message on failure
+     * 
+     * @see getFrame
+     */
+    std::expected<std::vector<ModuleData>, std::string> getFrames(
+        const std::string& moduleId, size_t firstFrame, size_t frameCount);
+
+    /**
+     * @brief Retrieve a downscaled copy of a single frame, e.g. for thumbnails.
+     * 
+     * JPEG 2000 frames decode only the resolution levels the preview needs,
+     * which costs a fraction of a full decode. Whatever reduction is left, and
+     * all of it for other codecs, is done with a box filter. The module cache
+     * is used like in getFrame(), but cached frames are not decoded by it.
+     * 
+     * @param moduleId String representation of the image module UUID
+     * @param frameIndex Zero-based frame index
+     * @param maxSide Upper bound for the preview width and height
+     * @return std::expected containing the preview on success, or error message on failure
+     */
+    std::expected<FramePreview, std::string> getFramePreview(
+        const std::string& moduleId, size_t frameIndex, uint32_t maxSide);
+
+    /**
+     * @brief Retrieve a rectangular region of a single frame at full resolution.
+     * 
+     * JPEG 2000 frames decode only the code-blocks the region overlaps. RAW
+     * frames are sliced row by row, in ReadMode::MemoryMapped straight out of
+     * the mapped file. Other codecs decode the frame and copy the region out.
+     * 
+     * @param moduleId String representation of the image module UUID
+     * @param frameIndex Zero-based frame index
+     * @param x Left edge of the region in pixels
+     * @param y Top edge of the region in pixels
+     * @param width Region width in pixels
+     * @param height Region height in pixels
+     * @return std::expected containing the region on success, or error message on failure,
+     *         including regions that are empty or reach outside the frame
+     */
+    std::expected<FrameRegion, std::string> getFrameRegion(
+        const std::string& moduleId, size_t frameIndex, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+    /**
+     * @brief Set the memory budget of the loaded module cache.
+     * 
+     * Least recently used modules are evicted once the decoded and encoded
+     * bytes held by loaded modules exceed the budget. Lowering the budget
+     * evicts immediately.
+     * 
+     * @param bytes Budget in bytes
+     */
+    void setCacheBudget(size_t bytes) { moduleCache.setBudget(bytes); }
+
+    /**
+     * @brief Hit, miss and eviction counters and current usage of the module cache.
+     */
+    ModuleCacheStats getCacheStatistics() const { return moduleCache.getStatistics(); }
+
+    /**
+     * @brief Borrow the decoded pixels of a single image frame.
+     * 
+     * In ReadMode::MemoryMapped, RAW frames of unencrypted modules are returned
+     * as a view straight into the mapped file without any copy. Otherwise the
+     * view refers to the frame buffer held by the loaded module.
+     * 
+     * @param moduleId String representation of the image module UUID
+     * @param frameIndex Zero-based frame index
+     * @return std::expected containing the pixel view on success, or error message on failure
+     * 
+     * @note The view is invalidated by closeFile() and, unless it points into
+     *       the mapping, by the module being evicted from the cache
+     */
+    std::expected<std::span<const std::byte>, std::string> getFrameView(
+        const std::string& moduleId, size_t frameIndex);
+
+    /**
+     * @brief Open a sequential frame stream over an image module.
+     * 
+     * The module header and metadata are decoded immediately and frames are then
+     * read one at a time, so peak memory is one frame plus the read-ahead buffer
+     * regardless of the module size. This is the way to read image modules larger
+     * than the in-memory limit used by getModuleData().
+     * 
+     * @param moduleId String representation of the image module UUID
+     * @param readAheadBytes Size of the file read-ahead buffer
+     * @return std::expected containing the frame stream on success, or error message on failure
+     * 
+     * @note Encrypted modules can only be streamed if their frames are sealed individually
+     */
+    std::expected<std::unique_ptr<ImageFrameStream>, std::string> openFrameStream(
+        const std::string& moduleId, size_t readAheadBytes = ImageFrameStream::DEFAULT_READ_AHEAD);
+
      /**
      * @brief Get the complete audit trail for a specific module.
      * 
@@ -105,6 +303,16 @@ public:
     std::expected<ModuleData, std::string> getAuditData(const ModuleTrail& module);
     
     // File management
+    /**
+     * @brief Select how module bytes are read.
+     * 
+     * @param mode ReadMode::Stream (default) or ReadMode::MemoryMapped
+     * 
+     * @note Takes effect the next time openFile() is called
+     */
+    void setReadMode(ReadMode mode) { readMode = mode; }
+    ReadMode getReadMode() const { return readMode; }
+
     /**
      * @brief Open a UMDF file for reading.
      * 
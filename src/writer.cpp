@@ -11,7 +11,9 @@
 
 #include "Utility/utils.hpp"
 #include "Utility/uuid.hpp"
+#include "Utility/threadPool.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -45,6 +47,9 @@ Result Writer::createNewFile(std::string& filename, string author, string passwo
     std::ofstream touch(filename, std::ios::app);
     }
 
+    // Schemas edited since the last file was opened are picked up by this one
+    SchemaRegistry::shared().revalidate();
+
     // Set up file stream
     Result result = setUpFileStream(filename);
     if (!result.success) {
@@ -56,11 +61,12 @@ Result Writer::createNewFile(std::string& filename, string author, string passwo
     if (password != "") {
         EncryptionData encryptionData;
         encryptionData.masterPassword = password;
-        encryptionData.encryptionType = EncryptionType::AES_256_GCM;
+        encryptionData.encryptionType = EncryptionManager::selectCipher();
         encryptionData.baseSalt = EncryptionManager::generateSalt(16); // Use correct Argon2id salt size
         encryptionData.memoryCost = 65536;
         encryptionData.timeCost = 3;
         encryptionData.parallelism = 2;
+        encryptionData.masterKey = EncryptionManager::deriveMasterKey(encryptionData);
 
         header.setEncryptionData(encryptionData);
     }
@@ -96,6 +102,8 @@ Result Writer::openFile(std::string& filename, string author, string password) {
         return Result{false, "A file is already open"};
     }
 
+    newFile = false;
+
     // Check if file exists
     if (!std::filesystem::exists(filename)) {
         return Result{false, "File does not exist"};
@@ -106,6 +114,8 @@ Result Writer::openFile(std::string& filename, string author, string password) {
         return Result{false, "File is empty"};
     }
 
+    SchemaRegistry::shared().revalidate();
+
     Result result = setUpFileStream(filename);
     if (!result.success) {
         cancelThenClose();
@@ -114,10 +124,18 @@ Result Writer::openFile(std::string& filename, string author, string password) {
 
     this->author = author;
 
-    // Read header from temp file
+    // Read header from file
     if (!header.readPrimaryHeader(fileStream)) {
         cancelThenClose();
-        return Result{false, "Failed to read header from temp file"};
+        return Result{false, "Failed to read header from file"};
+    }
+
+    // In-place commits add 1.1 TLVs (frame index offsets, segment sizes) that a 1.0 magic
+    // line does not announce, and the magic cannot be bumped without changing the key scheme
+    if (header.predatesCurrentVersion()) {
+        std::string version = header.getFileVersion().toString();
+        cancelThenClose();
+        return Result{false, "UMDF " + version + " files cannot be written in place, copy their modules into a new file"};
     }
 
     if (header.getEncryptionData().encryptionType != EncryptionType::NONE) {
@@ -130,13 +148,47 @@ Result Writer::openFile(std::string& filename, string author, string password) {
         }
     }
     
-    // Load XRef table from temp file
+    // Load the XRef table of the last commit
     xrefTable.clear();
     try {
-        xrefTable = XRefTable::loadXrefTable(fileStream);
+        xrefTable = XRefTable::recoverXrefTable(fileStream, committedSize);
     } catch (const std::exception& e) {
         cancelThenClose();
-        return Result{false, "Failed to load XRef table from temp file: " + std::string(e.what())};
+        return Result{false, "Failed to load XRef table: " + std::string(e.what())};
+    }
+
+    // Drop what an interrupted commit left after the last footer, new data is appended there.
+    // A complete footer in that tail means a finished commit the table could not be read
+    // from, so the file is left alone rather than cut back to an older commit.
+    try {
+        if (std::filesystem::file_size(filePath) > committedSize) {
+            if (XRefTable::hasFooterAfter(fileStream, committedSize)) {
+                committedSize = 0;
+                cancelThenClose();
+                return Result{false, "File ends in a commit whose XRef table cannot be read"};
+            }
+            fileStream.close();
+            std::filesystem::resize_file(filePath, committedSize);
+            fileStream.open(filePath, std::ios::binary | std::ios::in | std::ios::out);
+            if (!fileStream) {
+                throw std::runtime_error(std::strerror(errno));
+            }
+        }
+    } catch (const std::exception& e) {
+        committedSize = 0;
+        cancelThenClose();
+        return Result{false, "Failed to discard incomplete commit: " + std::string(e.what())};
+    }
+
+    // Modules already in the file keep the dictionaries they were written with
+    if (xrefTable.getDictionarySize() > 0) {
+        try {
+            fileStream.seekg(xrefTable.getDictionaryOffset());
+            dictionaries = DictionaryTable::read(fileStream, xrefTable.getDictionarySize());
+        } catch (const std::exception& e) {
+            cancelThenClose();
+            return Result{false, "Failed to read dictionary table: " + std::string(e.what())};
+        }
     }
 
     try {
@@ -169,6 +221,11 @@ Result Writer::addModule(const std::string& schemaPath, UUID moduleId, const Mod
         return Result{false, "No file is open"};
     }
 
+    // Modules are written back to back, the streamed image must be finished first
+    if (streamingImage) {
+        return Result{false, "An image module is being streamed, finish it first"};
+    }
+
     try {
         auto result = writeModule(fileStream, schemaPath, moduleId, module, header.getEncryptionData());
         if (!result.success) {
@@ -184,72 +241,93 @@ Result Writer::addModule(const std::string& schemaPath, UUID moduleId, const Mod
 
 Result Writer::updateModule(const std::string& moduleId, const ModuleData& module) {
 
+    UUID id;
+    try {
+        id = UUID::fromString(moduleId);
+    }
+    catch (const std::exception&) {
+        return Result{false, "Invalid module ID: " + moduleId};
+    }
+    return updateModule(id, module);
+}
+
+Result Writer::updateModule(const UUID& moduleId, const ModuleData& module) {
+
     // Check if file stream is open
     if (!fileStream.is_open()) {
         return Result{false, "No file is open"};
     }
 
-    auto& entries = xrefTable.getEntries();
-    for (auto it = entries.begin(); it != entries.end(); ) {
-        if (it->id.toString() == moduleId) {
-            // Go to module offset in file
-            fileStream.seekg(it->offset);
-    
-            // Create the DataHeader
-            DataHeader dataHeader;
-            dataHeader.setEncryptionData(header.getEncryptionData());
-            dataHeader.readDataHeader(fileStream);
-            dataHeader.setModuleID(UUID::fromString(moduleId));
-
-            // Return to the start of the module
-            fileStream.seekg(it->offset);
-    
-            // Update the module's isCurrent flag to false
-            dataHeader.updateIsCurrent(false, fileStream);
-    
-            // Write the new module data
-            unique_ptr<DataModule> dm;
-    
-            switch (dataHeader.getModuleType()) {
-                case ModuleType::Image: {
-                    dm = make_unique<ImageData>(dataHeader.getSchemaPath(), dataHeader);
-                    break;
-                }
-                case ModuleType::Tabular: {
-                    dm = make_unique<TabularData>(dataHeader.getSchemaPath(), dataHeader);
-                    break;
-                }
-                default:
+    if (streamingImage) {
+        return Result{false, "An image module is being streamed, finish it first"};
+    }
+
+    // Copy the entry, writing the new module replaces it in the xref table
+    const XrefEntry* found = xrefTable.findEntry(moduleId);
+    if (!found) {
+        return Result{false, "Module not found: " + moduleId.toString()};
+    }
+    const XrefEntry entry = *found;
+
+    // Ensure at end of file
+    fileStream.seekp(0, std::ios::end);
+    streampos moduleStart = fileStream.tellp();
+
+    // Until the new module is written, the xref entry and supersededModules
+    // must keep pointing at the old one as the only valid copy
+    try {
+        // Go to module offset in file
+        fileStream.seekg(entry.offset);
+
+        // Create the DataHeader
+        DataHeader dataHeader;
+        dataHeader.setEncryptionData(header.getEncryptionData());
+        dataHeader.readDataHeader(fileStream);
+        dataHeader.setModuleID(moduleId);
+
+        // Write the new module data
+        unique_ptr<DataModule> dm;
 
-                    return Result{false, "Invalid module type"};
+        switch (dataHeader.getModuleType()) {
+            case ModuleType::Image: {
+                dm = make_unique<ImageData>(dataHeader.getSchemaPath(), dataHeader);
+                break;
             }
-    
-            // Set the previous offset as the offset of the old module 
-            dm->setPrevious(it->offset);
-    
-            // // Delete the old module from the xref table - This is now handled in the writeBinary function
-            // it = entries.erase(it);
-    
-            dm->addMetaData(module.metadata);
-            dm->addData(module.data);
-    
-            // Ensure at end of file
-            fileStream.seekp(0, std::ios::end);
+            case ModuleType::Tabular: {
+                dm = make_unique<TabularData>(dataHeader.getSchemaPath(), dataHeader);
+                break;
+            }
+            default:
 
-            streampos moduleStart = fileStream.tellp();
-    
-            std::stringstream moduleBuffer;
-            dm->writeBinary(moduleStart, moduleBuffer, xrefTable, this->author);
+                return Result{false, "Invalid module type"};
+        }
 
-            string bufferData = moduleBuffer.str();
-            fileStream.write(reinterpret_cast<char*>(bufferData.data()), bufferData.size());
+        // Set the previous offset as the offset of the old module 
+        dm->setPrevious(entry.offset);
+        dm->applyCompressionPolicy(compressionPolicy);
+        dm->setMetadataDictionary(metadataDictionary);
 
-            // Since we found and processed the module, we can break
-            break;
-        } else {
-            ++it;  // Move to next element
+        dm->addMetaData(module.metadata);
+        dm->addData(module.data);
+
+        // The old module is replaced in the xref table by writeBinary, which
+        // writes straight to the file, a failure is cut off again below
+        fileStream.seekp(moduleStart);
+        dm->writeBinary(moduleStart, fileStream, xrefTable, this->author);
+        if (!fileStream) {
+            throw std::runtime_error("Failed to write module to file");
         }
     }
+    catch (const std::exception& e) {
+        fileStream.clear();
+        xrefTable.addEntry(static_cast<ModuleType>(entry.type), entry.id, entry.offset, entry.size, entry.schemaPath);
+        discardFrom(moduleStart);
+        return Result{false, "Exception updating module: " + std::string(e.what())};
+    }
+
+    // The old version is flagged as such once the new one is committed
+    supersededModules.push_back(entry.offset);
+    hasChanges = true;
 
     return Result{true, "Module updated successfully"};
 
@@ -262,7 +340,7 @@ Result Writer::cancelThenClose() {
         return Result{false, "No file is open"};
     }
 
-    removeTempFile();
+    discardUncommitted();
     resetWriter();
     releaseFileLock();
     return Result{true, "File closed successfully"};
@@ -276,6 +354,22 @@ Result Writer::closeFile() {
         return Result{false, "No file is open"};
     }
 
+    // A module without all its frames is not part of the file
+    if (streamingImage) {
+        abandonImageModule();
+    }
+
+    // Existing files are committed in place
+    if (!newFile) {
+        Result result = commitInPlace();
+        if (!result.success) {
+            discardUncommitted();
+        }
+        resetWriter();
+        releaseFileLock();
+        return result;
+    }
+
     // Check XrefTable is not empty
     if (xrefTable.getEntries().empty()) {
         // No modules to write so delete temp file
@@ -295,6 +389,29 @@ Result Writer::closeFile() {
         return Result{false, "Empty temp file, so removed"};
     }
 
+    // Flag modules replaced in this session, the temp file is not visible yet
+    try {
+        flagSupersededModules();
+    } catch (const std::exception& e) {
+        fileStream.close();
+        removeTempFile();
+        return Result{false, "Exception flagging replaced modules: " + std::string(e.what())};
+    }
+
+    // Rewrite the dictionary table in full, the previous one becomes unreachable
+    try {
+        xrefTable.setDictionaryOffset(0);
+        xrefTable.setDictionarySize(0);
+        if (!dictionaries.empty()) {
+            xrefTable.setDictionaryOffset(fileStream.tellp());
+            xrefTable.setDictionarySize(dictionaries.write(fileStream));
+        }
+    } catch (const std::exception& e) {
+        fileStream.close();
+        removeTempFile();
+        return Result{false, "Exception writing dictionary table: " + std::string(e.what())};
+    }
+
     streampos moduleGraphOffset = fileStream.tellp();
 
     // Write module graph to temp file
@@ -310,12 +427,8 @@ Result Writer::closeFile() {
         removeTempFile();
         return Result{false, "Exception writing module graph: " + std::string(e.what())};
     }
-    // Make old XREF table obsolete and write new one
+    // Write XREF table
     try {
-        if (!newFile) {
-            xrefTable.setObsolete(fileStream);
-        }
-
         if (!writeXref(fileStream)) {
             return Result{false, "Failed to write XREF table to temp file"};
         }
@@ -362,6 +475,12 @@ void Writer::resetWriter() {
     tempFilePath.clear();
     filePath.clear();
     moduleGraph = ModuleGraph();
+    dictionaries.clear();
+    metadataDictionary.reset();
+    committedSize = 0;
+    supersededModules.clear();
+    hasChanges = false;
+    streamingImage.reset();
     // author.clear();
 }
 
@@ -380,23 +499,17 @@ Result Writer::setUpFileStream(std::string& filename) {
     }
 
     filePath = filename;
-    tempFilePath = filename + ".tmp";
-
 
-    // Create new temp file
+    // Existing files are appended to in place, see commitInPlace()
     if (!newFile) {
-        // Copy original file to temp file
-        if (std::filesystem::exists(tempFilePath)) {
-            std::filesystem::remove(tempFilePath);
-        }
-        std::filesystem::copy_file(filename, tempFilePath);
-
-        fileStream.open(tempFilePath, std::ios::binary | std::ios::in | std::ios::out);
+        fileStream.open(filename, std::ios::binary | std::ios::in | std::ios::out);
         if (!fileStream) {   
-            return Result{false, "Failed to open temp file: " + std::string(std::strerror(errno))};
+            return Result{false, "Failed to open file: " + std::string(std::strerror(errno))};
         }
     }
     else {    
+        // New files are written to a temp file that is renamed into place when closed
+        tempFilePath = filename + ".tmp";
         fileStream.open(tempFilePath, std::ios::binary | std::ios::out | std::ios::trunc);
         if (!fileStream) {   
             return Result{false, "Failed to open temp file: " + std::string(std::strerror(errno))};
@@ -419,6 +532,7 @@ std::expected<UUID, std::string> Writer::createNewEncounter() {
         return std::unexpected("No file is open");
     }
     
+    hasChanges = true;
     return moduleGraph.createEncounter();
 }
 
@@ -526,6 +640,218 @@ std::expected<UUID, std::string> Writer::addAnnotation(
 /* =============== WRITER HELPER FUNCTIONS =============== */
 /* ======================================================= */
 
+std::expected<UUID, std::string> Writer::beginImageModule(
+    const UUID& encounterId, const std::string& schemaPath, const nlohmann::json& metadata) {
+
+    // Check if file stream is open
+    if (!fileStream.is_open()) {
+        return std::unexpected("No file is open");
+    }
+
+    if (streamingImage) {
+        return std::unexpected("An image module is already being streamed");
+    }
+
+    // Check if encounter exists
+    if (!moduleGraph.encounterExists(encounterId)) {
+        return std::unexpected("Encounter ID " + encounterId.toString() + " not found");
+    }
+
+    // Sealed metadata carries the size of the data, which is only known at the end
+    if (header.getEncryptionData().encryptionType != EncryptionType::NONE) {
+        return std::unexpected("Image modules of encrypted files cannot be streamed");
+    }
+
+    UUID moduleId = UUID();
+
+    // Header and metadata go straight to the file, frames follow them
+    fileStream.seekp(0, std::ios::end);
+    streamStart = fileStream.tellp();
+
+    try {
+        auto created = createEmptyModule(schemaPath, moduleId, header.getEncryptionData());
+        if (!created) {
+            return std::unexpected(created.error());
+        }
+        if (created.value()->getModuleType() != ModuleType::Image) {
+            return std::unexpected("Schema " + schemaPath + " does not describe an image module");
+        }
+        unique_ptr<ImageData> image(static_cast<ImageData*>(created.value().release()));
+        image->addMetaData(metadata);
+        image->beginFrameStream(streamStart, fileStream, xrefTable, this->author);
+        if (!fileStream) {
+            throw runtime_error("Failed to write module header");
+        }
+
+        streamingImage = std::move(image);
+        streamEncounter = encounterId;
+    } catch (const std::exception& e) {
+        abandonImageModule();
+        return std::unexpected("Exception starting image module: " + std::string(e.what()));
+    }
+
+    return moduleId;
+}
+
+Result Writer::appendFrame(const ModuleData& frame) {
+
+    if (!streamingImage) {
+        return Result{false, "No image module is being streamed"};
+    }
+
+    streampos frameStart = fileStream.tellp();
+    try {
+        streamingImage->appendStreamFrame(fileStream, frame);
+    } catch (const std::exception& e) {
+        // Frames are validated and encoded before anything is written, such a
+        // frame is just rejected. A failed write takes the module with it.
+        if (fileStream && fileStream.tellp() == frameStart) {
+            return Result{false, "Frame rejected: " + std::string(e.what())};
+        }
+        abandonImageModule();
+        return Result{false, "Exception writing frame, image module discarded: " + std::string(e.what())};
+    }
+
+    return Result{true, "Frame written successfully"};
+}
+
+Result Writer::finishImageModule() {
+
+    if (!streamingImage) {
+        return Result{false, "No image module is being streamed"};
+    }
+
+    // Missing frames can still be appended
+    size_t expected = static_cast<size_t>(streamingImage->getFrameCount());
+    if (streamingImage->getStreamedFrameCount() != expected) {
+        return Result{false, "Image module expects " + to_string(expected) + " frames, " +
+            to_string(streamingImage->getStreamedFrameCount()) + " were appended"};
+    }
+
+    try {
+        streamingImage->finishFrameStream(fileStream, xrefTable);
+        fileStream.seekp(0, std::ios::end);
+        if (!fileStream) {
+            throw runtime_error("Failed to write frame index");
+        }
+        moduleGraph.addModuleToEncounter(streamEncounter, streamingImage->getModuleID());
+    } catch (const std::exception& e) {
+        xrefTable.deleteEntry(streamingImage->getModuleID());
+        abandonImageModule();
+        return Result{false, "Exception finishing image module: " + std::string(e.what())};
+    }
+
+    streamingImage.reset();
+    hasChanges = true;
+    return Result{true, "Image module written successfully"};
+}
+
+void Writer::abandonImageModule() {
+
+    streamingImage.reset();
+
+    // Cut the partial module off again, the file continues from where it started
+    discardFrom(streamStart);
+}
+
+void Writer::discardFrom(std::streampos offset) {
+
+    string path = newFile ? tempFilePath : filePath;
+    fileStream.close();
+    try {
+        if (std::filesystem::exists(path) &&
+            std::filesystem::file_size(path) > static_cast<uint64_t>(offset)) {
+            std::filesystem::resize_file(path, static_cast<uint64_t>(offset));
+        }
+    } catch (const std::exception& e) {
+        cerr << "Failed to discard partial write: " << e.what() << endl;
+    }
+    fileStream.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    fileStream.seekp(0, std::ios::end);
+}
+
+std::expected<std::vector<UUID>, std::string> Writer::addModules(const std::vector<BatchModule>& batch) {
+
+    // Check if file stream is open
+    if (!fileStream.is_open()) {
+        return std::unexpected("No file is open");
+    }
+
+    if (streamingImage) {
+        return std::unexpected("An image module is being streamed, finish it first");
+    }
+
+    for (const auto& entry : batch) {
+        if (!moduleGraph.encounterExists(entry.encounterId)) {
+            return std::unexpected("Encounter ID " + entry.encounterId.toString() + " not found");
+        }
+    }
+
+    vector<UUID> moduleIds(batch.size());
+    vector<XrefEntry> written;
+    written.reserve(batch.size());
+
+    fileStream.seekp(0, std::ios::end);
+    streampos batchStart = fileStream.tellp();
+
+    ZstdCompressor::resetStatistics();
+
+    // Encoded modules are held a window at a time, enough to keep every thread busy
+    ThreadPool& pool = ThreadPool::shared();
+    size_t window = std::max<size_t>(pool.getThreadCount() * 2, 1);
+
+    try {
+        for (size_t first = 0; first < batch.size(); first += window) {
+            size_t count = std::min(window, batch.size() - first);
+
+            // Modules are encoded without knowing where they will land, the
+            // offset only goes into the xref entry which is made on append
+            vector<string> encoded(count);
+            vector<XrefEntry> entries(count);
+            pool.parallelFor(count, [&](size_t i) {
+                const BatchModule& entry = batch[first + i];
+                UUID moduleId = moduleIds[first + i];
+
+                auto created = createModule(entry.schemaPath, moduleId, entry.module, header.getEncryptionData());
+                if (!created) {
+                    throw runtime_error(created.error());
+                }
+
+                std::stringstream moduleBuffer;
+                XRefTable moduleXref;
+                created.value()->writeBinary(0, moduleBuffer, moduleXref, this->author);
+                encoded[i] = std::move(moduleBuffer).str();
+                entries[i] = moduleXref.getEntry(moduleId);
+            });
+
+            for (size_t i = 0; i < count; ++i) {
+                entries[i].offset = static_cast<uint64_t>(fileStream.tellp());
+                fileStream.write(encoded[i].data(), encoded[i].size());
+                written.push_back(std::move(entries[i]));
+            }
+            if (!fileStream) {
+                throw runtime_error("Failed to write modules");
+            }
+        }
+    } catch (const std::exception& e) {
+        discardFrom(batchStart);
+        return std::unexpected("Exception adding modules: " + std::string(e.what()));
+    }
+
+    // One graph and xref update for the whole batch
+    for (size_t i = 0; i < written.size(); ++i) {
+        const XrefEntry& entry = written[i];
+        xrefTable.addEntry(static_cast<ModuleType>(entry.type), entry.id, entry.offset, entry.size, entry.schemaPath);
+        moduleGraph.addModuleToEncounter(batch[i].encounterId, entry.id);
+    }
+    hasChanges = hasChanges || !batch.empty();
+
+    std::cout << "Module ZSTD compression summary:" << std::endl;
+    ZstdCompressor::printSummary();
+
+    return moduleIds;
+}
+
 bool Writer::writeXref(std::ostream& outfile) { 
     // Explicitly seek to end of file
     outfile.seekp(0, std::ios::end);
@@ -535,22 +861,128 @@ bool Writer::writeXref(std::ostream& outfile) {
     return xrefTable.writeXref(outfile);
 }
 
-Result Writer::writeModule(
-    std::ostream& outfile, const std::string& schemaPath, 
-    UUID moduleId,
-    const ModuleData& moduleData, EncryptionData encryptionData) {
+Result Writer::commitInPlace() {
 
-    // Load schema from file
-    std::ifstream schemaFile(schemaPath);
-    if (!schemaFile.is_open()) {
-        cerr << "Failed to open schema file: " << schemaPath << endl;
-        return Result{false, "Failed to open schema file"};
+    // Nothing to publish, the file stays as it was
+    if (!hasChanges) {
+        return Result{true, "File closed successfully"};
+    }
+
+    uint64_t previousXrefOffset = xrefTable.getXrefOffset();
+
+    try {
+        fileStream.seekp(0, std::ios::end);
+
+        xrefTable.setDictionaryOffset(0);
+        xrefTable.setDictionarySize(0);
+        if (!dictionaries.empty()) {
+            xrefTable.setDictionaryOffset(fileStream.tellp());
+            xrefTable.setDictionarySize(dictionaries.write(fileStream));
+        }
+
+        xrefTable.setModuleGraphOffset(fileStream.tellp());
+        xrefTable.setModuleGraphSize(moduleGraph.writeModuleGraph(fileStream));
+
+        xrefTable.setXrefOffset(fileStream.tellp());
+        if (!xrefTable.writeTable(fileStream)) {
+            return Result{false, "Failed to write XREF table"};
+        }
+
+        // Everything the footer points to must be on disk before the footer is
+        fileStream.flush();
+        if (!fileStream || !syncFile(filePath)) {
+            return Result{false, "Failed to sync appended data"};
+        }
+
+        if (!xrefTable.writeFooter(fileStream)) {
+            return Result{false, "Failed to write XREF footer"};
+        }
+        fileStream.flush();
+        if (!fileStream || !syncFile(filePath)) {
+            return Result{false, "Failed to sync XREF footer"};
+        }
+        committedSize = static_cast<uint64_t>(fileStream.tellp());
+    } catch (const std::exception& e) {
+        return Result{false, "Exception committing changes: " + std::string(e.what())};
+    }
+
+    // The commit is published. Readers only follow the newest footer, so the
+    // flags below are informational and a crash while setting them is harmless.
+    try {
+        XRefTable::markObsolete(fileStream, previousXrefOffset);
+        flagSupersededModules();
+        fileStream.flush();
+    } catch (const std::exception& e) {
+        cerr << "Committed, but failed to flag previous versions: " << e.what() << endl;
+    }
+
+    return Result{true, "File closed successfully"};
+}
+
+void Writer::flagSupersededModules() {
+    for (uint64_t offset : supersededModules) {
+        fileStream.seekg(offset);
+
+        DataHeader dataHeader;
+        dataHeader.setEncryptionData(header.getEncryptionData());
+        dataHeader.readDataHeader(fileStream);
+
+        fileStream.seekg(offset);
+        dataHeader.updateIsCurrent(false, fileStream);
+    }
+    supersededModules.clear();
+}
+
+void Writer::discardUncommitted() {
+
+    // New files only exist as the temp file until they are closed
+    if (newFile) {
+        removeTempFile();
+        return;
+    }
+
+    // Appended modules are unreachable from the committed footer, cut them off again
+    fileStream.close();
+    try {
+        if (committedSize > 0 && std::filesystem::exists(filePath) &&
+            std::filesystem::file_size(filePath) > committedSize) {
+            std::filesystem::resize_file(filePath, committedSize);
+        }
+    } catch (const std::exception& e) {
+        cerr << "Failed to discard uncommitted data: " << e.what() << endl;
+    }
+    supersededModules.clear();
+}
+
+std::expected<std::unique_ptr<DataModule>, std::string> Writer::createModule(
+    const std::string& schemaPath, UUID moduleId, const ModuleData& moduleData, EncryptionData encryptionData) {
+
+    auto created = createEmptyModule(schemaPath, moduleId, encryptionData);
+    if (!created) {
+        return created;
+    }
+    unique_ptr<DataModule> dm = std::move(created.value());
+
+    // ADD DATA TO MODULE
+    dm->addMetaData(moduleData.metadata);
+    dm->addData(moduleData.data);
+
+    return dm;
+}
+
+std::expected<std::unique_ptr<DataModule>, std::string> Writer::createEmptyModule(
+    const std::string& schemaPath, UUID moduleId, EncryptionData encryptionData) {
+
+    // Load schema, parsed once per process and shared by every module using it
+    shared_ptr<const CompiledSchema> schema;
+    try {
+        schema = SchemaRegistry::shared().get(schemaPath);
+    } catch (const std::exception& e) {
+        cerr << e.what() << endl;
+        return std::unexpected(e.what());
     }
     
-    nlohmann::json schemaJson;
-    schemaFile >> schemaJson;
-    
-    string moduleType = schemaJson["module_type"];
+    string moduleType = schema->getJson().at("module_type");
     ModuleType type = module_type_from_string(moduleType);
 
     unique_ptr<DataModule> dm;
@@ -558,21 +990,34 @@ Result Writer::writeModule(
     // CREATE MODULE
     switch (type) {
         case ModuleType::Image: {
-            dm = make_unique<ImageData>(schemaPath, schemaJson, moduleId, encryptionData);
+            dm = make_unique<ImageData>(schemaPath, schema, moduleId, encryptionData);
             break;
         }
         case ModuleType::Tabular: {
-            dm = make_unique<TabularData>(schemaPath, schemaJson, moduleId, encryptionData);
+            dm = make_unique<TabularData>(schemaPath, schema, moduleId, encryptionData);
             break;
         }
         default:
 
-            return Result{false, "Unknown module type: " + moduleType};
+            return std::unexpected("Unknown module type: " + moduleType);
     }
 
-    // ADD DATA TO MODULE
-    dm->addMetaData(moduleData.metadata);
-    dm->addData(moduleData.data);
+    dm->applyCompressionPolicy(compressionPolicy);
+    dm->setMetadataDictionary(metadataDictionary);
+
+    return dm;
+}
+
+Result Writer::writeModule(
+    std::ostream& outfile, const std::string& schemaPath, 
+    UUID moduleId,
+    const ModuleData& moduleData, EncryptionData encryptionData) {
+
+    auto created = createModule(schemaPath, moduleId, moduleData, encryptionData);
+    if (!created) {
+        return Result{false, created.error()};
+    }
+    unique_ptr<DataModule> dm = std::move(created.value());
 
     // Ensure at end of file
     outfile.seekp(0, std::ios::end);
@@ -582,12 +1027,15 @@ Result Writer::writeModule(
     // Reset ZSTD statistics for this module
     ZstdCompressor::resetStatistics();
 
-    // WRITE MODULE TO FILE
-    std::stringstream moduleBuffer;
-    dm->writeBinary(moduleStart, moduleBuffer, xrefTable, this->author);
-
-    string bufferData = moduleBuffer.str();
-    outfile.write(reinterpret_cast<char*>(bufferData.data()), bufferData.size());
+    // WRITE MODULE TO FILE, a partly written module is cut off again
+    try {
+        dm->writeBinary(moduleStart, outfile, xrefTable, this->author);
+    } catch (...) {
+        outfile.clear();
+        discardFrom(moduleStart);
+        throw;
+    }
+    hasChanges = true;
 
     // Print ZSTD compression summary for this module
     std::cout << "Module ZSTD compression summary:" << std::endl;
@@ -596,6 +1044,62 @@ Result Writer::writeModule(
     return Result{true, "Module written successfully"};
 }
 
+Result Writer::setMetadataDictionary(std::vector<uint8_t> dictionary) {
+
+    if (!fileStream.is_open()) {
+        return Result{false, "No file is open"};
+    }
+
+    // The dictionary table is stored in plaintext and would leak the metadata it was built from
+    if (header.getEncryptionData().encryptionType != EncryptionType::NONE) {
+        return Result{false, "Metadata dictionaries are not supported in encrypted files"};
+    }
+
+    try {
+        metadataDictionary = make_shared<const ZstdDictionary>(std::move(dictionary));
+    } catch (const std::exception& e) {
+        return Result{false, "Invalid metadata dictionary: " + std::string(e.what())};
+    }
+
+    dictionaries.add(metadataDictionary);
+    return Result{true, "Metadata dictionary set"};
+}
+
+Result Writer::trainMetadataDictionary(
+    const std::string& schemaPath, const std::vector<ModuleData>& modules, size_t capacity) {
+
+    if (!fileStream.is_open()) {
+        return Result{false, "No file is open"};
+    }
+
+    // The dictionary table is stored in plaintext and would leak the metadata it was built from
+    if (header.getEncryptionData().encryptionType != EncryptionType::NONE) {
+        return Result{false, "Metadata dictionaries are not supported in encrypted files"};
+    }
+
+    // Serialise the metadata exactly as the modules would be written, minus compression
+    std::vector<std::vector<uint8_t>> samples;
+    try {
+        for (const auto& module : modules) {
+            auto created = createModule(schemaPath, UUID(), module, EncryptionData());
+            if (!created) {
+                return Result{false, created.error()};
+            }
+            created.value()->collectMetadataSamples(samples);
+        }
+        metadataDictionary = ZstdDictionary::train(samples, capacity);
+    } catch (const std::exception& e) {
+        return Result{false, "Failed to train metadata dictionary: " + std::string(e.what())};
+    }
+
+    dictionaries.add(metadataDictionary);
+    return Result{true, "Metadata dictionary trained on " + std::to_string(samples.size()) + " blocks"};
+}
+
+void Writer::clearMetadataDictionary() {
+    metadataDictionary.reset();
+}
+
 void Writer::removeTempFile() {
     if (std::filesystem::exists(tempFilePath)) {
         std::filesystem::remove(tempFilePath);
@@ -11,9 +11,12 @@
 #include "Header/header.hpp"
 #include "Xref/xref.hpp"
 #include "DataModule/dataModule.hpp"
+#include "DataModule/Image/imageData.hpp"
 #include "DataModule/ModuleData.hpp"
 #include "Utility/uuid.hpp"
 #include "Utility/Encryption/encryptionManager.hpp"
+#include "Utility/Compression/CompressionPolicy.hpp"
+#include "Utility/Compression/ZstdDictionary.hpp"
 #include "Links/moduleGraph.hpp"
 #include "Links/moduleLink.hpp"
 
@@ -28,6 +31,15 @@ struct Result {
     std::string message;
 };
 
+/**
+ * @brief One module of a Writer::addModules() batch.
+ */
+struct BatchModule {
+    UUID encounterId;
+    std::string schemaPath;
+    ModuleData module;
+};
+
 /**
  * @brief Writer class for creating and modifying UMDF (Unified Medical Data Format) files.
  * 
@@ -43,7 +55,9 @@ struct Result {
  * - Support for variants and annotations linked to parent modules
  * 
  * @note All write operations are atomic - either the entire operation succeeds or fails
- * @note The writer uses temporary files during operations to ensure data integrity
+ * @note New files are written to a temporary file that is renamed into place on close.
+ *       Existing files are appended to in place and committed by a new footer, so an
+ *       update costs the bytes added, not the size of the file.
  */
 class Writer {
 private:
@@ -55,6 +69,11 @@ private:
 
     std::string author;
     bool newFile = false;
+    CompressionPolicy compressionPolicy;
+
+    // Every dictionary of the open file and the one new modules use, if any
+    DictionaryTable dictionaries;
+    std::shared_ptr<const ZstdDictionary> metadataDictionary;
     std::unique_ptr<boost::interprocess::file_lock> fileLock;
 
     // File paths
@@ -62,6 +81,19 @@ private:
     std::string tempFilePath;
     std::fstream fileStream;
 
+    // Existing files: end of the last committed footer, anything after it is
+    // this session's uncommitted data
+    uint64_t committedSize = 0;
+    bool hasChanges = false;
+
+    // Offsets of module versions replaced by updateModule, flagged after commit
+    std::vector<uint64_t> supersededModules;
+
+    // Image module being written a frame at a time, see beginImageModule()
+    std::unique_ptr<ImageData> streamingImage;
+    UUID streamEncounter;
+    std::streampos streamStart = 0;
+
     /**
      * @brief Release the file lock and clean up lock resources.
      * 
@@ -97,6 +129,73 @@ private:
         std::ostream& outfile, const std::string& schemaPath, UUID moduleId, 
         const ModuleData& moduleData, EncryptionData encryptionData);
 
+    /**
+     * @brief Build a module from its schema and data without writing it.
+     * 
+     * The compression policy and metadata dictionary are applied before the
+     * data is added, so that image frames inherit them.
+     * 
+     * @param schemaPath Path to the JSON schema file for this module
+     * @param moduleId UUID of the module
+     * @param moduleData Complete module data (metadata and content)
+     * @param encryptionData Encryption parameters and keys
+     * @return The module, or an error message if the schema cannot be used
+     */
+    std::expected<std::unique_ptr<DataModule>, std::string> createModule(
+        const std::string& schemaPath, UUID moduleId, const ModuleData& moduleData, EncryptionData encryptionData);
+
+    /**
+     * @brief Build a module from its schema, with policy and dictionary applied but no data.
+     * 
+     * @param schemaPath Path to the JSON schema file for this module
+     * @param moduleId UUID of the module
+     * @param encryptionData Encryption parameters and keys
+     * @return The module, or an error message if the schema cannot be used
+     */
+    std::expected<std::unique_ptr<DataModule>, std::string> createEmptyModule(
+        const std::string& schemaPath, UUID moduleId, EncryptionData encryptionData);
+
+    /**
+     * @brief Drop the image module being streamed.
+     * 
+     * Truncates the file back to where the module started and reopens it,
+     * the session can continue with other modules.
+     */
+    void abandonImageModule();
+
+    /**
+     * @brief Truncate the file being written to offset and reopen it.
+     * 
+     * @param offset End of the data to keep, normally where the discarded writes started
+     */
+    void discardFrom(std::streampos offset);
+
+    /**
+     * @brief Publish the changes to an existing file in place.
+     * 
+     * Appends the dictionary table, module graph and XRef table after the
+     * new modules and syncs them to disk, then appends and syncs the footer
+     * that makes them current. Until the footer is durable, readers and a
+     * later openFile() see the previous commit. Only then are the previous
+     * XRef table and replaced modules flagged as obsolete.
+     * 
+     * @return Result indicating success or failure with descriptive message
+     */
+    Result commitInPlace();
+
+    /**
+     * @brief Clear the isCurrent flag of every module replaced in this session.
+     */
+    void flagSupersededModules();
+
+    /**
+     * @brief Throw away everything written since the last commit.
+     * 
+     * Removes the temporary file of a new file, or truncates an existing
+     * file back to its last committed footer.
+     */
+    void discardUncommitted();
+
     /**
      * @brief Remove the temporary file.
      * 
@@ -201,6 +300,8 @@ public:
      * 
      * @note The file remains open until closeFile() is called
      * @note File locks are acquired to prevent concurrent access
+     * @note If a previous writer crashed mid-commit, the incomplete tail is
+     *       discarded and the file reopens at its last committed state
      */
     Result openFile(std::string& filename, std::string author, std::string password = "");
 
@@ -219,6 +320,76 @@ public:
      */
     Result updateModule(const std::string& moduleId, const ModuleData& module);
 
+    /**
+     * @brief Update an existing module identified by UUID.
+     * 
+     * Same as updateModule(const std::string&, const ModuleData&) without the
+     * string round trip.
+     * 
+     * @param moduleId UUID of the module to update
+     * @param module New module data to replace the existing data
+     * @return Result indicating success or failure with descriptive message
+     */
+    Result updateModule(const UUID& moduleId, const ModuleData& module);
+
+    /**
+     * @brief Choose the ZSTD settings used for modules written from now on.
+     * 
+     * The policy selects level, long-distance matching and worker count per
+     * module type and section (metadata or data). It stays in effect across
+     * files opened by this writer. The settings used are recorded in each
+     * module header, readers need no configuration.
+     * 
+     * @param policy Policy to apply, e.g. CompressionPolicy::fromPreset(CompressionPreset::Fastest)
+     */
+    void setCompressionPolicy(CompressionPolicy policy) { compressionPolicy = std::move(policy); }
+
+    /**
+     * @brief Get the compression policy applied to new modules.
+     * 
+     * @return The current policy, level 15 for every section unless changed
+     */
+    const CompressionPolicy& getCompressionPolicy() const { return compressionPolicy; }
+
+    /**
+     * @brief Compress the metadata of modules written from now on against a dictionary.
+     * 
+     * The dictionary is stored in the file and each module header names the
+     * dictionary its metadata uses, so readers pick it up automatically.
+     * 
+     * @param dictionary Dictionary in zstd format, e.g. from zstd --train
+     * @return Result indicating success or failure with descriptive message
+     * 
+     * @note A file must be open. The dictionary applies until the file is closed.
+     * @note Refused for encrypted files, as the dictionary table is not encrypted
+     */
+    Result setMetadataDictionary(std::vector<uint8_t> dictionary);
+
+    /**
+     * @brief Train a metadata dictionary on modules about to be written and use it.
+     * 
+     * The metadata of each module, and of every frame for images, is
+     * serialised as it would be written and used as a training sample.
+     * Small, repetitive metadata blocks gain the most.
+     * 
+     * @param schemaPath Path to the JSON schema file shared by the modules
+     * @param modules Representative module data, typically the modules to be added
+     * @param capacity Maximum dictionary size in bytes
+     * @return Result indicating success or failure with descriptive message
+     * 
+     * @note Training fails if there are too few samples, the current dictionary is then kept
+     * @note Refused for encrypted files, a trained dictionary holds fragments of the metadata
+     */
+    Result trainMetadataDictionary(const std::string& schemaPath, const std::vector<ModuleData>& modules,
+        size_t capacity = ZstdDictionary::DEFAULT_CAPACITY);
+
+    /**
+     * @brief Stop using a metadata dictionary for new modules.
+     * 
+     * Dictionaries already used stay in the file for the modules that need them.
+     */
+    void clearMetadataDictionary();
+
     // ModuleGrph methods
     /**
      * @brief Create a new encounter in the module graph.
@@ -283,6 +454,67 @@ public:
      * @note Annotations maintain a relationship link to their parent module
      */
     std::expected<UUID, std::string> addAnnotation(const UUID& parentModuleId, const std::string& schemaPath, const ModuleData& module);
+
+    /**
+     * @brief Add many modules to their encounters in one call.
+     * 
+     * Schema parsing, encoding, compression and encryption run for several
+     * modules at once on the shared thread pool. The encoded modules are
+     * then appended in batch order, so the file is the same whatever the
+     * thread count, and the module graph is updated once at the end.
+     * Modules are encoded a window at a time to bound memory use.
+     * 
+     * @param batch Modules to add, each with its encounter and schema
+     * @return std::expected containing the new module UUIDs in batch order on success, or error message on failure
+     * 
+     * @note The batch is all or nothing: if any module fails, none are added
+     */
+    std::expected<std::vector<UUID>, std::string> addModules(const std::vector<BatchModule>& batch);
+
+    /**
+     * @brief Start an image module that is written a frame at a time.
+     * 
+     * Writes the module header and metadata to the file. Frames are then
+     * passed to appendFrame() as they become available, each is encoded
+     * and written straight away, so the writer holds one frame at a time
+     * rather than the whole volume. finishImageModule() writes the frame
+     * index and adds the module to the encounter.
+     * 
+     * @param encounterId UUID of the encounter to add the module to
+     * @param schemaPath Path to the JSON schema file of an image module
+     * @param metadata Module metadata, its dimensions set the number of frames expected
+     * @return std::expected containing the new module UUID on success, or error message on failure
+     * 
+     * @note Not available for encrypted files
+     * @note Other modules cannot be added or updated until the module is finished
+     */
+    std::expected<UUID, std::string> beginImageModule(const UUID& encounterId, const std::string& schemaPath,
+        const nlohmann::json& metadata);
+
+    /**
+     * @brief Encode and write the next frame of the streamed image module.
+     * 
+     * A frame that does not match the module (size, type, frame metadata)
+     * is rejected and nothing is written. If writing fails the whole
+     * module is discarded.
+     * 
+     * @param frame Frame metadata and pixel data, as in the frame list of addModuleToEncounter()
+     * @return Result indicating success or failure with descriptive message
+     */
+    Result appendFrame(const ModuleData& frame);
+
+    /**
+     * @brief Complete the streamed image module.
+     * 
+     * Writes the frame index, fills in the section sizes of the module
+     * header and adds the module to its encounter.
+     * 
+     * @return Result indicating success or failure with descriptive message
+     * 
+     * @note Fails while frames are missing, they can still be appended
+     * @note closeFile() discards an image module that was not finished
+     */
+    Result finishImageModule();
     
     /**
      * @brief Cancel all pending changes and close the file.
@@ -293,7 +525,7 @@ public:
      * @return Result indicating success or failure with descriptive message
      * 
      * @note All changes made since the last closeFile() are lost
-     * @note Temporary files are cleaned up
+     * @note Temporary files are cleaned up, data appended to an existing file is truncated
      * @note File locks are released
      */
     Result cancelThenClose();
@@ -302,8 +534,10 @@ public:
      * @brief Close the file and save all changes.
      * 
      * This method writes module graph and cross-reference table to the file.
-     * It then validates the file. On successful validation it atomically 
-     * renames the temporary file to the final filename.
+     * For a new file it then validates the file and, on success, atomically 
+     * renames the temporary file to the final filename. An existing file is
+     * committed in place by an fsync'd footer, see commitInPlace(); if
+     * nothing changed it is left untouched.
      * 
      * @return Result indicating success or failure with descriptive message
      * 
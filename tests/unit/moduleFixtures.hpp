@@ -0,0 +1,119 @@
+#ifndef MODULE_FIXTURES_HPP
+#define MODULE_FIXTURES_HPP
+
+// Module generators shared by the unit tests and the benchmarks.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "DataModule/ModuleData.hpp"
+#include "writer.hpp"
+
+namespace fixtures {
+
+// Fresh path under build/tests_tmp, with no file or temp copy left from an earlier run
+inline std::string tempUmdfPath(const std::string& name) {
+    std::filesystem::path p = std::filesystem::path("build/tests_tmp") / name;
+    std::filesystem::create_directories(p.parent_path());
+    std::filesystem::remove(p);
+    std::filesystem::remove(p.string() + ".tmp");
+    return p.string();
+}
+
+// CT-like 16-bit slices: smooth anatomy plus noise, so codecs have real work.
+// Equal arguments give equal pixels.
+inline ModuleData makeImageModule(uint16_t width, uint16_t height, uint16_t frameCount,
+    const std::string& encoding = "raw", uint32_t seed = 1234) {
+
+    nlohmann::json metadata = {
+        {"modality", "CT"},
+        {"image_structure", {
+            {"channels", 1},
+            {"bit_depth", 16},
+            {"encoding", encoding},
+            {"memory_order", "row_major"},
+            {"origin", "top_left"},
+            {"layout", "interleaved"},
+            {"dimensions", {width, height, frameCount}},
+            {"dimension_names", {"x", "y", "z"}}
+        }}
+    };
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 12.0);
+
+    std::vector<ModuleData> frames;
+    frames.reserve(frameCount);
+    for (uint16_t f = 0; f < frameCount; ++f) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 2);
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                double dx = (x - width / 2.0) / width;
+                double dy = (y - height / 2.0) / height;
+                double body = (dx * dx + dy * dy < 0.16) ? 1000.0 + 200.0 * (dx + dy) + f : 0.0;
+                auto value = static_cast<uint16_t>(std::max(0.0, body + noise(rng)));
+                size_t i = (y * width + x) * 2;
+                pixels[i] = static_cast<uint8_t>(value & 0xFF);
+                pixels[i + 1] = static_cast<uint8_t>(value >> 8);
+            }
+        }
+
+        nlohmann::json frameMetadata = {
+            {"frame_number", f},
+            {"position", {0.0, 0.0, f * 1.25}},
+            {"orientation", {{"row_cosine", {1.0, 0.0, 0.0}}, {"column_cosine", {0.0, 1.0, 0.0}}}}
+        };
+        frames.push_back({ frameMetadata, std::move(pixels) });
+    }
+    return { metadata, frames };
+}
+
+// Patient rows for ./schemas/patient/v1.0.json, varied enough not to compress away
+inline ModuleData makeTabularModule(size_t rowCount, size_t seed) {
+    nlohmann::json rows = nlohmann::json::array();
+    for (size_t i = 0; i < rowCount; ++i) {
+        size_t n = seed * rowCount + i;
+        rows.push_back({
+            {"patient_id", "P" + std::to_string(100000 + n)},
+            {"name", {{"given", "Given" + std::to_string(n % 211)}, {"family", "Family" + std::to_string(n % 97)}}},
+            {"gender", n % 2 ? "female" : "male"},
+            {"birth_date", "19" + std::to_string(40 + n % 60) + "-0" + std::to_string(1 + n % 9) + "-1" + std::to_string(n % 10)},
+            {"age", static_cast<int>(n % 90)}
+        });
+    }
+    return { {{"clinician", "Dr. Bench"}, {"encounter_date", "2024-05-01"}}, rows };
+}
+
+// A new file holding image in a single encounter
+inline std::string writeImageFile(const std::string& name, const ModuleData& image, UUID& moduleId) {
+    std::string path = tempUmdfPath(name);
+    Writer writer;
+    if (!writer.createNewFile(path, "Tester").success) {
+        throw std::runtime_error("Failed to create " + path);
+    }
+    auto encounter = writer.createNewEncounter();
+    if (!encounter) {
+        writer.cancelThenClose();
+        throw std::runtime_error("Failed to create encounter: " + encounter.error());
+    }
+    auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", image);
+    if (!id) {
+        writer.cancelThenClose();
+        throw std::runtime_error("Failed to write " + path + ": " + id.error());
+    }
+    moduleId = id.value();
+    if (!writer.closeFile().success) {
+        throw std::runtime_error("Failed to close " + path);
+    }
+    return path;
+}
+
+} // namespace fixtures
+
+#endif
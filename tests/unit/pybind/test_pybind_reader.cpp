@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include "pybind_test_fixture.hpp"
 #include "test_cleanup.hpp"
+#include "../moduleFixtures.hpp"
 #include <iostream>
 #include <filesystem>
 #include <cstdlib> // For std::time
@@ -271,6 +272,31 @@ TEST_CASE("Reader getModuleData method functionality", "[pybind][reader][getModu
     std::cout << "DEBUG: getModuleData test completed successfully!" << std::endl;
 }
 
+TEST_CASE("Reader getFrames method functionality", "[pybind][reader][getFrames]") {
+    auto& module = GET_PYBIND_MODULE();
+    REQUIRE(module.ptr() != nullptr);
+
+    UUID moduleId;
+    std::string filename = fixtures::writeImageFile("test_pybind_getFrames.umdf",
+                                                    fixtures::makeImageModule(8, 8, 3), moduleId);
+
+    auto reader = module.attr("Reader")();
+    auto openResult = reader.attr("openFile")(filename, "");
+    REQUIRE(openResult.attr("success").cast<bool>() == true);
+
+    // A range of frames comes back as an ExpectedModuleDataList
+    auto frames = reader.attr("getFrames")(moduleId.toString(), 1, 2);
+    REQUIRE(frames.attr("has_value")().cast<bool>() == true);
+    REQUIRE(py::len(frames.attr("value")()) == 2);
+
+    auto outOfRange = reader.attr("getFrames")(moduleId.toString(), 2, 5);
+    REQUIRE(outOfRange.attr("has_value")().cast<bool>() == false);
+    REQUIRE_FALSE(outOfRange.attr("error")().cast<std::string>().empty());
+
+    reader.attr("closeFile")();
+    std::filesystem::remove(filename);
+}
+
 TEST_CASE("Reader getAuditTrail method functionality", "[pybind][reader][getAuditTrail]") {
     std::cout << "DEBUG: Testing getAuditTrail method..." << std::endl;
     
@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 #include "DataModule/dataModule.hpp"
+#include "DataModule/Tabular/tabularData.hpp"
 #include <nlohmann/json.hpp>
 
 using namespace nlohmann;
@@ -23,3 +24,62 @@ TEST_CASE("DataModule basic operations", "[dataModule][basic]") {
         REQUIRE(testData["value"] == 42);
     }
 }
+
+TEST_CASE("CompiledRowLayout flattens table rows", "[dataModule][rowLayout]") {
+
+    std::string schemaPath = "./schemas/patient/v1.0.json";
+    DataHeader header;
+    TabularData module(schemaPath, header);
+    auto layout = SchemaRegistry::shared().get(schemaPath)->getRowLayout("data");
+
+    SECTION("Object properties get a slot each at fixed offsets") {
+        const auto& slots = layout->getSlots();
+        REQUIRE(slots.size() == 7);
+        REQUIRE(layout->getBitmapSize() == 1);
+
+        size_t given = layout->find("name.given");
+        REQUIRE(given != CompiledRowLayout::npos);
+        REQUIRE(slots[given].key == "name");
+        REQUIRE(slots[given].child == "given");
+        REQUIRE(layout->find("name") == CompiledRowLayout::npos);
+        REQUIRE(slots[layout->find("age")].nested == CompiledRowLayout::npos);
+
+        size_t offset = layout->getBitmapSize();
+        for (const auto& slot : slots) {
+            REQUIRE(slot.fixedOffset == offset);
+            offset += slot.length;
+        }
+        REQUIRE(layout->getFullRowSize() == offset);
+
+        // Modules of the same schema share the layout
+        DataHeader otherHeader;
+        TabularData other(schemaPath, otherHeader);
+        REQUIRE(SchemaRegistry::shared().get(schemaPath)->getRowLayout("data") == layout);
+    }
+
+    SECTION("Rows with and without optional fields round-trip") {
+        json full = {
+            {"patient_id", "P1"}, {"name", {{"given", "Ada"}, {"family", "Lovelace"}}},
+            {"gender", "female"}, {"birth_sex", "female"}, {"birth_date", "1815-12-10"}, {"age", 36}
+        };
+        json partial = {
+            {"patient_id", "P2"}, {"name", {{"given", "Alan"}, {"family", "Turing"}}},
+            {"gender", "male"}, {"birth_date", "1912-06-23"}, {"age", nullptr}
+        };
+
+        module.addMetaData({{"clinician", "Dr. Layout"}, {"encounter_date", "2024-05-01"}});
+        module.addData(json::array({ full, partial, full }));
+
+        json expectedPartial = partial;
+        expectedPartial.erase("age");
+
+        auto rows = std::get<json>(module.getModuleData().data);
+        REQUIRE(rows.size() == 3);
+        REQUIRE(rows[0] == full);
+        REQUIRE(rows[1] == expectedPartial);
+        REQUIRE(rows[2] == full);
+
+        REQUIRE_THROWS(module.addData(json{{"patient_id", "P3"}, {"name", "Nobody"},
+                                           {"gender", "other"}, {"birth_date", "2000-01-01"}}));
+    }
+}
@@ -0,0 +1,349 @@
+#include <catch2/catch_all.hpp>
+#include "reader.hpp"
+#include "writer.hpp"
+#include "DataModule/ModuleData.hpp"
+#include "Utility/Encryption/EncryptionManager.hpp"
+#include "Header/header.hpp"
+#include "DataModule/Image/imageData.hpp"
+#include "DataModule/SchemaRegistry.hpp"
+#include "moduleFixtures.hpp"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+using namespace nlohmann;
+namespace fs = std::filesystem;
+
+using fixtures::tempUmdfPath;
+using fixtures::makeImageModule;
+
+static EncryptionData makeEncryptionData(KeyScheme scheme) {
+    EncryptionData data;
+    data.encryptionType = EncryptionType::AES_256_GCM;
+    data.keyScheme = scheme;
+    data.masterPassword = "correct horse";
+    data.baseSalt = EncryptionManager::generateSalt(16);
+    data.moduleSalt = EncryptionManager::generateSalt(16);
+    data.memoryCost = 65536;
+    data.timeCost = 3;
+    data.parallelism = 2;
+    return data;
+}
+
+static void overwriteMagic(const std::string& path, const std::string& magic) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    REQUIRE(file.is_open());
+    file.write(magic.data(), magic.size());
+}
+
+TEST_CASE("Module key derivation", "[encryption]") {
+
+    SECTION("Master key scheme derives distinct keys per module salt") {
+        EncryptionData data = makeEncryptionData(KeyScheme::MasterKey);
+        data.masterKey = EncryptionManager::deriveMasterKey(data);
+
+        auto first = EncryptionManager::deriveModuleKey(data);
+        REQUIRE(first.size() == 32);
+        REQUIRE(first != *data.masterKey);
+        REQUIRE(EncryptionManager::deriveModuleKey(data) == first);
+
+        data.moduleSalt = EncryptionManager::generateSalt(16);
+        REQUIRE(EncryptionManager::deriveModuleKey(data) != first);
+
+        // Without a cached master key the same key is derived the slow way
+        auto cached = EncryptionManager::deriveModuleKey(data);
+        data.masterKey.reset();
+        REQUIRE(EncryptionManager::deriveModuleKey(data) == cached);
+    }
+
+    SECTION("Legacy scheme matches per-module Argon2id") {
+        EncryptionData data = makeEncryptionData(KeyScheme::PerModuleArgon2id);
+
+        std::vector<uint8_t> combinedSalt = data.baseSalt;
+        combinedSalt.insert(combinedSalt.end(), data.moduleSalt.begin(), data.moduleSalt.end());
+        auto legacy = EncryptionManager::deriveKeyArgon2id(
+            data.masterPassword, combinedSalt, data.memoryCost, data.timeCost, data.parallelism);
+
+        REQUIRE(EncryptionManager::deriveModuleKey(data) == legacy);
+        data.masterKey = EncryptionManager::deriveMasterKey(data);
+        REQUIRE(EncryptionManager::deriveModuleKey(data) == legacy);
+    }
+}
+
+TEST_CASE("Segmented encryption", "[encryption][segments]") {
+
+    EncryptionType cipher = GENERATE(EncryptionType::AES_256_GCM, EncryptionType::XCHACHA20_POLY1305);
+    if (cipher == EncryptionType::AES_256_GCM && EncryptionManager::selectCipher() != cipher) {
+        return;  // No AES-GCM on this CPU
+    }
+
+    std::vector<uint8_t> key = EncryptionManager::generateSalt(32);
+    std::vector<uint8_t> iv = EncryptionManager::generateIV(EncryptionManager::nonceSize(cipher));
+    const uint32_t segmentSize = 64;
+
+    auto seal = [&](const std::vector<uint8_t>& plaintext) {
+        std::stringstream out;
+        SegmentedEncryptor encryptor(out, cipher, key, iv, segmentSize);
+        // Uneven writes must not change the segment boundaries
+        size_t half = plaintext.size() / 3;
+        encryptor.write(std::span(plaintext).first(half));
+        encryptor.write(std::span(plaintext).subspan(half));
+        uint64_t size = encryptor.finish();
+        REQUIRE(size == EncryptionManager::segmentedSize(plaintext.size(), segmentSize));
+        REQUIRE(out.str().size() == size);
+        return out.str();
+    };
+
+    for (size_t length : {size_t(0), size_t(10), size_t(64), size_t(128), size_t(300)}) {
+        DYNAMIC_SECTION(EncryptionManager::encryptionToString(cipher) << " round trip of " << length << " bytes") {
+            std::vector<uint8_t> plaintext(length);
+            for (size_t i = 0; i < length; ++i) plaintext[i] = static_cast<uint8_t>(i * 31);
+
+            std::string sealed = seal(plaintext);
+            std::istringstream in(sealed);
+            REQUIRE(EncryptionManager::decryptSegmented(cipher, in, sealed.size(), key, iv, segmentSize) == plaintext);
+        }
+    }
+
+    std::vector<uint8_t> plaintext(300, 0x5A);
+    std::string sealed = seal(plaintext);
+    const size_t sealedSegment = segmentSize + crypto_aead_aes256gcm_ABYTES;
+
+    SECTION("Segments open on their own") {
+        auto bytes = std::span(reinterpret_cast<const uint8_t*>(sealed.data()), sealed.size());
+        auto segment = EncryptionManager::openSegment(cipher, bytes.subspan(2 * sealedSegment, sealedSegment), key, iv, 2, false);
+        REQUIRE(segment == std::vector<uint8_t>(segmentSize, 0x5A));
+        REQUIRE_THROWS(EncryptionManager::openSegment(cipher, bytes.subspan(2 * sealedSegment, sealedSegment), key, iv, 1, false));
+    }
+
+    SECTION("Tampering and truncation are detected") {
+        std::string tampered = sealed;
+        tampered[sealedSegment + 3] ^= 0x01;
+        std::istringstream tamperedIn(tampered);
+        REQUIRE_THROWS(EncryptionManager::decryptSegmented(cipher, tamperedIn, tampered.size(), key, iv, segmentSize));
+
+        // Dropping whole trailing segments leaves no segment marked final
+        std::string truncated = sealed.substr(0, 2 * sealedSegment);
+        std::istringstream truncatedIn(truncated);
+        REQUIRE_THROWS(EncryptionManager::decryptSegmented(cipher, truncatedIn, truncated.size(), key, iv, segmentSize));
+    }
+}
+
+TEST_CASE("Encrypted file round trip", "[encryption]") {
+
+    std::string path = tempUmdfPath("encrypted.umdf");
+    std::vector<ModuleData> images;
+    std::vector<UUID> ids;
+
+    {
+        Writer writer;
+        REQUIRE(writer.createNewFile(path, "Tester", "correct horse").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        for (uint8_t m = 0; m < 3; ++m) {
+            // The last module spans several encryption segments
+            images.push_back(m == 2 ? makeImageModule(640, 480, 3, "raw", m) : makeImageModule(16, 12, 2, "raw", m));
+            auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", images.back());
+            REQUIRE(id.has_value());
+            ids.push_back(id.value());
+        }
+        REQUIRE(writer.closeFile().success);
+    }
+
+    SECTION("The cipher is chosen for this CPU and recorded in the header") {
+        std::ifstream file(path, std::ios::binary);
+        Header header;
+        auto encryption = header.readPrimaryHeader(file);
+        REQUIRE(encryption.has_value());
+        REQUIRE(encryption->encryptionType == EncryptionManager::selectCipher());
+    }
+
+    SECTION("Every module decrypts with the file password") {
+        Reader reader;
+        REQUIRE(reader.openFile(path, "correct horse").success);
+        for (size_t m = 0; m < ids.size(); ++m) {
+            auto module = reader.getModuleData(ids[m]);
+            REQUIRE(module.has_value());
+            const auto& expected = std::get<std::vector<ModuleData>>(images[m].data);
+            const auto& actual = std::get<std::vector<ModuleData>>(module->data);
+            REQUIRE(actual.size() == expected.size());
+            for (size_t f = 0; f < actual.size(); ++f) {
+                REQUIRE(std::get<std::vector<uint8_t>>(actual[f].data) ==
+                        std::get<std::vector<uint8_t>>(expected[f].data));
+            }
+        }
+        reader.closeFile();
+    }
+
+    SECTION("A wrong password does not decrypt") {
+        Reader reader;
+        REQUIRE(reader.openFile(path, "wrong horse").success);
+        REQUIRE_FALSE(reader.getModuleData(ids[0]).has_value());
+        reader.closeFile();
+    }
+
+    fs::remove(path);
+}
+
+TEST_CASE("Format version compatibility", "[encryption][version]") {
+
+    std::string path = tempUmdfPath("version.umdf");
+    UUID moduleId;
+    {
+        Writer writer;
+        REQUIRE(writer.createNewFile(path, "Tester").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", makeImageModule(8, 8, 1, "raw", 0));
+        REQUIRE(id.has_value());
+        moduleId = id.value();
+        REQUIRE(writer.closeFile().success);
+    }
+
+    SECTION("1.0 files are still readable") {
+        overwriteMagic(path, "#UMDFv1.0\n");
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+        reader.closeFile();
+    }
+
+    SECTION("Newer minor revisions are rejected") {
+        overwriteMagic(path, "#UMDFv1.9\n");
+        Reader reader;
+        REQUIRE_FALSE(reader.openFile(path).success);
+    }
+
+    fs::remove(path);
+}
+
+TEST_CASE("Encrypted images support random frame access", "[encryption][frames]") {
+
+    std::string path = tempUmdfPath("encrypted_frames.umdf");
+    ModuleData image = makeImageModule(32, 24, 6, "raw", 7);
+    const auto& expected = std::get<std::vector<ModuleData>>(image.data);
+    UUID moduleId;
+    {
+        Writer writer;
+        REQUIRE(writer.createNewFile(path, "Tester", "correct horse").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", image);
+        REQUIRE(id.has_value());
+        moduleId = id.value();
+        REQUIRE(writer.closeFile().success);
+    }
+
+    for (ReadMode mode : {ReadMode::Stream, ReadMode::MemoryMapped}) {
+        DYNAMIC_SECTION("Single frames are opened without loading the module, mode " << static_cast<int>(mode)) {
+            Reader reader;
+            reader.setReadMode(mode);
+            REQUIRE(reader.openFile(path, "correct horse").success);
+
+            for (size_t i : {size_t(4), size_t(1), size_t(5)}) {
+                auto frame = reader.getFrame(moduleId.toString(), i);
+                REQUIRE(frame.has_value());
+                REQUIRE(std::get<std::vector<uint8_t>>(frame->data) == std::get<std::vector<uint8_t>>(expected[i].data));
+            }
+            REQUIRE(reader.getCacheStatistics().moduleCount == 0);
+            REQUIRE_FALSE(reader.getFrame(moduleId.toString(), 6).has_value());
+            reader.closeFile();
+        }
+    }
+
+    SECTION("Frame streams read sealed frames in order") {
+        Reader reader;
+        REQUIRE(reader.openFile(path, "correct horse").success);
+        auto stream = reader.openFrameStream(moduleId.toString());
+        REQUIRE(stream.has_value());
+
+        for (size_t i = 0; i < expected.size(); ++i) {
+            auto frame = stream.value()->nextFrame();
+            REQUIRE(frame.has_value());
+            REQUIRE(std::get<std::vector<uint8_t>>(frame->data) == std::get<std::vector<uint8_t>>(expected[i].data));
+        }
+        REQUIRE_FALSE(stream.value()->hasNextFrame());
+        reader.closeFile();
+    }
+
+    for (ReadMode mode : {ReadMode::Stream, ReadMode::MemoryMapped}) {
+        DYNAMIC_SECTION("Whole modules load with their sealed frames, mode " << static_cast<int>(mode)) {
+            Reader reader;
+            reader.setReadMode(mode);
+            REQUIRE(reader.openFile(path, "correct horse").success);
+
+            auto loaded = reader.getModuleData(moduleId);
+            REQUIRE(loaded.has_value());
+            const auto& frames = std::get<std::vector<ModuleData>>(loaded->data);
+            REQUIRE(frames.size() == expected.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                REQUIRE(std::get<std::vector<uint8_t>>(frames[i].data) == std::get<std::vector<uint8_t>>(expected[i].data));
+            }
+            reader.closeFile();
+        }
+    }
+
+    SECTION("A wrong password does not open frames") {
+        Reader reader;
+        REQUIRE(reader.openFile(path, "wrong horse").success);
+        REQUIRE_FALSE(reader.getFrame(moduleId.toString(), 0).has_value());
+        reader.closeFile();
+    }
+
+    fs::remove(path);
+}
+
+// Records the largest block passed through in one call, in either direction
+class HighWaterBuffer : public std::stringbuf {
+public:
+    std::streamsize largestWrite = 0;
+    std::streamsize largestRead = 0;
+
+protected:
+    std::streamsize xsputn(const char* bytes, std::streamsize count) override {
+        largestWrite = std::max(largestWrite, count);
+        return std::stringbuf::xsputn(bytes, count);
+    }
+
+    std::streamsize xsgetn(char* bytes, std::streamsize count) override {
+        largestRead = std::max(largestRead, count);
+        return std::stringbuf::xsgetn(bytes, count);
+    }
+};
+
+TEST_CASE("Encrypted modules are sealed and opened without whole-module buffers", "[encryption][segments]") {
+
+    const std::string schemaPath = "./schemas/image/v1.0.json";
+    ModuleData image = makeImageModule(32, 24, 16, "raw", 11);
+    const auto& expected = std::get<std::vector<ModuleData>>(image.data);
+    const auto frameBytes = static_cast<std::streamsize>(std::get<std::vector<uint8_t>>(expected[0].data).size());
+
+    EncryptionData data = makeEncryptionData(KeyScheme::MasterKey);
+    data.masterKey = EncryptionManager::deriveMasterKey(data);
+
+    ImageData module(schemaPath, SchemaRegistry::shared().get(schemaPath), UUID(), data);
+    module.addMetaData(image.metadata);
+    module.addData(image.data);
+
+    HighWaterBuffer buffer;
+    std::iostream stream(&buffer);
+    XRefTable xref;
+    module.writeBinary(0, stream, xref, "Tester");
+    REQUIRE(stream.good());
+
+    // Sealed frames go out one at a time, never the data section as a whole
+    REQUIRE(static_cast<std::streamsize>(buffer.view().size()) > 8 * frameBytes);
+    REQUIRE(buffer.largestWrite < 2 * frameBytes);
+
+    // And are read back one at a time, the module ciphertext is never held whole
+    auto loaded = DataModule::fromStream(stream, 0, ModuleType::Image, data, nullptr);
+    REQUIRE(loaded);
+    REQUIRE(buffer.largestRead < 2 * frameBytes);
+
+    auto& loadedImage = static_cast<ImageData&>(*loaded);
+    for (size_t i : {size_t(0), size_t(9), size_t(15)}) {
+        REQUIRE(std::get<std::vector<uint8_t>>(loadedImage.getFrame(i).data) == std::get<std::vector<uint8_t>>(expected[i].data));
+    }
+}
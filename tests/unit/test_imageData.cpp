@@ -2,9 +2,18 @@
 #include "DataModule/Image/imageData.hpp"
 #include "Utility/uuid.hpp"
 #include "Utility/Compression/CompressionType.hpp"
+#include "DataModule/Image/Encoding/ZstdFrameCompression.hpp"
+#include "DataModule/Image/Encoding/JPEGLSCompression.hpp"
+#include "DataModule/Image/Encoding/JPEG2000Compression.hpp"
+#include "DataModule/Image/Encoding/CompressionFactory.hpp"
+#include "DataModule/Image/Encoding/SampleFilters.hpp"
+#include "DataModule/Image/Encoding/ImageEncoder.hpp"
+#include "Utility/threadPool.hpp"
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fstream>
+#include <cstring>
+#include <thread>
 
 using namespace nlohmann;
 namespace fs = std::filesystem;
@@ -138,6 +147,7 @@ TEST_CASE("ImageData encoding validation", "[imageData][encoding]") {
         REQUIRE(stringToCompression("jpeg2000-lossless").has_value());
         REQUIRE(stringToCompression("png").has_value());
         REQUIRE(stringToCompression("raw").has_value());
+        REQUIRE(stringToCompression("zstd").has_value());
         REQUIRE_FALSE(stringToCompression("invalid").has_value());
     }
 
@@ -147,3 +157,220 @@ TEST_CASE("ImageData encoding validation", "[imageData][encoding]") {
         REQUIRE(compressionToString(CompressionType::RAW) == "RAW");
     }
 }
+
+TEST_CASE("ZSTD frame codec", "[imageData][encoding][zstd]") {
+
+    // Smooth 16-bit ramp with some noise, roughly what CT slices look like
+    auto makeFrame = [](int width, int height, int channels) {
+        std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * channels * 2);
+        for (size_t i = 0; i < pixels.size() / 2; ++i) {
+            uint16_t value = static_cast<uint16_t>(1000 + (i / channels) * 3 + (i * 2654435761u >> 29));
+            pixels[2 * i] = static_cast<uint8_t>(value & 0xFF);
+            pixels[2 * i + 1] = static_cast<uint8_t>(value >> 8);
+        }
+        return pixels;
+    };
+
+    SECTION("Round-trips every supported layout") {
+        // 37x13 leaves a tail after the 16-sample vector loop
+        for (bool delta : {false, true}) {
+            ZstdFrameCompression codec(ZstdSettings{ .level = 1 }, delta);
+            for (int channels : {1, 3}) {
+                std::vector<uint8_t> frame16 = makeFrame(37, 13, channels);
+                REQUIRE(codec.decompress(codec.compress(frame16, 37, 13, channels, 16)) == frame16);
+
+                std::vector<uint8_t> frame8(frame16.begin(), frame16.begin() + frame16.size() / 2);
+                REQUIRE(codec.decompress(codec.compress(frame8, 37, 13, channels, 8)) == frame8);
+            }
+        }
+    }
+
+    SECTION("Preconditioning shrinks smooth 16-bit frames") {
+        std::vector<uint8_t> frame = makeFrame(128, 128, 1);
+        ZstdFrameCompression plain(ZstdSettings{ .level = 3 }, false);
+        ZstdFrameCompression predicted(ZstdSettings{ .level = 3 }, true);
+        std::vector<uint8_t> raw = ZstdCompressor::compressWithLevel(frame, 3);
+
+        REQUIRE(plain.compress(frame, 128, 128, 1, 16).size() < raw.size());
+        REQUIRE(predicted.compress(frame, 128, 128, 1, 16).size() < plain.compress(frame, 128, 128, 1, 16).size());
+    }
+
+    SECTION("Rejects mismatched input") {
+        ZstdFrameCompression codec;
+        std::vector<uint8_t> frame = makeFrame(8, 8, 1);
+        REQUIRE_THROWS(codec.compress(frame, 8, 9, 1, 16));
+        REQUIRE_THROWS(codec.compress(frame, 8, 8, 1, 12));
+        REQUIRE_THROWS(codec.decompress(std::vector<uint8_t>(4)));
+    }
+
+    SECTION("Rejects raw sizes the ZSTD frame does not hold") {
+        ZstdFrameCompression codec;
+        std::vector<uint8_t> frame = makeFrame(8, 8, 1);
+        std::vector<uint8_t> compressed = codec.compress(frame, 8, 8, 1, 16);
+
+        // The raw size sits after the four flag bytes
+        for (uint64_t rawSize : {uint64_t(frame.size() + 2), uint64_t(1) << 40}) {
+            std::vector<uint8_t> corrupt = compressed;
+            std::memcpy(corrupt.data() + 4, &rawSize, sizeof(rawSize));
+            REQUIRE_THROWS(codec.decompress(corrupt));
+        }
+    }
+
+    SECTION("Is registered with the factory") {
+        CompressionFactory factory;
+        REQUIRE(factory.isSupported(CompressionType::ZSTD));
+        REQUIRE(factory.createStrategy(CompressionType::ZSTD)->getCompressionType() == "ZSTD");
+    }
+}
+
+TEST_CASE("JPEG 2000 frame codec", "[imageData][encoding][jpeg2000]") {
+
+    JPEG2000Compression codec;
+
+    SECTION("Every frame coded on one thread is a real codestream") {
+        // The thread's image is reused after the first frame
+        for (uint16_t f = 0; f < 3; ++f) {
+            std::vector<uint8_t> frame(static_cast<size_t>(64) * 48 * 2);
+            for (size_t i = 0; i < frame.size() / 2; ++i) {
+                uint16_t value = static_cast<uint16_t>(1000 + f * 50 + (i % 64) * 4 + (i / 64) * 2);
+                frame[2 * i] = static_cast<uint8_t>(value & 0xFF);
+                frame[2 * i + 1] = static_cast<uint8_t>(value >> 8);
+            }
+
+            std::vector<uint8_t> compressed = codec.compress(frame, 64, 48, 1, 16);
+            REQUIRE(compressed.size() < frame.size());
+
+            // SOC followed by SIZ
+            REQUIRE(compressed.size() > 4);
+            REQUIRE(compressed[0] == 0xFF);
+            REQUIRE(compressed[1] == 0x4F);
+            REQUIRE(compressed[2] == 0xFF);
+            REQUIRE(compressed[3] == 0x51);
+
+            REQUIRE(codec.decompress(compressed) == frame);
+        }
+    }
+}
+
+TEST_CASE("JPEG-LS frame codec", "[imageData][encoding][jpegls]") {
+
+    JPEGLSCompression codec;
+
+    SECTION("Round-trips 8 and 16-bit frames") {
+        for (int channels : {1, 3}) {
+            std::vector<uint8_t> frame16(static_cast<size_t>(37) * 13 * channels * 2);
+            for (size_t i = 0; i < frame16.size(); ++i) {
+                frame16[i] = static_cast<uint8_t>(i % 2 ? (i / 97) & 0x0F : i * 7);
+            }
+            REQUIRE(codec.decompress(codec.compress(frame16, 37, 13, channels, 16)) == frame16);
+
+            std::vector<uint8_t> frame8(frame16.begin(), frame16.begin() + frame16.size() / 2);
+            REQUIRE(codec.decompress(codec.compress(frame8, 37, 13, channels, 8)) == frame8);
+        }
+    }
+
+    SECTION("Rejects unsupported layouts") {
+        std::vector<uint8_t> frame(8 * 8 * 2);
+        REQUIRE_FALSE(codec.supports(2, 8));
+        REQUIRE_THROWS(codec.compress(frame, 8, 8, 2, 8));
+        REQUIRE_THROWS(codec.compress(frame, 8, 9, 1, 16));
+    }
+
+    SECTION("Is registered with the factory and the schema names") {
+        CompressionFactory factory;
+        REQUIRE(factory.isSupported(CompressionType::JPEGLS_LOSSLESS));
+        REQUIRE(factory.createStrategy(CompressionType::JPEGLS_LOSSLESS)->getCompressionType() == "JPEGLS_LOSSLESS");
+        REQUIRE(stringToCompression("jpegls-lossless") == CompressionType::JPEGLS_LOSSLESS);
+        REQUIRE(decodeCompressionType(encodeCompression(CompressionType::JPEGLS_LOSSLESS)) == CompressionType::JPEGLS_LOSSLESS);
+    }
+}
+
+TEST_CASE("ImageEncoder strategy cache", "[imageData][encoding]") {
+
+    ImageEncoder encoder;
+
+    SECTION("Reuses one strategy per thread") {
+        const CompressionStrategy* strategy = encoder.getStrategy(CompressionType::ZSTD);
+        REQUIRE(strategy != nullptr);
+        REQUIRE(encoder.getStrategy(CompressionType::ZSTD) == strategy);
+        REQUIRE(encoder.getStrategy(CompressionType::PNG) != strategy);
+
+        const CompressionStrategy* other = nullptr;
+        std::thread([&] { other = encoder.getStrategy(CompressionType::ZSTD); }).join();
+        REQUIRE(other != nullptr);
+        REQUIRE(other != strategy);
+    }
+
+    SECTION("Keeps strategies apart per encoder") {
+        const CompressionStrategy* strategy = encoder.getStrategy(CompressionType::ZSTD);
+        {
+            ImageEncoder other;
+            REQUIRE(other.getStrategy(CompressionType::ZSTD) != strategy);
+        }
+
+        // Short-lived encoders on this thread still start from their own strategies
+        std::vector<uint8_t> frame(16 * 16 * 2, 7);
+        for (int i = 0; i < 8; ++i) {
+            ImageEncoder temporary;
+            auto encoded = temporary.compress(frame, CompressionType::ZSTD, 16, 16, 1, 16);
+            REQUIRE(temporary.decompress(encoded, CompressionType::ZSTD) == frame);
+        }
+        REQUIRE(encoder.getStrategy(CompressionType::ZSTD) == strategy);
+    }
+
+    SECTION("Can be shared by parallel workers") {
+        std::vector<std::vector<uint8_t>> frames(32);
+        std::vector<std::vector<uint8_t>> encoded(frames.size());
+        std::vector<std::vector<uint8_t>> decoded(frames.size());
+        for (size_t f = 0; f < frames.size(); ++f) {
+            frames[f].resize(24 * 16 * 2);
+            for (size_t i = 0; i < frames[f].size(); ++i) {
+                frames[f][i] = static_cast<uint8_t>(f * 31 + i / 5);
+            }
+        }
+
+        for (CompressionType encoding : {CompressionType::PNG, CompressionType::ZSTD}) {
+            ThreadPool::shared().parallelFor(frames.size(), [&](size_t i) {
+                encoded[i] = encoder.compress(frames[i], encoding, 24, 16, 1, 16);
+            });
+            ThreadPool::shared().parallelFor(frames.size(), [&](size_t i) {
+                decoded[i] = encoder.decompress(encoded[i], encoding);
+            });
+            REQUIRE(decoded == frames);
+        }
+    }
+}
+
+TEST_CASE("Sample plane kernels", "[imageData][encoding]") {
+
+    // 37 pixels leave a tail after every vector loop
+    const size_t pixels = 37;
+
+    for (int bytesPerSample : {1, 2}) {
+        for (size_t channels : {size_t(1), size_t(3)}) {
+            DYNAMIC_SECTION(bytesPerSample * 8 << "-bit, " << channels << " channels") {
+                std::vector<uint8_t> interleaved(pixels * channels * bytesPerSample);
+                for (size_t i = 0; i < interleaved.size(); ++i) {
+                    interleaved[i] = static_cast<uint8_t>(i * 37 + 11);
+                }
+
+                std::vector<uint8_t> restored(interleaved.size());
+                for (size_t c = 0; c < channels; ++c) {
+                    std::vector<int32_t> plane(pixels);
+                    SampleFilters::widenToInt32(interleaved.data() + c * bytesPerSample, plane.data(),
+                                                pixels, channels, bytesPerSample);
+
+                    for (size_t i = 0; i < pixels; ++i) {
+                        const uint8_t* sample = interleaved.data() + (i * channels + c) * bytesPerSample;
+                        int32_t expected = bytesPerSample == 1 ? sample[0] : sample[0] | (sample[1] << 8);
+                        REQUIRE(plane[i] == expected);
+                    }
+
+                    SampleFilters::narrowFromInt32(plane.data(), restored.data() + c * bytesPerSample,
+                                                   pixels, channels, bytesPerSample);
+                }
+                REQUIRE(restored == interleaved);
+            }
+        }
+    }
+}
@@ -0,0 +1,500 @@
+#include <catch2/catch_all.hpp>
+#include "reader.hpp"
+#include "writer.hpp"
+#include "DataModule/ModuleData.hpp"
+#include "Utility/threadPool.hpp"
+#include "DataModule/Image/Encoding/ImageEncoder.hpp"
+#include "moduleFixtures.hpp"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+using namespace nlohmann;
+namespace fs = std::filesystem;
+
+using fixtures::tempUmdfPath;
+using fixtures::makeImageModule;
+using fixtures::writeImageFile;
+
+TEST_CASE("Reader memory-mapped mode", "[reader][mmap]") {
+
+    ModuleData image = makeImageModule(32, 24, 4);
+    UUID moduleId;
+    std::string path = writeImageFile("reader_mmap.umdf", image, moduleId);
+
+    SECTION("Mapped and streamed reads return identical data") {
+        Reader streamed;
+        REQUIRE(streamed.openFile(path).success);
+        auto expected = streamed.getModuleData(moduleId.toString());
+        REQUIRE(expected.has_value());
+
+        Reader mapped;
+        mapped.setReadMode(ReadMode::MemoryMapped);
+        REQUIRE(mapped.openFile(path).success);
+        auto actual = mapped.getModuleData(moduleId.toString());
+        REQUIRE(actual.has_value());
+
+        REQUIRE(actual->metadata == expected->metadata);
+        const auto& expectedFrames = std::get<std::vector<ModuleData>>(expected->data);
+        const auto& actualFrames = std::get<std::vector<ModuleData>>(actual->data);
+        REQUIRE(actualFrames.size() == expectedFrames.size());
+        for (size_t i = 0; i < actualFrames.size(); ++i) {
+            REQUIRE(actualFrames[i].metadata == expectedFrames[i].metadata);
+            REQUIRE(std::get<std::vector<uint8_t>>(actualFrames[i].data) ==
+                    std::get<std::vector<uint8_t>>(expectedFrames[i].data));
+        }
+    }
+
+    SECTION("RAW frames are views into the mapping") {
+        Reader mapped;
+        mapped.setReadMode(ReadMode::MemoryMapped);
+        REQUIRE(mapped.openFile(path).success);
+
+        auto view = mapped.getFrameView(moduleId.toString(), 2);
+        REQUIRE(view.has_value());
+
+        const auto& frames = std::get<std::vector<ModuleData>>(image.data);
+        const auto& original = std::get<std::vector<uint8_t>>(frames[2].data);
+        REQUIRE(view->size() == original.size());
+        REQUIRE(std::memcmp(view->data(), original.data(), original.size()) == 0);
+
+        // The same bytes must be found at the same address in a second lookup
+        auto again = mapped.getFrameView(moduleId.toString(), 2);
+        REQUIRE(again->data() == view->data());
+
+        REQUIRE_FALSE(mapped.getFrameView(moduleId.toString(), 4).has_value());
+    }
+
+    SECTION("Loading a module does not decode its frames") {
+        UUID zstdId;
+        std::string zstdPath = writeImageFile("reader_mmap_zstd.umdf", makeImageModule(32, 24, 4, "zstd"), zstdId);
+
+        for (ReadMode mode : {ReadMode::Stream, ReadMode::MemoryMapped}) {
+            Reader reader;
+            reader.setReadMode(mode);
+
+            // RAW frames of a mapped module are neither copied nor decoded
+            REQUIRE(reader.openFile(path).success);
+            REQUIRE(reader.getFrameView(moduleId.toString(), 2).has_value());
+            if (mode == ReadMode::MemoryMapped) {
+                REQUIRE(reader.getCacheStatistics().decodedBytes == 0);
+            }
+            reader.closeFile();
+
+            // Only the requested frame of a compressed module is decoded
+            REQUIRE(reader.openFile(zstdPath).success);
+            REQUIRE(reader.getFrameView(zstdId.toString(), 1).has_value());
+            REQUIRE(reader.getCacheStatistics().decodedBytes == 32 * 24 * 2);
+            reader.closeFile();
+        }
+        fs::remove(zstdPath);
+    }
+
+    fs::remove(path);
+}
+
+TEST_CASE("Reader frame stream", "[reader][stream]") {
+
+    ModuleData image = makeImageModule(40, 30, 5);
+    UUID moduleId;
+    std::string path = writeImageFile("reader_stream.umdf", image, moduleId);
+
+    Reader reader;
+    REQUIRE(reader.openFile(path).success);
+
+    SECTION("Frames are yielded in order with a small read-ahead buffer") {
+        auto stream = reader.openFrameStream(moduleId.toString(), 1024);
+        REQUIRE(stream.has_value());
+
+        auto& frameStream = *stream.value();
+        REQUIRE(frameStream.getFrameCount() == 5);
+        REQUIRE(frameStream.getMetadata()[0]["modality"] == "CT");
+
+        const auto& frames = std::get<std::vector<ModuleData>>(image.data);
+        size_t index = 0;
+        while (frameStream.hasNextFrame()) {
+            auto frame = frameStream.nextFrame();
+            REQUIRE(frame.has_value());
+            REQUIRE(frame->metadata[0]["frame_number"] == index);
+            REQUIRE(std::get<std::vector<uint8_t>>(frame->data) ==
+                    std::get<std::vector<uint8_t>>(frames[index].data));
+            ++index;
+        }
+        REQUIRE(index == 5);
+        REQUIRE_FALSE(frameStream.nextFrame().has_value());
+    }
+
+    SECTION("Unknown modules are rejected") {
+        REQUIRE_FALSE(reader.openFrameStream(UUID().toString()).has_value());
+    }
+
+    reader.closeFile();
+    fs::remove(path);
+}
+
+TEST_CASE("Reader module cache", "[reader][cache]") {
+
+    std::string path = tempUmdfPath("reader_cache.umdf");
+    std::vector<UUID> ids;
+    {
+        Writer writer;
+        REQUIRE(writer.createNewFile(path, "Tester").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        for (int i = 0; i < 3; ++i) {
+            auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", makeImageModule(64, 64, 2));
+            REQUIRE(id.has_value());
+            ids.push_back(id.value());
+        }
+        REQUIRE(writer.closeFile().success);
+    }
+
+    Reader reader;
+    REQUIRE(reader.openFile(path).success);
+
+    SECTION("Hits, misses and decoded bytes are counted") {
+        REQUIRE(reader.getModuleData(ids[0]).has_value());
+        REQUIRE(reader.getModuleData(ids[0]).has_value());
+
+        auto stats = reader.getCacheStatistics();
+        REQUIRE(stats.misses == 1);
+        REQUIRE(stats.hits == 1);
+        REQUIRE(stats.evictions == 0);
+        REQUIRE(stats.moduleCount == 1);
+        REQUIRE(stats.decodedBytes == 2 * 64 * 64 * 2);
+        REQUIRE(stats.encodedBytes > 0);
+    }
+
+    SECTION("Least recently used modules are evicted over budget") {
+        REQUIRE(reader.getModuleData(ids[0]).has_value());
+        size_t oneModule = reader.getCacheStatistics().encodedBytes + reader.getCacheStatistics().decodedBytes;
+        reader.setCacheBudget(oneModule * 2);
+
+        REQUIRE(reader.getModuleData(ids[1]).has_value());
+        REQUIRE(reader.getModuleData(ids[0]).has_value());   // ids[1] is now least recent
+        REQUIRE(reader.getModuleData(ids[2]).has_value());
+
+        auto stats = reader.getCacheStatistics();
+        REQUIRE(stats.evictions == 1);
+        REQUIRE(stats.moduleCount == 2);
+        REQUIRE(stats.encodedBytes + stats.decodedBytes <= stats.budgetBytes);
+
+        // ids[0] survived, ids[1] has to be loaded again
+        REQUIRE(reader.getModuleData(ids[0]).has_value());
+        REQUIRE(reader.getCacheStatistics().misses == stats.misses);
+        REQUIRE(reader.getModuleData(ids[1]).has_value());
+        REQUIRE(reader.getCacheStatistics().misses == stats.misses + 1);
+
+        reader.setCacheBudget(0);
+        REQUIRE(reader.getCacheStatistics().moduleCount == 1);
+    }
+
+    reader.closeFile();
+    fs::remove(path);
+}
+
+TEST_CASE("Reader random frame access", "[reader][frames]") {
+
+    ModuleData image = makeImageModule(24, 16, 6);
+    UUID moduleId;
+    std::string path = writeImageFile("reader_frames.umdf", image, moduleId);
+    const auto& frames = std::get<std::vector<ModuleData>>(image.data);
+
+    auto checkFrames = [&](Reader& reader) {
+        auto frame = reader.getFrame(moduleId.toString(), 4);
+        REQUIRE(frame.has_value());
+        REQUIRE(frame->metadata[0]["frame_number"] == 4);
+        REQUIRE(std::get<std::vector<uint8_t>>(frame->data) ==
+                std::get<std::vector<uint8_t>>(frames[4].data));
+
+        auto range = reader.getFrames(moduleId.toString(), 1, 3);
+        REQUIRE(range.has_value());
+        REQUIRE(range->size() == 3);
+        for (size_t i = 0; i < 3; ++i) {
+            REQUIRE(std::get<std::vector<uint8_t>>((*range)[i].data) ==
+                    std::get<std::vector<uint8_t>>(frames[i + 1].data));
+        }
+
+        REQUIRE_FALSE(reader.getFrame(moduleId.toString(), 6).has_value());
+        REQUIRE_FALSE(reader.getFrames(moduleId.toString(), 5, 2).has_value());
+    };
+
+    SECTION("Frames are read through the index without loading the module") {
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        checkFrames(reader);
+        REQUIRE(reader.getCacheStatistics().moduleCount == 0);
+    }
+
+    SECTION("Frame indexes are charged to the cache budget") {
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        REQUIRE(reader.getFrame(moduleId.toString(), 0).has_value());
+
+        auto stats = reader.getCacheStatistics();
+        REQUIRE(stats.frameIndexCount == 1);
+        REQUIRE(stats.encodedBytes >= 6 * sizeof(FrameIndexEntry));
+
+        // Loading the module makes the index least recently used
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+        reader.setCacheBudget(0);
+        stats = reader.getCacheStatistics();
+        REQUIRE(stats.frameIndexCount == 0);
+        REQUIRE(stats.moduleCount == 1);
+        REQUIRE(stats.evictions == 1);
+    }
+
+    SECTION("Memory-mapped reads use the same index") {
+        Reader reader;
+        reader.setReadMode(ReadMode::MemoryMapped);
+        REQUIRE(reader.openFile(path).success);
+        checkFrames(reader);
+    }
+
+    SECTION("Loaded modules are served from the cache") {
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+        checkFrames(reader);
+        REQUIRE(reader.getCacheStatistics().moduleCount == 1);
+    }
+
+    fs::remove(path);
+}
+
+TEST_CASE("Reader decodes compressed frames in parallel", "[reader][threadpool]") {
+
+    ModuleData image = makeImageModule(48, 40, 12, "png");
+    UUID moduleId;
+    std::string path = writeImageFile("reader_parallel.umdf", image, moduleId);
+    const auto& frames = std::get<std::vector<ModuleData>>(image.data);
+
+    ThreadPool::setSharedThreadCount(4);
+
+    Reader reader;
+    REQUIRE(reader.openFile(path).success);
+    auto data = reader.getModuleData(moduleId);
+    REQUIRE(data.has_value());
+
+    const auto& decoded = std::get<std::vector<ModuleData>>(data->data);
+    REQUIRE(decoded.size() == frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        REQUIRE(decoded[i].metadata[0]["frame_number"] == i);
+        REQUIRE(std::get<std::vector<uint8_t>>(decoded[i].data) ==
+                std::get<std::vector<uint8_t>>(frames[i].data));
+    }
+
+    ThreadPool::setSharedThreadCount(0);
+    reader.closeFile();
+    fs::remove(path);
+}
+
+TEST_CASE("Parallel frame encoding matches the serial path", "[reader][threadpool]") {
+
+    ModuleData image = makeImageModule(48, 40, 12, "png");
+    const auto& frames = std::get<std::vector<ModuleData>>(image.data);
+    UUID serialId, parallelId;
+
+    ThreadPool::setSharedThreadCount(1);
+    std::string serialPath = writeImageFile("writer_serial.umdf", image, serialId);
+    ThreadPool::setSharedThreadCount(4);
+    std::string parallelPath = writeImageFile("writer_parallel.umdf", image, parallelId);
+    ThreadPool::setSharedThreadCount(0);
+
+    // Only ids and timestamps differ, both of which have a fixed size
+    REQUIRE(fs::file_size(serialPath) == fs::file_size(parallelPath));
+
+    // Every frame is stored exactly as a serial encode produces it, in order
+    ImageEncoder encoder;
+    std::vector<std::vector<uint8_t>> encoded;
+    for (const auto& frame : frames) {
+        encoded.push_back(encoder.compress(std::get<std::vector<uint8_t>>(frame.data),
+                                           CompressionType::PNG, 48, 40, 1, 16));
+    }
+    for (const std::string& path : {serialPath, parallelPath}) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        auto position = bytes.begin();
+        for (const auto& frame : encoded) {
+            position = std::search(position, bytes.end(), frame.begin(), frame.end());
+            REQUIRE(position != bytes.end());
+            position += frame.size();
+        }
+    }
+
+    Reader serial, parallel;
+    REQUIRE(serial.openFile(serialPath).success);
+    REQUIRE(parallel.openFile(parallelPath).success);
+    for (size_t i = 0; i < 12; ++i) {
+        auto expected = serial.getFrame(serialId.toString(), i);
+        auto actual = parallel.getFrame(parallelId.toString(), i);
+        REQUIRE(expected.has_value());
+        REQUIRE(actual.has_value());
+        REQUIRE(actual->metadata == expected->metadata);
+        REQUIRE(std::get<std::vector<uint8_t>>(actual->data) == std::get<std::vector<uint8_t>>(expected->data));
+    }
+
+    serial.closeFile();
+    parallel.closeFile();
+    fs::remove(serialPath);
+    fs::remove(parallelPath);
+}
+
+TEST_CASE("Reader round-trips ZSTD frames", "[reader][zstd]") {
+
+    ModuleData image = makeImageModule(48, 40, 12, "zstd");
+    const auto& frames = std::get<std::vector<ModuleData>>(image.data);
+
+    for (auto preset : {std::optional<CompressionPreset>(), std::optional(CompressionPreset::Fastest),
+                        std::optional(CompressionPreset::Smallest)}) {
+        std::string path = tempUmdfPath("reader_zstd.umdf");
+        UUID moduleId;
+        {
+            Writer writer;
+            if (preset) {
+                writer.setCompressionPolicy(CompressionPolicy::fromPreset(*preset));
+            }
+            REQUIRE(writer.createNewFile(path, "Tester").success);
+            auto encounter = writer.createNewEncounter();
+            REQUIRE(encounter.has_value());
+            auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", image);
+            REQUIRE(id.has_value());
+            moduleId = id.value();
+            REQUIRE(writer.closeFile().success);
+        }
+
+        // Without a policy frames use the frame codec's level, not the metadata one
+        std::ifstream file(path, std::ios::binary);
+        XRefTable xref = XRefTable::loadXrefTable(file);
+        DataHeader header;
+        file.seekg(xref.getEntry(moduleId).offset);
+        header.readDataHeader(file);
+        file.close();
+        int expectedLevel = preset
+            ? CompressionPolicy::fromPreset(*preset).get(ModuleType::Image, CompressionSection::Data).level
+            : ZstdFrameCompression::DEFAULT_LEVEL;
+        REQUIRE(header.getDataZstd().level == expectedLevel);
+
+        for (ReadMode mode : {ReadMode::Stream, ReadMode::MemoryMapped}) {
+            Reader reader;
+            reader.setReadMode(mode);
+            REQUIRE(reader.openFile(path).success);
+            auto data = reader.getModuleData(moduleId.toString());
+            REQUIRE(data.has_value());
+            const auto& decoded = std::get<std::vector<ModuleData>>(data->data);
+            REQUIRE(decoded.size() == frames.size());
+            REQUIRE(std::get<std::vector<uint8_t>>(decoded.back().data) ==
+                    std::get<std::vector<uint8_t>>(frames.back().data));
+
+            for (size_t i = 0; i < frames.size(); ++i) {
+                auto frame = reader.getFrame(moduleId.toString(), i);
+                REQUIRE(frame.has_value());
+                REQUIRE(std::get<std::vector<uint8_t>>(frame->data) ==
+                        std::get<std::vector<uint8_t>>(frames[i].data));
+            }
+            reader.closeFile();
+        }
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("Reader frame previews", "[reader][preview]") {
+
+    auto encoding = GENERATE(std::string("raw"), std::string("zstd"));
+    ModuleData image = makeImageModule(48, 40, 3, encoding);
+    UUID moduleId;
+    std::string path = writeImageFile("reader_preview.umdf", image, moduleId);
+    const auto& source = std::get<std::vector<uint8_t>>(std::get<std::vector<ModuleData>>(image.data)[2].data);
+
+    auto sampleAt = [&](size_t x, size_t y) {
+        return static_cast<uint32_t>(source[(y * 48 + x) * 2] | (source[(y * 48 + x) * 2 + 1] << 8));
+    };
+
+    Reader reader;
+    REQUIRE(reader.openFile(path).success);
+
+    auto checkPreview = [&]() {
+        auto preview = reader.getFramePreview(moduleId.toString(), 2, 16);
+        REQUIRE(preview.has_value());
+        REQUIRE(preview->width == 16);
+        REQUIRE(preview->height == 14);
+        REQUIRE(preview->bitDepth == 16);
+        REQUIRE(preview->pixels.size() == 16 * 14 * 2);
+
+        // 3x3 box average, the last row only covers one source row
+        uint64_t sum = 0;
+        for (size_t y = 0; y < 3; ++y) {
+            for (size_t x = 3; x < 6; ++x) {
+                sum += sampleAt(x, y);
+            }
+        }
+        REQUIRE((preview->pixels[2] | (preview->pixels[3] << 8)) == (sum + 4) / 9);
+        uint32_t last = sampleAt(47, 39);
+        REQUIRE((preview->pixels.end()[-2] | (preview->pixels.end()[-1] << 8)) ==
+                (sampleAt(45, 39) + sampleAt(46, 39) + last + 1) / 3);
+
+        auto full = reader.getFramePreview(moduleId.toString(), 2, 48);
+        REQUIRE(full.has_value());
+        REQUIRE(full->width == 48);
+        REQUIRE(full->pixels == source);
+    };
+
+    SECTION("Read straight from the file") {
+        checkPreview();
+        REQUIRE_FALSE(reader.getFramePreview(moduleId.toString(), 2, 0).has_value());
+        REQUIRE_FALSE(reader.getFramePreview(moduleId.toString(), 3, 16).has_value());
+    }
+
+    SECTION("Served from a cached module") {
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+        checkPreview();
+    }
+
+    reader.closeFile();
+    fs::remove(path);
+}
+
+TEST_CASE("Reader frame regions", "[reader][region]") {
+
+    auto encoding = GENERATE(std::string("raw"), std::string("zstd"));
+    ModuleData image = makeImageModule(48, 40, 3, encoding);
+    UUID moduleId;
+    std::string path = writeImageFile("reader_region.umdf", image, moduleId);
+    const auto& source = std::get<std::vector<uint8_t>>(std::get<std::vector<ModuleData>>(image.data)[1].data);
+
+    auto checkRegion = [&](Reader& reader, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+        auto region = reader.getFrameRegion(moduleId.toString(), 1, x, y, width, height);
+        REQUIRE(region.has_value());
+        REQUIRE(region->width == width);
+        REQUIRE(region->height == height);
+        REQUIRE(region->pixels.size() == static_cast<size_t>(width) * height * 2);
+        for (uint32_t row = 0; row < height; ++row) {
+            auto expected = source.begin() + ((y + row) * 48 + x) * 2;
+            REQUIRE(std::equal(expected, expected + width * 2, region->pixels.begin() + row * width * 2));
+        }
+    };
+
+    for (ReadMode mode : {ReadMode::Stream, ReadMode::MemoryMapped}) {
+        Reader reader;
+        reader.setReadMode(mode);
+        REQUIRE(reader.openFile(path).success);
+
+        checkRegion(reader, 5, 7, 11, 9);
+        checkRegion(reader, 0, 0, 48, 40);
+        checkRegion(reader, 47, 39, 1, 1);
+
+        REQUIRE_FALSE(reader.getFrameRegion(moduleId.toString(), 1, 40, 0, 9, 1).has_value());
+        REQUIRE_FALSE(reader.getFrameRegion(moduleId.toString(), 1, 0, 0, 0, 4).has_value());
+        REQUIRE_FALSE(reader.getFrameRegion(moduleId.toString(), 3, 0, 0, 4, 4).has_value());
+
+        // Loaded modules are sliced from the cache
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+        checkRegion(reader, 5, 7, 11, 9);
+
+        reader.closeFile();
+    }
+
+    fs::remove(path);
+}
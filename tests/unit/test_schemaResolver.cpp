@@ -1,5 +1,7 @@
 #include <catch2/catch_all.hpp>
 #include "../../src/DataModule/SchemaResolver.hpp"
+#include "../../src/DataModule/SchemaRegistry.hpp"
+#include "../../src/DataModule/Tabular/tabularData.hpp"
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <fstream>
@@ -237,3 +239,132 @@ TEST_CASE("SchemaResolver utility methods", "[schemaResolver][utilities]") {
         REQUIRE(stack.empty());
     }
 }
+
+TEST_CASE("SchemaRegistry shares schemas across modules", "[schemaResolver][registry]") {
+
+    SECTION("A schema is loaded once per file version") {
+        fs::path testDir = "build/tests_tmp/registry_test";
+        fs::create_directories(testDir);
+        std::string schemaPath = (testDir / "registry.json").string();
+        {
+            std::ofstream out(schemaPath);
+            out << json({{"type", "string"}}).dump();
+        }
+
+        SchemaRegistry& registry = SchemaRegistry::shared();
+        auto first = registry.get(schemaPath);
+        auto second = registry.get((testDir / "." / "registry.json").string());
+        REQUIRE(first == second);
+        REQUIRE(registry.contains(schemaPath));
+
+        // A changed file is loaded again once the registry revalidates
+        {
+            std::ofstream out(schemaPath);
+            out << json({{"type", "string"}, {"length", 16}}).dump();
+        }
+        registry.revalidate();
+        auto changed = registry.get(schemaPath);
+        REQUIRE(changed != first);
+        REQUIRE(changed->getJson()["length"] == 16);
+
+        REQUIRE_THROWS_AS(registry.get((testDir / "missing.json").string()), std::runtime_error);
+    }
+
+    SECTION("A schema is reloaded when a file it references changes") {
+        fs::path testDir = "build/tests_tmp/registry_ref_test";
+        fs::create_directories(testDir);
+        std::string partPath = (testDir / "part.json").string();
+        std::string schemaPath = (testDir / "main.json").string();
+        {
+            std::ofstream out(partPath);
+            out << json({{"type", "integer"}, {"format", "uint8"}}).dump();
+        }
+        {
+            json schema = {
+                {"module_type", "tabular"},
+                {"properties", {
+                    {"metadata", {{"type", "object"}, {"properties", {{"value", {{"$ref", "./part.json"}}}}}}},
+                    {"data", {{"type", "object"}, {"properties", {{"id", {{"type", "integer"}, {"format", "uint8"}}}}}}}
+                }}
+            };
+            std::ofstream out(schemaPath);
+            out << schema.dump();
+        }
+
+        SchemaRegistry& registry = SchemaRegistry::shared();
+        DataHeader header;
+        TabularData module(schemaPath, header);
+        const json* compiled = &module.getSchema();
+        REQUIRE(&registry.get(schemaPath)->getJson() == compiled);
+
+        // Only the referenced file changes, the compiled fields are out of date
+        {
+            std::ofstream out(partPath);
+            out << json({{"type", "integer"}, {"format", "uint16"}}).dump();
+        }
+        registry.revalidate();
+        REQUIRE(&registry.get(schemaPath)->getJson() != compiled);
+    }
+
+    SECTION("Files are checked at most once per revalidation interval") {
+        fs::path testDir = "build/tests_tmp/registry_interval_test";
+        fs::create_directories(testDir);
+        std::string schemaPath = (testDir / "interval.json").string();
+        {
+            std::ofstream out(schemaPath);
+            out << json({{"type", "string"}}).dump();
+        }
+
+        SchemaRegistry& registry = SchemaRegistry::shared();
+        registry.setRevalidationInterval(std::chrono::hours(1));
+        auto first = registry.get(schemaPath);
+
+        // Within the interval the file is not looked at, even once it is gone
+        fs::remove(schemaPath);
+        REQUIRE(registry.get(schemaPath) == first);
+        REQUIRE(registry.get((testDir / "." / "interval.json").string()) == first);
+
+        {
+            std::ofstream out(schemaPath);
+            out << json({{"type", "string"}, {"length", 8}}).dump();
+        }
+        registry.revalidate();
+        auto changed = registry.get(schemaPath);
+        REQUIRE(changed != first);
+        REQUIRE(registry.get(schemaPath) == changed);
+
+        // Without an interval every use checks the file
+        registry.setRevalidationInterval(std::chrono::seconds(0));
+        fs::remove(schemaPath);
+        REQUIRE_THROWS_AS(registry.get(schemaPath), std::runtime_error);
+
+        registry.setRevalidationInterval(SchemaRegistry::DEFAULT_REVALIDATION_INTERVAL);
+    }
+
+    SECTION("Modules get their own copies of the compiled fields") {
+        std::string schemaPath = "./schemas/patient/v1.0.json";
+        json metadata = {{"clinician", "Dr. Registry"}, {"encounter_date", "2024-05-01"}};
+        auto makeRow = [](const std::string& given) {
+            return json{
+                {"patient_id", "P1"}, {"name", {{"given", given}, {"family", "Family"}}},
+                {"gender", "female"}, {"birth_date", "1980-01-01"}
+            };
+        };
+
+        DataHeader firstHeader, secondHeader;
+        TabularData first(schemaPath, firstHeader);
+        TabularData second(schemaPath, secondHeader);
+        REQUIRE(&first.getSchema() == &second.getSchema());
+
+        // Variable length strings go to each module's own string buffer
+        first.addMetaData(metadata);
+        second.addMetaData(metadata);
+        first.addData(json::array({ makeRow("Ada") }));
+        second.addData(json::array({ makeRow("Grace") }));
+
+        auto firstRows = std::get<json>(first.getModuleData().data);
+        auto secondRows = std::get<json>(second.getModuleData().data);
+        REQUIRE(firstRows[0]["name"]["given"] == "Ada");
+        REQUIRE(secondRows[0]["name"]["given"] == "Grace");
+    }
+}
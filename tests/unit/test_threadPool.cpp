@@ -0,0 +1,45 @@
+#include <catch2/catch_all.hpp>
+#include "Utility/threadPool.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("ThreadPool parallelFor", "[threadpool]") {
+
+    ThreadPool pool(4);
+    REQUIRE(pool.getThreadCount() == 4);
+
+    SECTION("Every index runs exactly once") {
+        std::vector<std::atomic<int>> visits(1000);
+        pool.parallelFor(visits.size(), [&](size_t i) { visits[i]++; });
+        for (const auto& v : visits) {
+            REQUIRE(v.load() == 1);
+        }
+    }
+
+    SECTION("Nested loops complete") {
+        std::atomic<size_t> total{0};
+        pool.parallelFor(8, [&](size_t) {
+            pool.parallelFor(100, [&](size_t j) { total += j; });
+        });
+        REQUIRE(total.load() == 8 * 4950);
+    }
+
+    SECTION("The first exception is rethrown to the caller") {
+        REQUIRE_THROWS_AS(pool.parallelFor(100, [](size_t i) {
+            if (i == 42) throw std::runtime_error("frame 42");
+        }), std::runtime_error);
+
+        // The pool is still usable afterwards
+        std::atomic<int> count{0};
+        pool.parallelFor(10, [&](size_t) { count++; });
+        REQUIRE(count.load() == 10);
+    }
+
+    SECTION("A single-thread pool runs inline") {
+        ThreadPool serial(1);
+        std::vector<size_t> order;
+        serial.parallelFor(5, [&](size_t i) { order.push_back(i); });
+        REQUIRE(order == std::vector<size_t>{0, 1, 2, 3, 4});
+    }
+}
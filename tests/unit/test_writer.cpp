@@ -0,0 +1,448 @@
+#include <catch2/catch_all.hpp>
+#include "reader.hpp"
+#include "writer.hpp"
+#include "DataModule/ModuleData.hpp"
+#include "Utility/threadPool.hpp"
+#include "moduleFixtures.hpp"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+using namespace nlohmann;
+namespace fs = std::filesystem;
+
+using fixtures::tempUmdfPath;
+using fixtures::makeImageModule;
+using fixtures::makeTabularModule;
+using fixtures::writeImageFile;
+
+TEST_CASE("Writer streams image modules a frame at a time", "[writer][stream]") {
+
+    ModuleData image = makeImageModule(32, 24, 5, "zstd");
+    const auto& frames = std::get<std::vector<ModuleData>>(image.data);
+    std::string schema = "./schemas/image/v1.0.json";
+
+    auto pixelsOf = [](const ModuleData& frame) {
+        return std::get<std::vector<uint8_t>>(frame.data);
+    };
+
+    SECTION("Frames read back like a module added in one go") {
+        std::string path = tempUmdfPath("writer_stream.umdf");
+        Writer writer;
+        REQUIRE(writer.createNewFile(path, "Tester").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+
+        auto moduleId = writer.beginImageModule(encounter.value(), schema, image.metadata);
+        REQUIRE(moduleId.has_value());
+        REQUIRE_FALSE(writer.beginImageModule(encounter.value(), schema, image.metadata).has_value());
+        REQUIRE_FALSE(writer.addModuleToEncounter(encounter.value(), schema, image).has_value());
+
+        for (size_t i = 0; i < 4; ++i) {
+            REQUIRE(writer.appendFrame(frames[i]).success);
+        }
+
+        // A frame of the wrong size is rejected, the module carries on
+        ModuleData wrongSize = frames[4];
+        std::get<std::vector<uint8_t>>(wrongSize.data).resize(10);
+        REQUIRE_FALSE(writer.appendFrame(wrongSize).success);
+
+        REQUIRE_FALSE(writer.finishImageModule().success);
+        REQUIRE(writer.appendFrame(frames[4]).success);
+        REQUIRE_FALSE(writer.appendFrame(frames[4]).success);
+        REQUIRE(writer.finishImageModule().success);
+
+        auto after = writer.addModuleToEncounter(encounter.value(), schema, makeImageModule(8, 8, 2));
+        REQUIRE(after.has_value());
+        REQUIRE(writer.closeFile().success);
+
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        auto frame = reader.getFrame(moduleId->toString(), 3);
+        REQUIRE(frame.has_value());
+        REQUIRE(frame->metadata[0]["frame_number"] == 3);
+        REQUIRE(pixelsOf(*frame) == pixelsOf(frames[3]));
+
+        auto loaded = reader.getModuleData(moduleId.value());
+        REQUIRE(loaded.has_value());
+        const auto& loadedFrames = std::get<std::vector<ModuleData>>(loaded->data);
+        REQUIRE(loadedFrames.size() == frames.size());
+        for (size_t i = 0; i < frames.size(); ++i) {
+            REQUIRE(pixelsOf(loadedFrames[i]) == pixelsOf(frames[i]));
+        }
+        REQUIRE(reader.getModuleData(after.value()).has_value());
+        reader.closeFile();
+        fs::remove(path);
+    }
+
+    SECTION("Unfinished modules are discarded on close") {
+        UUID moduleId;
+        std::string path = writeImageFile("writer_stream_abandon.umdf", makeImageModule(8, 8, 2), moduleId);
+        auto committed = fs::file_size(path);
+
+        Writer writer;
+        REQUIRE(writer.openFile(path, "Tester").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        auto streamed = writer.beginImageModule(encounter.value(), schema, image.metadata);
+        REQUIRE(streamed.has_value());
+        REQUIRE(writer.appendFrame(frames[0]).success);
+        REQUIRE(writer.cancelThenClose().success);
+        REQUIRE(fs::file_size(path) == committed);
+
+        REQUIRE(writer.openFile(path, "Tester").success);
+        encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        streamed = writer.beginImageModule(encounter.value(), schema, image.metadata);
+        REQUIRE(streamed.has_value());
+        REQUIRE(writer.appendFrame(frames[0]).success);
+        REQUIRE(writer.closeFile().success);
+
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+        REQUIRE_FALSE(reader.getModuleData(streamed.value()).has_value());
+        reader.closeFile();
+        fs::remove(path);
+    }
+
+    SECTION("Encrypted files are refused") {
+        std::string path = tempUmdfPath("writer_stream_encrypted.umdf");
+        Writer writer;
+        REQUIRE(writer.createNewFile(path, "Tester", "secret").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        REQUIRE_FALSE(writer.beginImageModule(encounter.value(), schema, image.metadata).has_value());
+        REQUIRE(writer.cancelThenClose().success);
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("Writer adds module batches", "[writer][batch]") {
+
+    auto writeBatch = [&](const std::string& name, size_t threads, const std::string& password,
+                          std::vector<UUID>& ids) {
+        std::string path = tempUmdfPath(name);
+        ThreadPool::setSharedThreadCount(threads);
+
+        Writer writer;
+        REQUIRE(writer.createNewFile(path, "Tester", password).success);
+        auto first = writer.createNewEncounter();
+        auto second = writer.createNewEncounter();
+        REQUIRE(first.has_value());
+        REQUIRE(second.has_value());
+
+        std::vector<BatchModule> batch;
+        for (size_t i = 0; i < 12; ++i) {
+            UUID encounter = i % 2 ? second.value() : first.value();
+            if (i % 4 == 3) {
+                batch.push_back({ encounter, "./schemas/image/v1.0.json", makeImageModule(16, 12, 3, "zstd") });
+            }
+            else {
+                batch.push_back({ encounter, "./schemas/patient/v1.0.json", makeTabularModule(40, i) });
+            }
+        }
+        auto added = writer.addModules(batch);
+        REQUIRE(added.has_value());
+        REQUIRE(added->size() == batch.size());
+        ids = added.value();
+        REQUIRE(writer.closeFile().success);
+
+        ThreadPool::setSharedThreadCount(0);
+        return path;
+    };
+
+    SECTION("Modules land in batch order whatever the thread count") {
+        std::vector<UUID> serialIds, parallelIds;
+        std::string serialPath = writeBatch("writer_batch_serial.umdf", 1, "", serialIds);
+        std::string parallelPath = writeBatch("writer_batch_parallel.umdf", 4, "", parallelIds);
+
+        // Only ids and timestamps differ, both of which have a fixed size
+        REQUIRE(fs::file_size(serialPath) == fs::file_size(parallelPath));
+
+        Reader reader;
+        REQUIRE(reader.openFile(parallelPath).success);
+        auto table = reader.getModuleData(parallelIds[5]);
+        REQUIRE(table.has_value());
+        REQUIRE(std::get<json>(table->data)[39]["patient_id"] == "P100239");
+        auto image = reader.getFrame(parallelIds[7].toString(), 2);
+        REQUIRE(image.has_value());
+        REQUIRE(std::get<std::vector<uint8_t>>(image->data) ==
+                std::get<std::vector<uint8_t>>(std::get<std::vector<ModuleData>>(makeImageModule(16, 12, 3).data)[2].data));
+        reader.closeFile();
+
+        std::ifstream file(parallelPath, std::ios::binary);
+        XRefTable xref = XRefTable::loadXrefTable(file);
+        for (size_t i = 1; i < parallelIds.size(); ++i) {
+            REQUIRE(xref.getEntry(parallelIds[i - 1]).offset < xref.getEntry(parallelIds[i]).offset);
+        }
+        file.close();
+
+        fs::remove(serialPath);
+        fs::remove(parallelPath);
+    }
+
+    SECTION("Encrypted modules are sealed concurrently") {
+        std::vector<UUID> ids;
+        std::string path = writeBatch("writer_batch_encrypted.umdf", 4, "secret", ids);
+
+        Reader reader;
+        REQUIRE(reader.openFile(path, "secret").success);
+        for (size_t i : {0, 3, 10}) {
+            REQUIRE(reader.getModuleData(ids[i]).has_value());
+        }
+        reader.closeFile();
+        fs::remove(path);
+    }
+
+    SECTION("A failing module leaves the file as it was") {
+        UUID moduleId;
+        std::string path = writeImageFile("writer_batch_fail.umdf", makeImageModule(8, 8, 2), moduleId);
+        auto committed = fs::file_size(path);
+        size_t moduleCount = 0;
+        {
+            Reader reader;
+            REQUIRE(reader.openFile(path).success);
+            moduleCount = reader.getFileInfo()["module_count"];
+            reader.closeFile();
+        }
+
+        Writer writer;
+        REQUIRE(writer.openFile(path, "Tester").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+
+        std::vector<BatchModule> batch = {
+            { encounter.value(), "./schemas/patient/v1.0.json", makeTabularModule(10, 0) },
+            { encounter.value(), "./schemas/missing/v1.0.json", makeTabularModule(10, 1) }
+        };
+        REQUIRE_FALSE(writer.addModules(batch).has_value());
+        REQUIRE(fs::file_size(path) == committed);
+        REQUIRE_FALSE(writer.addModules({ { UUID(), "./schemas/patient/v1.0.json", makeTabularModule(1, 0) } }).has_value());
+        REQUIRE(fs::file_size(path) == committed);
+
+        // The writer is still usable and commits nothing of the failed batches
+        REQUIRE(writer.closeFile().success);
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+        REQUIRE(reader.getFileInfo()["module_count"] == moduleCount);
+        reader.closeFile();
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("Writer commits existing files in place", "[writer][commit]") {
+
+    ModuleData image = makeImageModule(32, 24, 4);
+    ModuleData addition = makeImageModule(8, 8, 2);
+    UUID moduleId;
+    std::string path = writeImageFile("writer_commit.umdf", image, moduleId);
+    auto committed = fs::file_size(path);
+
+    auto frameOf = [](const ModuleData& module, size_t frame) {
+        return std::get<std::vector<uint8_t>>(std::get<std::vector<ModuleData>>(module.data)[frame].data);
+    };
+
+    auto appendModule = [&](Writer& writer) {
+        REQUIRE(writer.openFile(path, "Tester").success);
+        auto encounter = writer.createNewEncounter();
+        REQUIRE(encounter.has_value());
+        auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", addition);
+        REQUIRE(id.has_value());
+        return id.value();
+    };
+
+    SECTION("Appends new modules without a temp copy") {
+        Writer writer;
+        UUID added = appendModule(writer);
+        REQUIRE_FALSE(fs::exists(path + ".tmp"));
+        REQUIRE(writer.closeFile().success);
+        REQUIRE(fs::file_size(path) > committed);
+
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        auto original = reader.getModuleData(moduleId);
+        auto appended = reader.getModuleData(added);
+        REQUIRE(original.has_value());
+        REQUIRE(appended.has_value());
+        REQUIRE(frameOf(*original, 3) == frameOf(image, 3));
+        REQUIRE(frameOf(*appended, 1) == frameOf(addition, 1));
+    }
+
+    SECTION("Leaves unchanged files and cancelled sessions as they were") {
+        Writer writer;
+        REQUIRE(writer.openFile(path, "Tester").success);
+        REQUIRE(writer.closeFile().success);
+        REQUIRE(fs::file_size(path) == committed);
+
+        appendModule(writer);
+        REQUIRE(writer.cancelThenClose().success);
+        REQUIRE(fs::file_size(path) == committed);
+    }
+
+    SECTION("1.0 files are refused rather than written in place") {
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            REQUIRE(file.is_open());
+            file.write("#UMDFv1.0\n", 10);
+        }
+        auto readBytes = [&]() {
+            std::ifstream in(path, std::ios::binary);
+            return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+        };
+        auto before = readBytes();
+
+        Writer writer;
+        Result result = writer.openFile(path, "Tester");
+        REQUIRE_FALSE(result.success);
+        REQUIRE(result.message.find("1.0") != std::string::npos);
+        REQUIRE_FALSE(fs::exists(path + ".tmp"));
+        REQUIRE(readBytes() == before);
+
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        REQUIRE(reader.getModuleData(moduleId).has_value());
+    }
+
+    SECTION("A failed update leaves the old module current") {
+        auto checkOriginal = [&]() {
+            Reader reader;
+            REQUIRE(reader.openFile(path).success);
+            auto original = reader.getModuleData(moduleId);
+            REQUIRE(original.has_value());
+            REQUIRE(frameOf(*original, 3) == frameOf(image, 3));
+
+            auto trail = reader.getAuditTrail(moduleId);
+            REQUIRE(trail.has_value());
+            REQUIRE(trail->size() == 1);
+            REQUIRE(trail->front().isCurrent);
+        };
+
+        // The update throws while the new module is built, a later module still commits
+        {
+            Writer writer;
+            UUID added = appendModule(writer);
+            REQUIRE_FALSE(writer.updateModule(moduleId, ModuleData{ image.metadata, json::array() }).success);
+            REQUIRE(writer.closeFile().success);
+            REQUIRE(added != moduleId);
+        }
+        checkOriginal();
+
+        // The stored module type is not one that can be updated
+        uint64_t typeOffset = 0;
+        {
+            std::ifstream file(path, std::ios::binary);
+            uint64_t moduleOffset = XRefTable::loadXrefTable(file).getEntry(moduleId).offset;
+            file.seekg(0);
+            std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            typeOffset = bytes.find("image", moduleOffset);
+            REQUIRE(typeOffset != std::string::npos);
+        }
+        auto patchType = [&](const char* type) {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(typeOffset);
+            file.write(type, 5);
+        };
+
+        patchType("frame");
+        {
+            Writer writer;
+            appendModule(writer);
+            REQUIRE_FALSE(writer.updateModule(moduleId, addition).success);
+            REQUIRE(writer.closeFile().success);
+        }
+        patchType("image");
+        checkOriginal();
+    }
+
+    SECTION("Updates replace the module once committed") {
+        Writer writer;
+        REQUIRE(writer.openFile(path, "Tester").success);
+        REQUIRE(writer.updateModule(moduleId, addition).success);
+        REQUIRE(writer.closeFile().success);
+
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        auto updated = reader.getModuleData(moduleId);
+        REQUIRE(updated.has_value());
+        REQUIRE(frameOf(*updated, 1) == frameOf(addition, 1));
+
+        auto trail = reader.getAuditTrail(moduleId);
+        REQUIRE(trail.has_value());
+        REQUIRE(trail->size() == 2);
+        REQUIRE(std::count_if(trail->begin(), trail->end(), [](const ModuleTrail& t) { return t.isCurrent; }) == 1);
+    }
+
+    SECTION("Recovers the last commit after an interrupted one") {
+        // What a crash mid-commit leaves: part of a module, then a torn table
+        // whose footer lacks its first bytes
+        {
+            std::ofstream torn(path, std::ios::binary | std::ios::app);
+            std::vector<char> partialModule(5000, '\x5A');
+            torn.write(partialModule.data(), partialModule.size());
+            torn.write("XREF\x01", 5);
+            torn.write("ffset\n\0\0\0\0\0\0\0\0#EOUMDF", 22);
+            torn.put('\0');
+        }
+        REQUIRE(fs::file_size(path) > committed);
+
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        auto original = reader.getModuleData(moduleId);
+        REQUIRE(original.has_value());
+        REQUIRE(frameOf(*original, 2) == frameOf(image, 2));
+        reader.closeFile();
+
+        // Reopening for writing cuts the tail off, later commits follow the last good one
+        Writer writer;
+        UUID added = appendModule(writer);
+        REQUIRE(writer.closeFile().success);
+
+        Reader after;
+        REQUIRE(after.openFile(path).success);
+        REQUIRE(after.getModuleData(moduleId).has_value());
+        REQUIRE(after.getModuleData(added).has_value());
+    }
+
+    // Bytes appended after the commit, ending in a footer that points at xrefOffset
+    auto appendFooter = [&](const std::vector<char>& body, uint64_t xrefOffset) {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.write(body.data(), body.size());
+        uint64_t graphOffset = committed;
+        uint32_t graphSize = 50;
+        out.write("xrefoffset\n", 12);
+        out.write(reinterpret_cast<const char*>(&xrefOffset), sizeof(xrefOffset));
+        out.write(reinterpret_cast<const char*>(&graphOffset), sizeof(graphOffset));
+        out.write(reinterpret_cast<const char*>(&graphSize), sizeof(graphSize));
+        out.write("#EOUMDF", 8);
+    };
+
+    SECTION("Keeps a finished commit whose table cannot be read") {
+        // A table header with damaged entries behind a whole footer
+        std::vector<char> body(200, '\x5A');
+        const char tableHeader[] = "XREF\x01\x05\x00\x00\x00\x10\x01\x08\x08\x04";
+        std::memcpy(body.data() + 100, tableHeader, sizeof(tableHeader) - 1);
+        appendFooter(body, committed + 100);
+        auto damagedSize = fs::file_size(path);
+
+        Writer writer;
+        REQUIRE_FALSE(writer.openFile(path, "Tester").success);
+        REQUIRE(fs::file_size(path) == damagedSize);
+    }
+
+    SECTION("Footer bytes inside uncommitted data are not a commit") {
+        // Frame data that happens to hold the footer markers, pointing at more frame data
+        appendFooter(std::vector<char>(200, '\x5A'), committed + 100);
+
+        Writer writer;
+        REQUIRE(writer.openFile(path, "Tester").success);
+        REQUIRE(fs::file_size(path) == committed);
+        REQUIRE(writer.closeFile().success);
+    }
+
+    fs::remove(path);
+}
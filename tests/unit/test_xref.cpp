@@ -0,0 +1,54 @@
+#include <catch2/catch_all.hpp>
+#include "Xref/xref.hpp"
+#include "Utility/uuid.hpp"
+#include <vector>
+
+TEST_CASE("XRefTable lookup", "[xref]") {
+
+    XRefTable table;
+    std::vector<UUID> ids(1000);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        table.addEntry(ModuleType::Tabular, ids[i], i * 100, i + 1, "schema.json");
+    }
+
+    SECTION("Every entry can be found by id") {
+        REQUIRE(table.getEntries().size() == ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            REQUIRE(table.contains(ids[i]));
+            REQUIRE(table.getEntry(ids[i]).offset == i * 100);
+        }
+        REQUIRE_FALSE(table.contains(UUID()));
+        REQUIRE_THROWS(table.getEntry(UUID()));
+    }
+
+    SECTION("Adding an existing id replaces its entry") {
+        table.addEntry(ModuleType::Image, ids[10], 42, 7, "image.json");
+        REQUIRE(table.getEntries().size() == ids.size());
+        REQUIRE(table.getEntry(ids[10]).offset == 42);
+        REQUIRE(table.getEntry(ids[10]).type == static_cast<uint8_t>(ModuleType::Image));
+    }
+
+    SECTION("Deleted entries disappear and the rest stay reachable") {
+        for (size_t i = 0; i < ids.size(); i += 3) {
+            REQUIRE(table.deleteEntry(ids[i]));
+        }
+        REQUIRE_FALSE(table.deleteEntry(ids[0]));
+
+        for (size_t i = 0; i < ids.size(); ++i) {
+            REQUIRE(table.contains(ids[i]) == (i % 3 != 0));
+            if (i % 3 != 0) {
+                REQUIRE(table.getEntry(ids[i]).size == i + 1);
+            }
+        }
+
+        table.updateEntryOffset(ids[1], 5);
+        REQUIRE(table.getEntry(ids[1]).offset == 5);
+    }
+
+    SECTION("Clear empties the index") {
+        table.clear();
+        REQUIRE_FALSE(table.contains(ids[0]));
+        table.addEntry(ModuleType::Tabular, ids[0], 1, 1, "schema.json");
+        REQUIRE(table.contains(ids[0]));
+    }
+}
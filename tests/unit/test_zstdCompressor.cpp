@@ -0,0 +1,381 @@
+#include <catch2/catch_all.hpp>
+#include "Utility/Compression/ZstdCompressor.hpp"
+#include "Utility/Compression/CompressionPolicy.hpp"
+#include "Utility/Compression/ZstdDictionary.hpp"
+#include "Utility/threadPool.hpp"
+#include "DataModule/Header/dataHeader.hpp"
+#include "Xref/xref.hpp"
+#include "reader.hpp"
+#include "writer.hpp"
+
+#include <nlohmann/json.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static std::vector<uint8_t> makeMetadataBlock(size_t size, uint8_t seed) {
+    std::string text;
+    while (text.size() < size) {
+        text += "{\"modality\":\"CT\",\"frame_number\":" + std::to_string(text.size() + seed) + "}";
+    }
+    return std::vector<uint8_t>(text.begin(), text.begin() + size);
+}
+
+TEST_CASE("ZSTD compression into caller buffers", "[zstd]") {
+
+    std::vector<uint8_t> block = makeMetadataBlock(4096, 1);
+
+    SECTION("Matches the allocating API") {
+        std::vector<uint8_t> expected = ZstdCompressor::compress(block);
+
+        std::vector<std::byte> out(ZstdCompressor::compressBound(block.size()));
+        size_t written = ZstdCompressor::compressInto(std::as_bytes(std::span(block)), out);
+        REQUIRE(written == expected.size());
+        REQUIRE(std::memcmp(out.data(), expected.data(), written) == 0);
+
+        std::vector<std::byte> restored(block.size());
+        size_t restoredSize = ZstdCompressor::decompressInto(std::span(out).first(written), restored);
+        REQUIRE(restoredSize == block.size());
+        REQUIRE(std::memcmp(restored.data(), block.data(), block.size()) == 0);
+    }
+
+    SECTION("Buffers that are too small are rejected") {
+        std::vector<std::byte> out(8);
+        REQUIRE_THROWS(ZstdCompressor::compressInto(std::as_bytes(std::span(block)), out));
+
+        std::vector<uint8_t> compressed = ZstdCompressor::compress(block);
+        std::vector<std::byte> restored(block.size() - 1);
+        REQUIRE_THROWS(ZstdCompressor::decompressInto(std::as_bytes(std::span(compressed)), restored));
+    }
+
+    SECTION("Reused contexts give the same output for every call and level") {
+        for (int level : {1, 15, 3, 15}) {
+            std::vector<uint8_t> first = ZstdCompressor::compressWithLevel(block, level);
+            REQUIRE(ZstdCompressor::compressWithLevel(block, level) == first);
+            REQUIRE(ZstdCompressor::decompress(first) == block);
+        }
+    }
+}
+
+TEST_CASE("ZSTD statistics under concurrent use", "[zstd][threadpool]") {
+
+    ThreadPool pool(4);
+    ZstdCompressor::resetStatistics();
+
+    const size_t blocks = 64;
+    std::vector<std::vector<uint8_t>> compressed(blocks);
+    std::vector<std::vector<uint8_t>> restored(blocks);
+    pool.parallelFor(blocks, [&](size_t i) {
+        compressed[i] = ZstdCompressor::compress(makeMetadataBlock(1024 + i * 16, static_cast<uint8_t>(i)));
+        restored[i] = ZstdCompressor::decompress(compressed[i]);
+    });
+
+    // Catch assertions are not thread-safe, so check once the pool is done
+    size_t compressedBytes = 0;
+    for (size_t i = 0; i < blocks; ++i) {
+        REQUIRE(restored[i] == makeMetadataBlock(1024 + i * 16, static_cast<uint8_t>(i)));
+        compressedBytes += compressed[i].size();
+    }
+
+    REQUIRE(ZstdCompressor::getTotalCompressions() == blocks);
+    REQUIRE(ZstdCompressor::getTotalDecompressions() == blocks);
+    REQUIRE(ZstdCompressor::getTotalCompressedSize() == 2 * compressedBytes);
+    REQUIRE(ZstdCompressor::getCompressionLevel() == ZstdCompressor::DEFAULT_LEVEL);
+
+    ZstdCompressor::resetStatistics();
+}
+
+static ModuleData makePatientTable(size_t rowCount) {
+    nlohmann::json rows = nlohmann::json::array();
+    for (size_t i = 0; i < rowCount; ++i) {
+        rows.push_back({
+            {"patient_id", "patient-" + std::to_string(i)},
+            {"name", {{"given", "Given" + std::to_string(i % 17)}, {"family", "Family" + std::to_string(i % 5)}}},
+            {"gender", i % 2 ? "female" : "male"},
+            {"birth_date", "1980-01-01"},
+            {"age", static_cast<int>(i % 90)}
+        });
+    }
+    return { {{"clinician", "Dr. Policy"}, {"encounter_date", "2024-05-01"}}, rows };
+}
+
+static DataHeader readModuleHeader(const std::string& path, const UUID& id) {
+    std::ifstream file(path, std::ios::binary);
+    XRefTable xref = XRefTable::loadXrefTable(file);
+    const XrefEntry* entry = xref.findEntry(id);
+    REQUIRE(entry != nullptr);
+
+    DataHeader header;
+    file.seekg(entry->offset);
+    header.readDataHeader(file);
+    return header;
+}
+
+TEST_CASE("Compression policies", "[zstd][policy]") {
+
+    SECTION("Sections without an override use the fallback") {
+        CompressionPolicy policy;
+        REQUIRE(policy.get(ModuleType::Tabular, CompressionSection::Data).level == ZstdCompressor::DEFAULT_LEVEL);
+
+        policy.set(ModuleType::Tabular, CompressionSection::Data, ZstdSettings{ .level = 2 });
+        REQUIRE(policy.get(ModuleType::Tabular, CompressionSection::Data).level == 2);
+        REQUIRE(policy.get(ModuleType::Tabular, CompressionSection::Metadata) == policy.getFallback());
+        REQUIRE(policy.get(ModuleType::Image, CompressionSection::Data) == policy.getFallback());
+
+        // Only overrides and explicit fallbacks are found, modules default the rest
+        REQUIRE(policy.find(ModuleType::Tabular, CompressionSection::Data)->level == 2);
+        REQUIRE_FALSE(policy.find(ModuleType::Image, CompressionSection::Data).has_value());
+        REQUIRE(CompressionPolicy(ZstdSettings{ .level = 4 }).find(ModuleType::Image, CompressionSection::Data)->level == 4);
+
+        REQUIRE(stringToPreset("Balanced") == CompressionPreset::Balanced);
+        REQUIRE_FALSE(stringToPreset("tiny").has_value());
+    }
+
+    SECTION("Long-distance matching and workers need nothing to decompress") {
+        std::vector<uint8_t> block = makeMetadataBlock(256 * 1024, 3);
+        ZstdSettings settings{ .level = 19, .longDistanceMatching = true, .workers = 2 };
+
+        std::vector<std::byte> out(ZstdCompressor::compressBound(block.size()));
+        size_t written = ZstdCompressor::compressInto(std::as_bytes(std::span(block)), out, settings);
+        REQUIRE(ZstdCompressor::decompress(std::span(out).first(written)) == block);
+    }
+
+    SECTION("Headers only record settings that differ from the default") {
+        auto headerSize = [](ModuleType type, ZstdSettings settings) {
+            DataHeader header;
+            header.setModuleType(type);
+            header.setMetadataCompression(CompressionType::ZSTD);
+            header.setDataCompression(CompressionType::ZSTD);
+            header.setMetadataZstd(settings);
+            header.setDataZstd(settings);
+            std::stringstream out;
+            header.writeToFile(out);
+            return out.view().size();
+        };
+
+        size_t defaults = headerSize(ModuleType::Tabular, ZstdSettings{});
+        REQUIRE(headerSize(ModuleType::Tabular, ZstdSettings{ .workers = 4 }) == defaults);
+        REQUIRE(headerSize(ModuleType::Tabular, ZstdSettings{ .level = 1 }) > defaults);
+        REQUIRE(headerSize(ModuleType::Tabular, ZstdSettings{ .longDistanceMatching = true }) > defaults);
+
+        // Frames are encoded with their module's settings
+        REQUIRE(headerSize(ModuleType::Frame, ZstdSettings{ .level = 1 }) == headerSize(ModuleType::Frame, ZstdSettings{}));
+    }
+
+    auto preset = GENERATE(CompressionPreset::Fastest, CompressionPreset::Balanced, CompressionPreset::Smallest);
+
+    DYNAMIC_SECTION("Tabular modules written with the " << presetToString(preset) << " preset") {
+        std::string path = (fs::path("build/tests_tmp") / ("policy_" + presetToString(preset) + ".umdf")).string();
+        fs::create_directories(fs::path(path).parent_path());
+        fs::remove(path);
+
+        CompressionPolicy policy = CompressionPolicy::fromPreset(preset);
+        ModuleData table = makePatientTable(500);
+        UUID id;
+        {
+            Writer writer;
+            writer.setCompressionPolicy(policy);
+            REQUIRE(writer.createNewFile(path, "Tester").success);
+            auto encounter = writer.createNewEncounter();
+            REQUIRE(encounter.has_value());
+            auto added = writer.addModuleToEncounter(encounter.value(), "./schemas/patient/v1.0.json", table);
+            REQUIRE(added.has_value());
+            id = added.value();
+            REQUIRE(writer.closeFile().success);
+        }
+
+        DataHeader header = readModuleHeader(path, id);
+        REQUIRE(header.getMetadataZstd().level == policy.get(ModuleType::Tabular, CompressionSection::Metadata).level);
+        REQUIRE(header.getDataZstd().level == policy.get(ModuleType::Tabular, CompressionSection::Data).level);
+        REQUIRE(header.getDataZstd().longDistanceMatching ==
+                policy.get(ModuleType::Tabular, CompressionSection::Data).longDistanceMatching);
+
+        // The reader is not told about the policy
+        Reader reader;
+        REQUIRE(reader.openFile(path).success);
+        auto module = reader.getModuleData(id);
+        REQUIRE(module.has_value());
+        const auto& rows = std::get<nlohmann::json>(module->data);
+        REQUIRE(rows.size() == 500);
+        REQUIRE(rows[499]["patient_id"] == "patient-499");
+        REQUIRE(module->metadata[0]["clinician"] == "Dr. Policy");
+        reader.closeFile();
+
+        fs::remove(path);
+    }
+}
+
+static ModuleData makeImageModule(uint16_t frameCount, uint8_t seed) {
+    nlohmann::json metadata = {
+        {"modality", "CT"},
+        {"image_structure", {
+            {"channels", 1},
+            {"bit_depth", 8},
+            {"encoding", "raw"},
+            {"memory_order", "row_major"},
+            {"origin", "top_left"},
+            {"layout", "interleaved"},
+            {"dimensions", {8, 8, frameCount}},
+            {"dimension_names", {"x", "y", "z"}}
+        }}
+    };
+
+    std::vector<ModuleData> frames;
+    for (uint16_t f = 0; f < frameCount; ++f) {
+        std::vector<uint8_t> pixels(64, static_cast<uint8_t>(f + seed));
+        nlohmann::json frameMetadata = {
+            {"frame_number", f},
+            {"position", {0.0, 0.0, f * 1.5 + seed}},
+            {"orientation", {{"row_cosine", {1.0, 0.0, 0.0}}, {"column_cosine", {0.0, 1.0, 0.0}}}}
+        };
+        frames.push_back({ frameMetadata, pixels });
+    }
+    return { metadata, frames };
+}
+
+TEST_CASE("Metadata dictionaries", "[zstd][dictionary]") {
+
+    std::vector<std::vector<uint8_t>> samples;
+    for (uint8_t i = 0; i < 200; ++i) {
+        samples.push_back(makeMetadataBlock(200 + i, i));
+    }
+    auto dictionary = ZstdDictionary::train(samples, 4096);
+    REQUIRE(dictionary->getID() != 0);
+
+    SECTION("Small blocks shrink and need the dictionary to decompress") {
+        std::vector<uint8_t> block = makeMetadataBlock(300, 250);
+        std::vector<std::byte> out(ZstdCompressor::compressBound(block.size()));
+
+        size_t plain = ZstdCompressor::compressInto(std::as_bytes(std::span(block)), out, ZstdSettings{});
+        size_t withDictionary = ZstdCompressor::compressInto(
+            std::as_bytes(std::span(block)), out, ZstdSettings{}, dictionary.get());
+        REQUIRE(withDictionary < plain);
+
+        auto compressed = std::span(out).first(withDictionary);
+        REQUIRE(ZstdCompressor::decompress(compressed, dictionary.get()) == block);
+        REQUIRE_THROWS(ZstdCompressor::decompress(compressed));
+    }
+
+    SECTION("Tables round trip through their section") {
+        DictionaryTable table;
+        table.add(dictionary);
+
+        std::stringstream section;
+        uint32_t size = table.write(section);
+        DictionaryTable restored = DictionaryTable::read(section, size);
+        REQUIRE(restored.size() == 1);
+        REQUIRE(restored.find(dictionary->getID())->getContent() == dictionary->getContent());
+        REQUIRE(restored.find(dictionary->getID() + 1) == nullptr);
+
+        REQUIRE_THROWS(ZstdDictionary(std::vector<uint8_t>(64, 0)));
+    }
+
+    SECTION("Files keep the dictionaries their modules use") {
+        std::string path = (fs::path("build/tests_tmp") / "dictionary.umdf").string();
+        fs::create_directories(fs::path(path).parent_path());
+        fs::remove(path);
+
+        std::vector<ModuleData> images;
+        for (uint8_t m = 0; m < 3; ++m) {
+            images.push_back(makeImageModule(40, m));
+        }
+
+        std::vector<UUID> ids;
+        {
+            Writer writer;
+            REQUIRE(writer.createNewFile(path, "Tester").success);
+            REQUIRE_FALSE(writer.setMetadataDictionary(std::vector<uint8_t>(64, 0)).success);
+            REQUIRE(writer.trainMetadataDictionary("./schemas/image/v1.0.json", images).success);
+
+            auto encounter = writer.createNewEncounter();
+            REQUIRE(encounter.has_value());
+            for (const auto& image : images) {
+                auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", image);
+                REQUIRE(id.has_value());
+                ids.push_back(id.value());
+            }
+            REQUIRE(writer.closeFile().success);
+        }
+
+        DataHeader header = readModuleHeader(path, ids[0]);
+        REQUIRE(header.getMetadataDictionaryID() != 0);
+
+        // Modules appended later without a dictionary sit alongside the old ones
+        {
+            Writer writer;
+            REQUIRE(writer.openFile(path, "Tester").success);
+            auto encounter = writer.createNewEncounter();
+            REQUIRE(encounter.has_value());
+            images.push_back(makeImageModule(4, 9));
+            auto id = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", images.back());
+            REQUIRE(id.has_value());
+            ids.push_back(id.value());
+            REQUIRE(writer.closeFile().success);
+        }
+        REQUIRE(readModuleHeader(path, ids.back()).getMetadataDictionaryID() == 0);
+
+        for (ReadMode mode : { ReadMode::Stream, ReadMode::MemoryMapped }) {
+            Reader reader;
+            reader.setReadMode(mode);
+            REQUIRE(reader.openFile(path).success);
+            for (size_t m = 0; m < ids.size(); ++m) {
+                auto module = reader.getModuleData(ids[m]);
+                REQUIRE(module.has_value());
+                const auto& expected = std::get<std::vector<ModuleData>>(images[m].data);
+                const auto& actual = std::get<std::vector<ModuleData>>(module->data);
+                REQUIRE(actual.size() == expected.size());
+                REQUIRE(actual.back().metadata[0]["frame_number"] == expected.size() - 1);
+            }
+
+            auto frame = reader.getFrame(ids[1].toString(), 7);
+            REQUIRE(frame.has_value());
+            REQUIRE(std::get<std::vector<uint8_t>>(frame->data) ==
+                    std::get<std::vector<uint8_t>>(std::get<std::vector<ModuleData>>(images[1].data)[7].data));
+            reader.closeFile();
+        }
+
+        fs::remove(path);
+    }
+
+    SECTION("Encrypted files refuse dictionaries") {
+        std::string path = (fs::path("build/tests_tmp") / "dictionary_encrypted.umdf").string();
+        fs::create_directories(fs::path(path).parent_path());
+        fs::remove(path);
+
+        std::vector<ModuleData> images;
+        for (uint8_t m = 0; m < 3; ++m) {
+            images.push_back(makeImageModule(40, m));
+        }
+
+        UUID id;
+        {
+            Writer writer;
+            REQUIRE(writer.createNewFile(path, "Tester", "secret").success);
+            REQUIRE_FALSE(writer.trainMetadataDictionary("./schemas/image/v1.0.json", images).success);
+            REQUIRE_FALSE(writer.setMetadataDictionary(dictionary->getContent()).success);
+
+            auto encounter = writer.createNewEncounter();
+            REQUIRE(encounter.has_value());
+            auto added = writer.addModuleToEncounter(encounter.value(), "./schemas/image/v1.0.json", images[0]);
+            REQUIRE(added.has_value());
+            id = added.value();
+            REQUIRE(writer.closeFile().success);
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        XRefTable xref = XRefTable::loadXrefTable(file);
+        REQUIRE(xref.getDictionarySize() == 0);
+        file.close();
+
+        Reader reader;
+        REQUIRE(reader.openFile(path, "secret").success);
+        REQUIRE(reader.getModuleData(id).has_value());
+        reader.closeFile();
+
+        fs::remove(path);
+    }
+}